@@ -230,6 +230,67 @@ function(bean_cc_test)
   add_test(NAME ${_NAME} COMMAND ${_NAME})
 endfunction()
 
+# beanquick_cc_benchmark()
+# CMake function to imitate the bean_cc_benchmark Bazel macro, see
+# beanquick/beanquick.bzl.
+# Parameters:
+# NAME: name of target (see Usage below)
+# SRCS: List of source files for the binary
+# DEPS: List of other libraries to be linked in to the binary targets
+# COPTS: List of private compile options
+# DEFINES: List of public defines
+# LINKOPTS: List of link options
+# Note:
+# Only does something when BEANQUICK_BUILD_BENCHMARKS is ON. Creates a binary
+# named beanquick_${NAME}, linked with google benchmark's main and
+# bean::benchmark_util, which counts allocations. It is not added to ctest,
+# run it directly.
+# Usage:
+# beanquick_cc_benchmark(
+#   NAME
+#     awesome_benchmark
+#   SRCS
+#     "awesome_benchmark.cc"
+#   DEPS
+#     beanquick::awesome
+# )
+function(bean_cc_benchmark)
+  if(NOT BEANQUICK_BUILD_BENCHMARKS)
+    return()
+  endif()
+
+  cmake_parse_arguments(BEANQUICK_CC_BENCHMARK
+    ""
+    "NAME"
+    "SRCS;COPTS;DEFINES;LINKOPTS;DEPS"
+    ${ARGN}
+  )
+
+  set(_NAME "beanquick_${BEANQUICK_CC_BENCHMARK_NAME}")
+  add_executable(${_NAME} "")
+  target_sources(${_NAME} PRIVATE ${BEANQUICK_CC_BENCHMARK_SRCS})
+  target_include_directories(${_NAME}
+    PUBLIC ${BEANQUICK_COMMON_INCLUDE_DIRS}
+  )
+  target_compile_definitions(${_NAME}
+    PUBLIC ${BEANQUICK_CC_BENCHMARK_DEFINES}
+  )
+  target_compile_options(${_NAME}
+    PRIVATE ${BEANQUICK_CC_BENCHMARK_COPTS}
+  )
+  target_link_libraries(${_NAME}
+    PUBLIC
+      ${BEANQUICK_CC_BENCHMARK_DEPS}
+      bean::benchmark_util
+      ${BEANQUICK_BENCHMARK_COMMON_LIBRARIES}
+    PRIVATE ${BEANQUICK_CC_BENCHMARK_LINKOPTS}
+  )
+  set_property(TARGET ${_NAME} PROPERTY FOLDER ${BEANQUICK_IDE_FOLDER}/benchmark)
+
+  set_property(TARGET ${_NAME} PROPERTY CXX_STANDARD ${BEANQUICK_CXX_STANDARD})
+  set_property(TARGET ${_NAME} PROPERTY CXX_STANDARD_REQUIRED ON)
+endfunction()
+
 
 function(check_target my_target)
   if(NOT TARGET ${my_target})
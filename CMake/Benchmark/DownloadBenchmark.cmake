@@ -0,0 +1,33 @@
+# Downloads and unpacks google benchmark at configure time, the same way
+# DownloadGTest.cmake does for googletest.
+
+configure_file(
+  ${CMAKE_CURRENT_LIST_DIR}/CMakeLists.txt.in
+  ${CMAKE_BINARY_DIR}/benchmark-download/CMakeLists.txt
+)
+
+execute_process(COMMAND ${CMAKE_COMMAND} -G "${CMAKE_GENERATOR}" .
+  RESULT_VARIABLE result
+  WORKING_DIRECTORY ${CMAKE_BINARY_DIR}/benchmark-download )
+if(result)
+  message(FATAL_ERROR "CMake step for benchmark failed: ${result}")
+endif()
+
+execute_process(COMMAND ${CMAKE_COMMAND} --build .
+  RESULT_VARIABLE result
+  WORKING_DIRECTORY ${CMAKE_BINARY_DIR}/benchmark-download)
+if(result)
+  message(FATAL_ERROR "Build step for benchmark failed: ${result}")
+endif()
+
+# googletest is already part of the build, and benchmark's own tests aren't
+# needed.
+set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "" FORCE)
+set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+
+# Add benchmark directly to our build. This defines the benchmark and
+# benchmark_main targets.
+add_subdirectory(${CMAKE_BINARY_DIR}/benchmark-src
+                 ${CMAKE_BINARY_DIR}/benchmark-build
+                 EXCLUDE_FROM_ALL)
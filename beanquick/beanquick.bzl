@@ -0,0 +1,21 @@
+"""Build macros shared by the beanquick packages."""
+
+def bean_cc_benchmark(name, srcs, deps = [], copts = [], **kwargs):
+    """A google benchmark binary, the Bazel twin of bean_cc_benchmark() in
+    CMake/BeanquickHelper.cmake.
+
+    Links benchmark_main and //beanquick/core:benchmark_util, which reports
+    allocs/op. Run with `bazel run -c opt //beanquick/core:<name>`.
+    """
+    native.cc_binary(
+        name = name,
+        srcs = srcs,
+        deps = deps + [
+            "//beanquick/core:benchmark_util",
+            "@com_github_google_benchmark//:benchmark_main",
+        ],
+        copts = ["-O2"] + copts,
+        testonly = 1,
+        tags = ["benchmark"],
+        **kwargs
+    )
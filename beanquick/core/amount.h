@@ -18,31 +18,37 @@
 #define DEANQUICK_AMOUNT_H_
 
 #include <iostream>
-#include <regex>
+#include <utility>
 #include <vector>
 
+#include "absl/hash/hash.h"
+#include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "currency.h"
 #include "decimal.h"
 #include "logging.h"
 
 namespace beanquick {
-inline static bool check_currency(const string &str) {
-  std::regex CURRENCY_RE(R"([A-Z][A-Z0-9'._]{0,22}[A-Z0-9])");
-  return std::regex_match(str, CURRENCY_RE);
-}
-
 class Amount {
  public:
-  virtual ~Amount() {}
+  // CHECK-fails when `currency` is not a valid currency, which is only
+  // checked the first time a symbol is seen, see CurrencyTable.
+  Amount(const Decimal &number, absl::string_view currency);
 
-  Amount(const Decimal &number, const string &currency);
+  Amount(Decimal number, CurrencyId currency)
+      : number_(std::move(number)), currency_(currency) {}
 
-  Amount(const Amount &amount);
-  Amount &operator=(const Amount &from);
+  Amount(const Amount &amount) = default;
+  Amount(Amount &&amount) noexcept = default;
+  Amount &operator=(const Amount &from) = default;
+  Amount &operator=(Amount &&from) noexcept = default;
 
-  Decimal Number() const { return number_; }
-  string Currency() const { return currency_; }
+  const Decimal &Number() const { return number_; }
+  const string &Currency() const { return CurrencyName(currency_); }
+  CurrencyId currency_id() const { return currency_; }
 
   Amount &operator+=(const Decimal &rhs);
   Amount &operator-=(const Decimal &rhs);
@@ -50,8 +56,46 @@ class Amount {
   Amount &operator/=(const Decimal &rhs);
   Amount &operator%=(const Decimal &rhs);
 
+  // Add or sub an amount of the same currency in place.
+  Amount &operator+=(const Amount &rhs);
+  Amount &operator-=(const Amount &rhs);
+
+  // *this += amount * factor in place, e.g. the total cost of a lot from its
+  // per unit price and the quantity. `amount` must have the same currency.
+  Amount &AddScaled(const Amount &amount, const Decimal &factor);
+  Amount &AddScaled(const Decimal &number, const Decimal &factor) {
+    number_.AddScaled(number, factor);
+    return *this;
+  }
+
+  // Non-throwing versions of the operators, see Decimal::CheckedAdd(). The
+  // Amount overloads fail with InvalidArgument on different currencies.
+  absl::Status CheckedAdd(const Decimal &rhs) {
+    return number_.CheckedAdd(rhs);
+  }
+  absl::Status CheckedSub(const Decimal &rhs) {
+    return number_.CheckedSub(rhs);
+  }
+  absl::Status CheckedMul(const Decimal &rhs) {
+    return number_.CheckedMul(rhs);
+  }
+  absl::Status CheckedDiv(const Decimal &rhs) {
+    return number_.CheckedDiv(rhs);
+  }
+  absl::Status CheckedAdd(const Amount &rhs);
+  absl::Status CheckedSub(const Amount &rhs);
+
+  // See Decimal::Quantize().
+  Amount &Quantize(int scale, Rounding::Mode mode) {
+    number_.Quantize(scale, mode);
+    return *this;
+  }
+
   string ToString() const;
 
+  // Appends what ToString() returns to `out`, without temporaries.
+  void AppendTo(string *out) const;
+
   // Create an Amount from a string.
   static Amount FromString(const string &str);
 
@@ -63,44 +107,32 @@ class Amount {
 
   friend std::ostream &operator<<(std::ostream &os, const Amount &amount);
 
-  // Compare two amounts, currency_ first, then number_.
+  // Compare two amounts, currency names first, then number_.
   // Once this is defined, std::sort can apply to this class.
   friend bool operator<(const Amount &lhs, const Amount &rhs);
 
   friend bool operator==(const Amount &lhs, const Amount &rhs);
 
-  friend bool operator!=(const Amount &lhs, const Amount &rhs);
+  // Hashes the normalized number and the currency id, see the Decimal
+  // overload. Makes absl::flat_hash_map<Amount, ...> work.
+  template <typename H>
+  friend H AbslHashValue(H h, const Amount &amount) {
+    return H::combine(std::move(h), amount.number_, amount.currency_);
+  }
 
-  // Basic math operations between an amount and a decial.
-  friend const Amount operator+(const Amount &lhs, const Decimal &rhs);
-  friend const Amount operator-(const Amount &lhs, const Decimal &rhs);
-  friend const Amount operator*(const Amount &lhs, const Decimal &rhs);
-  friend const Amount operator/(const Amount &lhs, const Decimal &rhs);
-  friend const Amount operator%(const Amount &lhs, const Decimal &rhs);
+  friend bool operator!=(const Amount &lhs, const Amount &rhs);
 
-  // Add or sub two amounts.
-  friend const Amount operator+(const Amount &lhs, const Amount &rhs);
-  friend const Amount operator-(const Amount &lhs, const Amount &rhs);
+  friend Amount SumAmounts(absl::Span<const Amount> amounts);
 
  private:
   Decimal number_;
-  string currency_;
+  CurrencyId currency_;
 };
 
-inline Amount::Amount(const Decimal &number, const string &currency) {
-  CHECK(check_currency(currency));
-  number_ = number;
-  currency_ = currency;
-}
-
-inline Amount::Amount(const Amount &amount) { *this = amount; }
+static_assert(sizeof(Amount) == 24, "Amount should stay a Decimal and an id");
 
-inline Amount &Amount::operator=(const Amount &from) {
-  if (*this == from) return *this;
-  number_ = from.Number();
-  currency_ = from.Currency();
-  return *this;
-}
+inline Amount::Amount(const Decimal &number, absl::string_view currency)
+    : number_(number), currency_(InternCurrency(currency)) {}
 
 inline Amount &Amount::operator+=(const Decimal &rhs) {
   number_ += rhs;
@@ -127,30 +159,65 @@ inline Amount &Amount::operator%=(const Decimal &rhs) {
   return *this;
 }
 
+inline Amount &Amount::operator+=(const Amount &rhs) {
+  CHECK(currency_ == rhs.currency_) << "different currencies cant add.";
+  number_ += rhs.number_;
+  return *this;
+}
+
+inline Amount &Amount::operator-=(const Amount &rhs) {
+  CHECK(currency_ == rhs.currency_) << "different currencies cant sub.";
+  number_ -= rhs.number_;
+  return *this;
+}
+
+inline Amount &Amount::AddScaled(const Amount &amount, const Decimal &factor) {
+  CHECK(currency_ == amount.currency_) << "different currencies cant add.";
+  number_.AddScaled(amount.number_, factor);
+  return *this;
+}
+
+inline absl::Status Amount::CheckedAdd(const Amount &rhs) {
+  if (currency_ != rhs.currency_) {
+    return absl::InvalidArgumentError("different currencies cant add.");
+  }
+  return number_.CheckedAdd(rhs.number_);
+}
+
+inline absl::Status Amount::CheckedSub(const Amount &rhs) {
+  if (currency_ != rhs.currency_) {
+    return absl::InvalidArgumentError("different currencies cant sub.");
+  }
+  return number_.CheckedSub(rhs.number_);
+}
+
 inline string Amount::ToString() const {
   string ret;
-  ret = absl::StrCat(ret, number_.toString());
-  ret = absl::StrCat(ret, " ");
-  ret = absl::StrCat(ret, currency_);
+  AppendTo(&ret);
   return ret;
 }
 
+inline void Amount::AppendTo(string *out) const {
+  char buf[Decimal::kMaxFormattedSize + 1];
+  char *end = number_.FormatTo(buf);
+  *end++ = ' ';
+  out->append(buf, end);
+  out->append(Currency());
+}
+
 inline Amount Amount::FromString(const string &str) {
-  std::vector<string> ret;
-  string tmp = str;
-  absl::RemoveExtraAsciiWhitespace(&tmp);
-  ret = absl::StrSplit(tmp, " ");
+  std::vector<absl::string_view> ret =
+      absl::StrSplit(str, absl::ByAnyChar(" \t\n\r\f\v"), absl::SkipEmpty());
   CHECK_EQ(ret.size(), 2);
-  CHECK(check_currency(ret[1]));
-  return Amount(Decimal(ret[0]), ret[1]);
+  return Amount(Decimal(string(ret[0])), ret[1]);
 }
 
 inline Amount Amount::Abs(const Amount &amount) {
-  return amount.Number().isNegative() ? -amount : amount;
+  return amount.Number().IsNegative() ? -amount : amount;
 }
 
 inline Amount operator-(const Amount &from) {
-  return Amount(-from.Number(), from.Currency());
+  return Amount(-from.number_, from.currency_);
 }
 
 inline std::ostream &operator<<(std::ostream &os, const Amount &amount) {
@@ -158,6 +225,7 @@ inline std::ostream &operator<<(std::ostream &os, const Amount &amount) {
 }
 
 inline bool operator<(const Amount &lhs, const Amount &rhs) {
+  // Ids are in first-seen order, so only the names tell the order.
   if (lhs.currency_ != rhs.currency_) {
     return lhs.Currency() < rhs.Currency();
   }
@@ -167,68 +235,113 @@ inline bool operator<(const Amount &lhs, const Amount &rhs) {
 }
 
 inline bool operator==(const Amount &lhs, const Amount &rhs) {
-  bool ret = true;
-  ret &= lhs.Number() == rhs.Number();
-  ret &= lhs.Currency() == rhs.Currency();
-  return ret;
+  return lhs.currency_ == rhs.currency_ && lhs.number_ == rhs.number_;
 }
 
 inline bool operator!=(const Amount &lhs, const Amount &rhs) {
   return !(lhs == rhs);
 }
 
-inline const Amount operator+(const Amount &lhs, const Decimal &rhs) {
-  return Amount(lhs) += rhs;
+// Basic math operations between an amount and a decimal. The rvalue overloads
+// reuse the left operand, so that chains like a * x + y make one copy.
+inline Amount operator+(const Amount &lhs, const Decimal &rhs) {
+  Amount ret(lhs);
+  ret += rhs;
+  return ret;
+}
+
+inline Amount operator+(Amount &&lhs, const Decimal &rhs) {
+  lhs += rhs;
+  return std::move(lhs);
 }
 
-inline const Amount operator-(const Amount &lhs, const Decimal &rhs) {
-  return Amount(lhs) -= rhs;
+inline Amount operator-(const Amount &lhs, const Decimal &rhs) {
+  Amount ret(lhs);
+  ret -= rhs;
+  return ret;
 }
 
-inline const Amount operator*(const Amount &lhs, const Decimal &rhs) {
-  return Amount(lhs) *= rhs;
+inline Amount operator-(Amount &&lhs, const Decimal &rhs) {
+  lhs -= rhs;
+  return std::move(lhs);
 }
 
-inline const Amount operator/(const Amount &lhs, const Decimal &rhs) {
-  return Amount(lhs) /= rhs;
+inline Amount operator*(const Amount &lhs, const Decimal &rhs) {
+  Amount ret(lhs);
+  ret *= rhs;
+  return ret;
 }
 
-inline const Amount operator%(const Amount &lhs, const Decimal &rhs) {
-  return Amount(lhs) %= rhs;
+inline Amount operator*(Amount &&lhs, const Decimal &rhs) {
+  lhs *= rhs;
+  return std::move(lhs);
 }
 
-const Amount operator+(const Amount &lhs, const Amount &rhs) {
-  CHECK_EQ(lhs.Currency(), rhs.Currency()) << "different currencies cant add.";
-  return Amount(lhs) += rhs.Number();
+inline Amount operator/(const Amount &lhs, const Decimal &rhs) {
+  Amount ret(lhs);
+  ret /= rhs;
+  return ret;
 }
 
-const Amount operator-(const Amount &lhs, const Amount &rhs) {
-  CHECK_EQ(lhs.Currency(), rhs.Currency()) << "different currencies cant sub.";
-  return Amount(lhs) -= rhs.Number();
+inline Amount operator/(Amount &&lhs, const Decimal &rhs) {
+  lhs /= rhs;
+  return std::move(lhs);
 }
 
-}  // namespace beanquick
+inline Amount operator%(const Amount &lhs, const Decimal &rhs) {
+  Amount ret(lhs);
+  ret %= rhs;
+  return ret;
+}
 
-namespace std {
-// Hash combiner used by TensorFlow core.
-// See tensorflow/lite/util.cc:
-size_t CombineHashes(std::initializer_list<size_t> hashes) {
-  size_t result = 0;
-  for (size_t hash : hashes) {
-    result = result ^
-             (hash + 0x9e3779b97f4a7800ULL + (result << 10) + (result >> 4));
+inline Amount operator%(Amount &&lhs, const Decimal &rhs) {
+  lhs %= rhs;
+  return std::move(lhs);
+}
+
+// Add or sub two amounts of the same currency.
+inline Amount operator+(const Amount &lhs, const Amount &rhs) {
+  Amount ret(lhs);
+  ret += rhs;
+  return ret;
+}
+
+inline Amount operator+(Amount &&lhs, const Amount &rhs) {
+  lhs += rhs;
+  return std::move(lhs);
+}
+
+inline Amount operator-(const Amount &lhs, const Amount &rhs) {
+  Amount ret(lhs);
+  ret -= rhs;
+  return ret;
+}
+
+inline Amount operator-(Amount &&lhs, const Amount &rhs) {
+  lhs -= rhs;
+  return std::move(lhs);
+}
+
+// Sums amounts of a single currency, see SumDecimals().
+inline Amount SumAmounts(absl::Span<const Amount> amounts) {
+  CHECK(!amounts.empty()) << "no amounts to sum.";
+  CurrencyId currency = amounts[0].currency_;
+  DecimalAccumulator sum;
+  for (const Amount &amount : amounts) {
+    CHECK(amount.currency_ == currency) << "different currencies cant add.";
+    sum.Add(amount.number_);
   }
-  return result;
+  return Amount(sum.Total(), currency);
 }
 
-// NOTE: if two amounts have the same number and currency,
-// The hash values should be the same, right?
+}  // namespace beanquick
+
+namespace std {
+// For std::unordered_map and friends, the same hash as absl::Hash.
 template <>
 struct hash<::beanquick::Amount> {
   std::size_t operator()(const ::beanquick::Amount &a) const {
-    std::size_t x = hash<string>{}(a.ToString());
-    std::size_t y = hash<string>{}(a.Currency());
-    return CombineHashes({x, y});
+    return absl::Hash<::beanquick::Amount>{}(a);
   }
 };
 
@@ -0,0 +1,252 @@
+#include <functional>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "amount.h"
+#include "amount_parser.h"
+#include "beanquick/core/benchmark_util.h"
+#include "benchmark/benchmark.h"
+
+namespace beanquick {
+namespace {
+
+std::vector<Amount> LedgerAmounts() {
+  const char* currencies[] = {"USD", "EUR", "BTC", "VANGUARD_500"};
+  std::vector<Amount> amounts;
+  for (int i = 0; i < 4096; i++) {
+    string number = absl::StrCat(i * 7919 % 100000, ".", i % 100);
+    amounts.emplace_back(Decimal(i % 3 ? number : "-" + number),
+                         currencies[i % 4]);
+  }
+  return amounts;
+}
+
+// Writing a journal: every amount appended to one output string. This is
+// what Amount::ToString() used to do.
+void BM_LegacyToString(benchmark::State& state) {
+  std::vector<Amount> amounts = LedgerAmounts();
+  for (auto _ : state) {
+    string out;
+    for (auto& a : amounts) {
+      string ret;
+      ret = absl::StrCat(ret, a.Number().ToNumber().toString());
+      ret = absl::StrCat(ret, " ");
+      ret = absl::StrCat(ret, a.Currency());
+      out += ret;
+      out += '\n';
+    }
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetItemsProcessed(state.iterations() * amounts.size());
+}
+BENCHMARK(BM_LegacyToString);
+
+void BM_AmountToString(benchmark::State& state) {
+  std::vector<Amount> amounts = LedgerAmounts();
+  for (auto _ : state) {
+    string out;
+    for (auto& a : amounts) {
+      out += a.ToString();
+      out += '\n';
+    }
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetItemsProcessed(state.iterations() * amounts.size());
+}
+BENCHMARK(BM_AmountToString);
+
+void BM_AmountAppendTo(benchmark::State& state) {
+  std::vector<Amount> amounts = LedgerAmounts();
+  for (auto _ : state) {
+    string out;
+    for (auto& a : amounts) {
+      a.AppendTo(&out);
+      out += '\n';
+    }
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetItemsProcessed(state.iterations() * amounts.size());
+}
+BENCHMARK(BM_AmountAppendTo);
+
+void BM_StrAppendDecimalAlphaNum(benchmark::State& state) {
+  std::vector<Amount> amounts = LedgerAmounts();
+  for (auto _ : state) {
+    string out;
+    for (auto& a : amounts) {
+      absl::StrAppend(&out, DecimalAlphaNum(a.Number()), " ", a.Currency(),
+                      "\n");
+    }
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetItemsProcessed(state.iterations() * amounts.size());
+}
+BENCHMARK(BM_StrAppendDecimalAlphaNum);
+
+void BM_AmountFromString(benchmark::State& state) {
+  std::vector<string> strings;
+  for (auto& a : BenchmarkAmounts(GetValueMix(&state))) {
+    strings.push_back(a.ToString());
+  }
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Amount::FromString(strings[i++ % kNumValues]));
+  }
+}
+BENCHMARK(BM_AmountFromString)->Apply(ValueMixes);
+
+// A column of a bank statement import, kNumValues amounts a line.
+void BM_AmountParserParseAll(benchmark::State& state) {
+  string column;
+  for (auto& a : BenchmarkAmounts(GetValueMix(&state))) {
+    a.AppendTo(&column);
+    column += '\n';
+  }
+  AmountParser parser;
+  std::vector<Amount> amounts;
+  amounts.reserve(kNumValues);
+  int64 allocs = 0;
+  for (auto _ : state) {
+    amounts.clear();
+    int64 start = AllocationCount();
+    absl::Status status = parser.ParseAll(column, &amounts);
+    allocs += AllocationCount() - start;
+    benchmark::DoNotOptimize(status);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumValues);
+  state.counters["allocs/amount"] =
+      static_cast<double>(allocs) /
+      (static_cast<double>(state.iterations()) * kNumValues);
+}
+BENCHMARK(BM_AmountParserParseAll)->Apply(ValueMixes);
+
+void BM_AmountHash(benchmark::State& state) {
+  std::vector<Amount> amounts = BenchmarkAmounts(GetValueMix(&state));
+  std::hash<Amount> hash;
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hash(amounts[i++ % kNumValues]));
+  }
+}
+BENCHMARK(BM_AmountHash)->Apply(ValueMixes);
+
+// Dedup of the amounts of a journal, one insert per iteration. After the
+// first round every insert finds its amount already there.
+void BM_AmountFlatHashSetInsert(benchmark::State& state) {
+  std::vector<Amount> amounts = BenchmarkAmounts(GetValueMix(&state));
+  absl::flat_hash_set<Amount> seen;
+  seen.reserve(kNumValues);
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    seen.insert(amounts[i++ % kNumValues]);
+  }
+  benchmark::DoNotOptimize(seen.size());
+}
+BENCHMARK(BM_AmountFlatHashSetInsert)->Apply(ValueMixes);
+
+void BM_AmountCopy(benchmark::State& state) {
+  std::vector<Amount> amounts = BenchmarkAmounts(GetValueMix(&state));
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    Amount copy(amounts[i++ % kNumValues]);
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_AmountCopy)->Apply(ValueMixes);
+
+void BM_AmountLess(benchmark::State& state) {
+  std::vector<Amount> amounts = BenchmarkAmounts(GetValueMix(&state));
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    const Amount& a = amounts[i % kNumValues];
+    const Amount& b = amounts[(i * 7 + 3) % kNumValues];
+    benchmark::DoNotOptimize(a < b);
+    i++;
+  }
+}
+BENCHMARK(BM_AmountLess)->Apply(ValueMixes);
+
+// Fractional quantities and rates, to scale amounts by. Below one, so that
+// the large mix doesn't overflow when summing the products.
+std::vector<Decimal> Factors() {
+  std::vector<Decimal> factors;
+  for (int i = 0; i < kNumValues; i++) {
+    factors.emplace_back(absl::StrFormat("0.%02d", i * 37 % 99 + 1));
+  }
+  return factors;
+}
+
+// Arithmetic benchmarks keep one running Amount per currency, so that the
+// result feeds the next operation like in a balance.
+void BM_AmountAddAmount(benchmark::State& state) {
+  std::vector<Amount> amounts = BenchmarkAmounts(GetValueMix(&state));
+  std::vector<Amount> totals(amounts.begin(), amounts.begin() + 32);
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    const Amount& a = amounts[i % kNumValues];
+    Amount& total = totals[i % 32];
+    // Every other round subtracts, so that the totals don't run away.
+    if ((i / kNumValues) % 2) {
+      total -= a;
+    }
+    else {
+      total += a;
+    }
+    i++;
+  }
+  benchmark::DoNotOptimize(totals);
+}
+BENCHMARK(BM_AmountAddAmount)->Apply(ValueMixes);
+
+void BM_AmountAddOperator(benchmark::State& state) {
+  std::vector<Amount> amounts = BenchmarkAmounts(GetValueMix(&state));
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    const Amount& a = amounts[i % kNumValues];
+    benchmark::DoNotOptimize(a + a.Number());
+    i++;
+  }
+}
+BENCHMARK(BM_AmountAddOperator)->Apply(ValueMixes);
+
+void BM_AmountMul(benchmark::State& state) {
+  std::vector<Amount> amounts = BenchmarkAmounts(GetValueMix(&state));
+  std::vector<Decimal> factors = Factors();
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(amounts[i % kNumValues] * factors[i % kNumValues]);
+    i++;
+  }
+}
+BENCHMARK(BM_AmountMul)->Apply(ValueMixes);
+
+// The total cost of lots, price * quantity summed in place.
+void BM_AmountAddScaled(benchmark::State& state) {
+  std::vector<Amount> amounts = BenchmarkAmounts(GetValueMix(&state));
+  std::vector<Decimal> factors[2] = {Factors(), Factors()};
+  for (auto& factor : factors[1]) factor.Negate();
+  std::vector<Amount> totals(amounts.begin(), amounts.begin() + 32);
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    const Amount& a = amounts[i % kNumValues];
+    const Decimal& factor = factors[(i / kNumValues) % 2][i % kNumValues];
+    totals[i % 32].AddScaled(a, factor);
+    i++;
+  }
+  benchmark::DoNotOptimize(totals);
+}
+BENCHMARK(BM_AmountAddScaled)->Apply(ValueMixes);
+
+}  // namespace
+}  // namespace beanquick
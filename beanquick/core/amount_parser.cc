@@ -0,0 +1,174 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "beanquick/core/amount_parser.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+
+namespace beanquick {
+
+namespace {
+inline bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' ||
+         c == '\v';
+}
+
+// Index of the first non space at or after `i`.
+inline size_t SkipSpaces(absl::string_view text, size_t i) {
+  while (i < text.size() && IsSpace(text[i])) i++;
+  return i;
+}
+
+// Index of the first space at or after `i`.
+inline size_t SkipToken(absl::string_view text, size_t i) {
+  while (i < text.size() && !IsSpace(text[i])) i++;
+  return i;
+}
+
+// Calls `fn(record, offset)` on the non blank records of `buffer` until it
+// returns false.
+template <typename Fn>
+void ForEachRecord(absl::string_view buffer, char separator, Fn fn) {
+  size_t begin = 0;
+  while (begin < buffer.size()) {
+    size_t end = buffer.find(separator, begin);
+    if (end == absl::string_view::npos) end = buffer.size();
+    absl::string_view record = buffer.substr(begin, end - begin);
+    if (SkipSpaces(record, 0) != record.size() && !fn(record, begin)) return;
+    begin = end + 1;
+  }
+}
+
+absl::Status Annotate(const absl::Status &status, size_t offset) {
+  return absl::Status(status.code(),
+                      absl::StrCat("offset ", offset, ": ", status.message()));
+}
+}  // namespace
+
+// -----------------------------------------------------------------------------
+// AmountParser Implementation.
+// -----------------------------------------------------------------------------
+AmountParser::AmountParser(char separator) : separator_(separator) {}
+
+absl::Status AmountParser::LookupCurrency(absl::string_view symbol,
+                                          CurrencyId *id) {
+  if (last_id_ != kNoCurrency && symbol == last_symbol_) {
+    *id = last_id_;
+    return absl::OkStatus();
+  }
+  auto it = currencies_.find(symbol);
+  if (it != currencies_.end()) {
+    *id = it->second;
+  }
+  else {
+    if (!CurrencyTable::Global().Intern(symbol, id)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("invalid currency '", symbol, "'"));
+    }
+    currencies_.emplace(string(symbol), *id);
+  }
+  last_symbol_.assign(symbol.data(), symbol.size());
+  last_id_ = *id;
+  return absl::OkStatus();
+}
+
+absl::Status AmountParser::ParseRecord(absl::string_view record, size_t offset,
+                                       Amount *out) {
+  size_t number_begin = SkipSpaces(record, 0);
+  size_t number_end = SkipToken(record, number_begin);
+  size_t currency_begin = SkipSpaces(record, number_end);
+  size_t currency_end = SkipToken(record, currency_begin);
+  if (number_begin == number_end) {
+    error_offset_ = offset;
+    return absl::InvalidArgumentError(
+        absl::StrCat("offset ", offset, ": empty amount"));
+  }
+  if (currency_begin == currency_end) {
+    error_offset_ = offset + number_end;
+    return absl::InvalidArgumentError(absl::StrCat(
+        "offset ", error_offset_, ": missing currency in '",
+        record.substr(number_begin, number_end - number_begin), "'"));
+  }
+  size_t rest = SkipSpaces(record, currency_end);
+  if (rest != record.size()) {
+    error_offset_ = offset + rest;
+    return absl::InvalidArgumentError(
+        absl::StrCat("offset ", error_offset_, ": unexpected '",
+                     record.substr(rest, SkipToken(record, rest) - rest),
+                     "' after the currency"));
+  }
+
+  Decimal number;
+  absl::Status status = Decimal::Parse(
+      record.substr(number_begin, number_end - number_begin), &number);
+  if (!status.ok()) {
+    error_offset_ = offset + number_begin;
+    return Annotate(status, error_offset_);
+  }
+  CurrencyId currency;
+  status = LookupCurrency(
+      record.substr(currency_begin, currency_end - currency_begin),
+      &currency);
+  if (!status.ok()) {
+    error_offset_ = offset + currency_begin;
+    return Annotate(status, error_offset_);
+  }
+  *out = Amount(std::move(number), currency);
+  return absl::OkStatus();
+}
+
+absl::Status AmountParser::Parse(absl::string_view text, Amount *out) {
+  return ParseRecord(text, 0, out);
+}
+
+absl::Status AmountParser::ParseAll(absl::string_view buffer,
+                                    std::vector<Amount> *out) {
+  absl::Status ret;
+  ForEachRecord(buffer, separator_,
+                [this, out, &ret](absl::string_view record, size_t offset) {
+                  Amount amount(Decimal(), kNoCurrency);
+                  ret = ParseRecord(record, offset, &amount);
+                  if (!ret.ok()) return false;
+                  out->push_back(std::move(amount));
+                  return true;
+                });
+  return ret;
+}
+
+size_t AmountParser::ParseAll(absl::string_view buffer,
+                              std::vector<Amount> *out,
+                              std::vector<AmountParseError> *errors) {
+  size_t bad = 0;
+  ForEachRecord(
+      buffer, separator_,
+      [this, out, errors, &bad](absl::string_view record, size_t offset) {
+        Amount amount(Decimal(), kNoCurrency);
+        absl::Status status = ParseRecord(record, offset, &amount);
+        if (status.ok()) {
+          out->push_back(std::move(amount));
+        }
+        else {
+          errors->push_back({error_offset_, std::move(status)});
+          bad++;
+        }
+        return true;
+      });
+  return bad;
+}
+
+}  // namespace beanquick
@@ -0,0 +1,94 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef DEANQUICK_AMOUNT_PARSER_H_
+#define DEANQUICK_AMOUNT_PARSER_H_
+
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "beanquick/core/amount.h"
+#include "beanquick/core/currency.h"
+
+namespace beanquick {
+
+// A record AmountParser couldn't parse.
+struct AmountParseError {
+  // Byte offset into the buffer of the offending token, or of the record
+  // when it is missing a token.
+  size_t offset;
+  absl::Status status;
+};
+
+// -----------------------------------------------------------------------------
+// AmountParser Definition.
+// -----------------------------------------------------------------------------
+// Parses "<number> <currency>" records, e.g. "-1,234.56 USD", out of a whole
+// buffer such as a CSV column or a block of ledger text, without copying it.
+// Records are split on `separator`, surrounding whitespace is ignored and so
+// are blank records.
+//
+// Currencies resolve through a cache owned by the parser, so a buffer in a
+// handful of currencies only goes to the CurrencyTable once per symbol. Reuse
+// one parser for a whole import. Not thread safe, use one per thread.
+//
+//   AmountParser parser;
+//   std::vector<Amount> amounts;
+//   absl::Status status = parser.ParseAll(column, &amounts);
+class AmountParser {
+ public:
+  explicit AmountParser(char separator = '\n');
+
+  AmountParser(const AmountParser &) = delete;
+  AmountParser &operator=(const AmountParser &) = delete;
+
+  // Parses a single record, the whole of `text`.
+  absl::Status Parse(absl::string_view text, Amount *out);
+
+  // Appends the amounts of `buffer` to `out`. Stops at the first bad record
+  // and returns its error, with error_offset() set; the amounts before it
+  // are kept.
+  absl::Status ParseAll(absl::string_view buffer, std::vector<Amount> *out);
+
+  // Like ParseAll(), but skips bad records, appending them to `errors`.
+  // Returns the number of bad records.
+  size_t ParseAll(absl::string_view buffer, std::vector<Amount> *out,
+                  std::vector<AmountParseError> *errors);
+
+  // Byte offset of the last error of ParseAll() or Parse().
+  size_t error_offset() const { return error_offset_; }
+
+ private:
+  // Parses the record at `offset` of the current buffer.
+  absl::Status ParseRecord(absl::string_view record, size_t offset,
+                           Amount *out);
+
+  absl::Status LookupCurrency(absl::string_view symbol, CurrencyId *id);
+
+  char separator_;
+  size_t error_offset_ = 0;
+
+  // The last currency seen, records come in runs of one currency.
+  string last_symbol_;
+  CurrencyId last_id_ = kNoCurrency;
+  absl::flat_hash_map<string, CurrencyId> currencies_;
+};
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_AMOUNT_PARSER_H_
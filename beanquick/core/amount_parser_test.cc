@@ -0,0 +1,81 @@
+#include "amount_parser.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace beanquick {
+#define D Decimal
+
+TEST(TestAmountParser, Parse) {
+  AmountParser parser;
+  Amount a(D("0"), "USD");
+  ASSERT_TRUE(parser.Parse("  -1,234.56   USD\t", &a).ok());
+  EXPECT_EQ(Amount(D("-1234.56"), "USD"), a);
+  ASSERT_TRUE(parser.Parse("0.00000001 BTC", &a).ok());
+  EXPECT_EQ(Amount(D("0.00000001"), "BTC"), a);
+  ASSERT_TRUE(parser.Parse("+5 USD", &a).ok());
+  EXPECT_EQ(Amount(D("5"), "USD"), a);
+}
+
+TEST(TestAmountParser, Errors) {
+  AmountParser parser;
+  Amount a(D("1"), "USD");
+  absl::Status status = parser.Parse("100", &a);
+  EXPECT_EQ(absl::StatusCode::kInvalidArgument, status.code());
+  EXPECT_EQ(3, parser.error_offset());
+  EXPECT_EQ("offset 3: missing currency in '100'", status.message());
+
+  status = parser.Parse("  1.5 usd", &a);
+  EXPECT_EQ(absl::StatusCode::kInvalidArgument, status.code());
+  EXPECT_EQ(6, parser.error_offset());
+  EXPECT_EQ("offset 6: invalid currency 'usd'", status.message());
+
+  status = parser.Parse("x1 USD", &a);
+  EXPECT_EQ(0, parser.error_offset());
+  status = parser.Parse("1 USD EUR", &a);
+  EXPECT_EQ(6, parser.error_offset());
+  EXPECT_EQ("offset 6: unexpected 'EUR' after the currency", status.message());
+  status = parser.Parse("123456789012345678901 USD", &a);
+  EXPECT_EQ(absl::StatusCode::kOutOfRange, status.code());
+
+  // Nothing is written on errors.
+  EXPECT_EQ(Amount(D("1"), "USD"), a);
+}
+
+TEST(TestAmountParser, ParseAll) {
+  AmountParser parser;
+  std::vector<Amount> amounts;
+  ASSERT_TRUE(parser.ParseAll("1 USD\n\n  2.50 EUR  \r\n3 USD", &amounts).ok());
+  std::vector<Amount> expected = {Amount(D("1"), "USD"),
+                                  Amount(D("2.50"), "EUR"),
+                                  Amount(D("3"), "USD")};
+  EXPECT_EQ(expected, amounts);
+
+  // Stops at the first bad record, keeping the ones before.
+  amounts.clear();
+  absl::Status status = parser.ParseAll("1 USD\n2 EUR\n3 eur\n4 USD", &amounts);
+  EXPECT_FALSE(status.ok());
+  EXPECT_EQ(14, parser.error_offset());
+  EXPECT_EQ(2, amounts.size());
+
+  // Or skips them.
+  amounts.clear();
+  std::vector<AmountParseError> errors;
+  EXPECT_EQ(2, parser.ParseAll("1 USD\nx EUR\n3 eur\n4 USD", &amounts,
+                               &errors));
+  EXPECT_EQ(2, amounts.size());
+  ASSERT_EQ(2, errors.size());
+  EXPECT_EQ(6, errors[0].offset);
+  EXPECT_EQ(14, errors[1].offset);
+}
+
+TEST(TestAmountParser, Separator) {
+  AmountParser parser(',');
+  std::vector<Amount> amounts;
+  ASSERT_TRUE(parser.ParseAll("1 USD, 2 USD,,3 HOOL", &amounts).ok());
+  EXPECT_EQ(3, amounts.size());
+  EXPECT_EQ(Amount(D("3"), "HOOL"), amounts[2]);
+}
+
+}  // namespace beanquick
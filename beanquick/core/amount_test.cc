@@ -4,6 +4,8 @@
 #include <unordered_set>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash_testing.h"
 #include "decimal.h"
 #include "gtest/gtest.h"
 
@@ -44,6 +46,12 @@ TEST(TestAmount, ToString) {
 
   Amount a2(D("0.00000001"), "BTC");
   EXPECT_EQ("0.00000001 BTC", a2.ToString());
+
+  string out = "Balance: ";
+  a1.AppendTo(&out);
+  out += ", ";
+  (-a2).AppendTo(&out);
+  EXPECT_EQ("Balance: 100034.023 USD, -0.00000001 BTC", out);
 }
 
 TEST(TestAmount, Comparisons) {
@@ -135,6 +143,80 @@ TEST(TestAmount, Sub) {
                "failed");
 }
 
+TEST(TestAmount, FlatHash) {
+  EXPECT_TRUE(absl::VerifyTypeImplementsAbslHashCorrectly({
+      Amount(D("1.5"), "USD"), Amount(D("1.50"), "USD"),
+      Amount(D("1.5"), "EUR"), Amount(D("15"), "USD"),
+      Amount(D("0"), "USD"), Amount(D("0.00"), "EUR")}));
+
+  absl::flat_hash_map<Amount, int> counts;
+  for (const char *s : {"1.5 USD", "1.50 USD", "1.5 EUR", "2 USD", "2.0 USD"}) {
+    counts[Amount::FromString(s)]++;
+  }
+  EXPECT_EQ(3, counts.size());
+  EXPECT_EQ(2, (counts[Amount(D("1.5"), "USD")]));
+  EXPECT_EQ(std::hash<Amount>{}(Amount(D("2"), "USD")),
+            std::hash<Amount>{}(Amount(D("2.000"), "USD")));
+}
+
+TEST(TestAmount, Move) {
+  Amount a(D("123456789012345.12345678"), "RMB");
+  Amount b(std::move(a));
+  EXPECT_EQ(Amount(D("123456789012345.12345678"), "RMB"), b);
+  Amount c(D("1"), "USD");
+  c = std::move(b);
+  EXPECT_EQ(Amount(D("123456789012345.12345678"), "RMB"), c);
+
+  // The rvalue operators work on the left operand in place.
+  Amount d = Amount(D("2"), "RMB") * D("3") + D("1") - Amount(D("0.5"), "RMB");
+  EXPECT_EQ(Amount(D("6.5"), "RMB"), d);
+  const Decimal &number = d.Number();
+  d += Amount(D("1"), "RMB");
+  EXPECT_EQ(D("7.5"), number);
+  EXPECT_DEATH({ d -= Amount(D("1"), "CAD"); }, "failed");
+}
+
+TEST(TestAmount, AddScaled) {
+  Amount total(D("0"), "USD");
+  total.AddScaled(Amount(D("500.25"), "USD"), D("10"));
+  total.AddScaled(D("1.5"), D("-2"));
+  EXPECT_EQ(Amount(D("4999.5"), "USD"), total);
+  EXPECT_DEATH({ total.AddScaled(Amount(D("1"), "CAD"), D("1")); }, "failed");
+}
+
+TEST(TestAmount, Checked) {
+  Amount a(D("100"), "RMB");
+  EXPECT_TRUE(a.CheckedAdd(Amount(D("17.02"), "RMB")).ok());
+  EXPECT_EQ(Amount(D("117.02"), "RMB"), a);
+  EXPECT_TRUE(a.CheckedSub(D("0.02")).ok());
+  EXPECT_TRUE(a.CheckedMul(D("2")).ok());
+  EXPECT_TRUE(a.CheckedDiv(D("4")).ok());
+  EXPECT_EQ(Amount(D("58.5"), "RMB"), a);
+
+  EXPECT_EQ(a.CheckedAdd(Amount(D("1"), "CAD")).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(a.CheckedSub(Amount(D("1"), "CAD")).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(a.CheckedDiv(D("0")).code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(a.CheckedMul(D("9223372036854775807")).code(),
+            absl::StatusCode::kOutOfRange);
+  EXPECT_EQ(Amount(D("58.5"), "RMB"), a);
+}
+
+TEST(TestAmount, SumAmounts) {
+  std::vector<Amount> amounts = {
+      Amount(D("100"), "RMB"),
+      Amount(D("17.02"), "RMB"),
+      Amount(D("-0.005"), "RMB"),
+  };
+  Amount sum = SumAmounts(amounts);
+  EXPECT_EQ(Amount(D("117.015"), "RMB"), sum);
+  EXPECT_EQ("117.015 RMB", sum.ToString());
+
+  amounts.push_back(Amount(D("1"), "CAD"));
+  EXPECT_DEATH({ SumAmounts(amounts); }, "failed");
+}
+
 TEST(TestAmount, Abs) {
   EXPECT_EQ(Amount(D("82.98"), "RMB"), Amount::Abs(Amount(D("82.98"), "RMB")));
   EXPECT_EQ(Amount(D("0"), "RMB"), Amount::Abs(Amount(D("0"), "RMB")));
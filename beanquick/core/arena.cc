@@ -0,0 +1,115 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "beanquick/core/arena.h"
+
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "beanquick/core/logging.h"
+
+namespace beanquick {
+
+constexpr size_t Arena::kFirstBlockSize;
+constexpr size_t Arena::kMaxBlockSize;
+constexpr size_t Arena::kHugePageSize;
+
+Arena::Arena(size_t first_block_size)
+    : next_block_size_(std::max<size_t>(first_block_size, 256)) {}
+
+Arena::~Arena() {
+  for (Cleanup *it = cleanups_; it != nullptr; it = it->next) {
+    it->cleanup(it->object);
+  }
+  Block *block = head_;
+  while (block != nullptr) {
+    Block *prev = block->prev;
+    std::free(block);
+    block = prev;
+  }
+}
+
+Arena::Block *Arena::NewBlock(size_t size) {
+  Block *block;
+  size_t bytes = sizeof(Block) + size;
+  if (bytes >= kHugePageSize) {
+    // Large blocks in whole huge pages, where the kernel allows them on
+    // request, take a page fault per 2 MiB rather than per 4 KiB when first
+    // touched. That is a good part of the time spent filling a large arena.
+    bytes = (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    void *memory = nullptr;
+    if (posix_memalign(&memory, kHugePageSize, bytes) != 0) memory = nullptr;
+#ifdef MADV_HUGEPAGE
+    if (memory != nullptr) madvise(memory, bytes, MADV_HUGEPAGE);
+#endif
+    block = static_cast<Block *>(memory);
+  }
+  else {
+    block = static_cast<Block *>(std::malloc(bytes));
+  }
+  CHECK(block != nullptr) << "Arena: out of memory allocating " << size;
+  block->size = bytes - sizeof(Block);
+  bytes_reserved_ += block->size;
+  num_blocks_++;
+  return block;
+}
+
+void *Arena::AllocateSlow(size_t size, size_t align) {
+  // The worst case padding.
+  size_t needed = size + align - 1;
+  if (needed > next_block_size_ / 4 && head_ != nullptr) {
+    // Too large to be worth abandoning the rest of the current block, give
+    // it a block of its own behind it.
+    Block *block = NewBlock(needed);
+    block->prev = head_->prev;
+    head_->prev = block;
+    bytes_used_before_ += needed;
+    uintptr_t begin = reinterpret_cast<uintptr_t>(block + 1);
+    return reinterpret_cast<void *>((begin + align - 1) & ~(align - 1));
+  }
+
+  if (head_ != nullptr) {
+    bytes_used_before_ += ptr_ - reinterpret_cast<char *>(head_ + 1);
+  }
+  // Block sizes count the header, so that large ones are whole huge pages.
+  size_t block_size = std::max(next_block_size_ - sizeof(Block), needed);
+  next_block_size_ = std::min(next_block_size_ * 2, kMaxBlockSize);
+  Block *block = NewBlock(block_size);
+  block->prev = head_;
+  head_ = block;
+  ptr_ = reinterpret_cast<char *>(block + 1);
+  end_ = ptr_ + block->size;
+  return Allocate(size, align);
+}
+
+void Arena::AddCleanup(void *object, void (*cleanup)(void *)) {
+  Cleanup *node = New<Cleanup>();
+  node->object = object;
+  node->cleanup = cleanup;
+  node->next = cleanups_;
+  cleanups_ = node;
+}
+
+size_t Arena::bytes_used() const {
+  if (head_ == nullptr) return 0;
+  return bytes_used_before_ +
+         (ptr_ - reinterpret_cast<const char *>(head_ + 1));
+}
+
+}  // namespace beanquick
@@ -0,0 +1,148 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef DEANQUICK_ARENA_H_
+#define DEANQUICK_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "beanquick/core/base.h"
+
+namespace beanquick {
+
+// -----------------------------------------------------------------------------
+// Arena Definition.
+// -----------------------------------------------------------------------------
+// A bump allocator. Memory is carved out of blocks which double in size, and
+// is only given back when the arena goes away, all at once. Destructors of
+// what lives in the arena are not run, except for the objects registered
+// with AddCleanup(), so freeing an arena costs one call per block plus one
+// per cleanup, however many objects it holds. Not thread safe.
+class Arena {
+ public:
+  explicit Arena(size_t first_block_size = kFirstBlockSize);
+  ~Arena();
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  // Returns `size` bytes aligned to `align`, a power of two.
+  void *Allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+    uintptr_t begin =
+        (reinterpret_cast<uintptr_t>(ptr_) + align - 1) & ~(align - 1);
+    if (begin + size <= reinterpret_cast<uintptr_t>(end_)) {
+      ptr_ = reinterpret_cast<char *>(begin + size);
+      return reinterpret_cast<void *>(begin);
+    }
+    return AllocateSlow(size, align);
+  }
+
+  // Constructs a T in the arena. Its destructor won't run, see AddCleanup().
+  template <class T, class... Args>
+  T *New(Args &&... args) {
+    return new (Allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  // Default constructs `count` T's in the arena.
+  template <class T>
+  absl::Span<T> NewArray(size_t count) {
+    if (count == 0) return absl::Span<T>();
+    T *values = static_cast<T *>(Allocate(sizeof(T) * count, alignof(T)));
+    for (size_t i = 0; i < count; i++) new (values + i) T();
+    return absl::Span<T>(values, count);
+  }
+
+  // Copies `from` into the arena.
+  template <class T>
+  absl::Span<T> CopyArray(absl::Span<const T> from) {
+    if (from.empty()) return absl::Span<T>();
+    T *values =
+        static_cast<T *>(Allocate(sizeof(T) * from.size(), alignof(T)));
+    for (size_t i = 0; i < from.size(); i++) new (values + i) T(from[i]);
+    return absl::Span<T>(values, from.size());
+  }
+
+  absl::string_view CopyString(absl::string_view str) {
+    if (str.empty()) return absl::string_view();
+    char *data = static_cast<char *>(Allocate(str.size(), 1));
+    std::memcpy(data, str.data(), str.size());
+    return absl::string_view(data, str.size());
+  }
+
+  // Has `cleanup(object)` called when the arena goes away, in the reverse
+  // order of registration.
+  void AddCleanup(void *object, void (*cleanup)(void *));
+
+  // Runs `object`'s destructor when the arena goes away.
+  template <class T>
+  void Own(T *object) {
+    AddCleanup(object, [](void *p) { static_cast<T *>(p)->~T(); });
+  }
+
+  // Bytes handed out, counting alignment padding.
+  size_t bytes_used() const;
+
+  // Bytes held in blocks.
+  size_t bytes_reserved() const { return bytes_reserved_; }
+
+  int num_blocks() const { return num_blocks_; }
+
+  static constexpr size_t kFirstBlockSize = 4096;
+  // Blocks stop doubling at this size.
+  static constexpr size_t kMaxBlockSize = 16 << 20;
+  // Blocks from this size on are rounded up to whole huge pages.
+  static constexpr size_t kHugePageSize = 2 << 20;
+
+ private:
+  struct Block {
+    Block *prev;
+    size_t size;
+  };
+
+  struct Cleanup {
+    void *object;
+    void (*cleanup)(void *);
+    Cleanup *next;
+  };
+
+  void *AllocateSlow(size_t size, size_t align);
+
+  // Allocates a block with room for at least `size` bytes, the room it
+  // actually has in Block::size.
+  Block *NewBlock(size_t size);
+
+  // The block being carved, and [ptr_, end_) the room left in it.
+  Block *head_ = nullptr;
+  char *ptr_ = nullptr;
+  char *end_ = nullptr;
+  size_t next_block_size_;
+  size_t bytes_reserved_ = 0;
+  // Bytes given out of the blocks before head_.
+  size_t bytes_used_before_ = 0;
+  int num_blocks_ = 0;
+  Cleanup *cleanups_ = nullptr;
+};
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_ARENA_H_
@@ -0,0 +1,89 @@
+#include "arena.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace beanquick {
+namespace {
+
+TEST(TestArena, Allocate) {
+  Arena arena;
+  EXPECT_EQ(0, arena.bytes_used());
+  EXPECT_EQ(0, arena.num_blocks());
+
+  char *first = static_cast<char *>(arena.Allocate(3, 1));
+  char *second = static_cast<char *>(arena.Allocate(5, 1));
+  EXPECT_EQ(first + 3, second);
+  EXPECT_EQ(8, arena.bytes_used());
+  EXPECT_EQ(1, arena.num_blocks());
+
+  for (size_t align : {2, 4, 8, 16, 64}) {
+    void *p = arena.Allocate(1, align);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % align) << align;
+  }
+}
+
+TEST(TestArena, Blocks) {
+  Arena arena(256);
+  std::vector<int64 *> values;
+  for (int i = 0; i < 100000; i++) {
+    int64 *value = arena.New<int64>(i);
+    values.push_back(value);
+  }
+  for (int i = 0; i < 100000; i++) {
+    ASSERT_EQ(i, *values[i]);
+  }
+  EXPECT_EQ(100000 * sizeof(int64), arena.bytes_used());
+  // Blocks double, so there are few of them.
+  EXPECT_LT(arena.num_blocks(), 20);
+  EXPECT_GE(arena.bytes_reserved(), arena.bytes_used());
+
+  // Large allocations get a block of their own, behind the current one.
+  char *before = static_cast<char *>(arena.Allocate(8, 8));
+  arena.Allocate(Arena::kMaxBlockSize, 8);
+  char *after = static_cast<char *>(arena.Allocate(8, 8));
+  EXPECT_EQ(before + 8, after);
+}
+
+TEST(TestArena, Arrays) {
+  Arena arena;
+  absl::Span<int> ints = arena.NewArray<int>(4);
+  ASSERT_EQ(4, ints.size());
+  for (int value : ints) EXPECT_EQ(0, value);
+  EXPECT_TRUE(arena.NewArray<int>(0).empty());
+
+  std::vector<int> from = {1, 2, 3};
+  absl::Span<int> copy = arena.CopyArray<int>(from);
+  EXPECT_EQ(std::vector<int>(copy.begin(), copy.end()), from);
+
+  string str = "Assets:Cash";
+  absl::string_view view = arena.CopyString(str);
+  str[0] = 'X';
+  EXPECT_EQ("Assets:Cash", view);
+  EXPECT_TRUE(arena.CopyString("").empty());
+}
+
+struct Counted {
+  explicit Counted(std::vector<int> *log, int id) : log(log), id(id) {}
+  ~Counted() { log->push_back(id); }
+  std::vector<int> *log;
+  int id;
+};
+
+TEST(TestArena, Cleanup) {
+  std::vector<int> log;
+  {
+    Arena arena;
+    arena.Own(arena.New<Counted>(&log, 1));
+    arena.New<Counted>(&log, 2);
+    arena.Own(arena.New<Counted>(&log, 3));
+    EXPECT_TRUE(log.empty());
+  }
+  // In the reverse order, only those registered.
+  EXPECT_EQ(std::vector<int>({3, 1}), log);
+}
+
+}  // namespace
+}  // namespace beanquick
@@ -0,0 +1,183 @@
+#include "beanquick/core/benchmark_util.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "beanquick/core/directive.h"
+#include "beanquick/core/logging.h"
+
+namespace beanquick {
+namespace {
+
+std::atomic<int64> allocations{0};
+
+void* CountedAlloc(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+
+const char* const kValueMixNames[kNumValueMixes] = {"cash", "ledger",
+                                                     "crypto", "large"};
+
+}  // namespace
+
+int64 AllocationCount() {
+  return allocations.load(std::memory_order_relaxed);
+}
+
+void ValueMixes(benchmark::internal::Benchmark* b) {
+  b->ArgName("mix")->DenseRange(0, kNumValueMixes - 1);
+}
+
+ValueMix GetValueMix(benchmark::State* state) {
+  int mix = static_cast<int>(state->range(0));
+  state->SetLabel(kValueMixNames[mix]);
+  return static_cast<ValueMix>(mix);
+}
+
+std::vector<string> BenchmarkNumbers(ValueMix mix) {
+  std::mt19937 rng(20200101);
+  std::uniform_int_distribution<int> kind(0, 9);
+  std::uniform_int_distribution<int64> cents(1, 10000000);
+  std::uniform_int_distribution<int64> satoshis(1, 100000000);
+  std::uniform_int_distribution<int64> large(1000000000000000LL,
+                                             99999999999999999LL);
+  std::vector<string> numbers;
+  numbers.reserve(kNumValues);
+  for (int i = 0; i < kNumValues; i++) {
+    int k = kind(rng);
+    int64 c = cents(rng);
+    const char* sign = (k & 1) ? "-" : "";
+    switch (mix) {
+      case ValueMix::kCash:
+        numbers.push_back(absl::StrFormat("%s%d.%02d", sign, c / 100, c % 100));
+        break;
+      case ValueMix::kLedger:
+        if (k < 6) {
+          numbers.push_back(
+              absl::StrFormat("%s%d.%02d", sign, c / 100, c % 100));
+        }
+        else if (k < 8) {
+          int64 n = c * 1000 + k;
+          numbers.push_back(absl::StrFormat(
+              "%d,%03d,%03d.%02d", n / 1000000000, (n / 1000000) % 1000,
+              (n / 1000) % 1000, n % 100));
+        }
+        else {
+          numbers.push_back(absl::StrFormat("0.%08d", satoshis(rng)));
+        }
+        break;
+      case ValueMix::kCrypto:
+        numbers.push_back(
+            absl::StrFormat("%s%d.%08d", sign, c % 1000, satoshis(rng)));
+        break;
+      case ValueMix::kLarge:
+        numbers.push_back(
+            absl::StrFormat("%s%d.%08d", sign, large(rng), satoshis(rng)));
+        break;
+    }
+  }
+  return numbers;
+}
+
+std::vector<Decimal> BenchmarkDecimals(ValueMix mix) {
+  std::vector<Decimal> decimals;
+  decimals.reserve(kNumValues);
+  for (const string& n : BenchmarkNumbers(mix)) decimals.emplace_back(n);
+  return decimals;
+}
+
+std::vector<Amount> BenchmarkAmounts(ValueMix mix) {
+  const char* currencies[] = {"USD", "EUR", "BTC", "VANGUARD_500"};
+  std::vector<Decimal> decimals = BenchmarkDecimals(mix);
+  std::vector<Amount> amounts;
+  amounts.reserve(decimals.size());
+  for (size_t i = 0; i < decimals.size(); i++) {
+    amounts.emplace_back(decimals[i], currencies[i / 8 % 4]);
+  }
+  return amounts;
+}
+
+BenchmarkLedger::BenchmarkLedger(size_t bytes) {
+  const char* tmpdir = std::getenv("TMPDIR");
+  filename_ = absl::StrCat(tmpdir != nullptr ? tmpdir : "/tmp",
+                           "/benchmark_ledger.XXXXXX");
+  int fd = mkstemp(&filename_[0]);
+  CHECK(fd >= 0) << "mkstemp " << filename_;
+  FILE* file = fdopen(fd, "w");
+  CHECK(file != nullptr);
+
+  const int kAccounts = 300;
+  const char* const kRoots[] = {"Assets:Bank", "Expenses:Home", "Income:Job",
+                                "Liabilities:Card"};
+  std::vector<string> accounts;
+  string chunk;
+  for (int i = 0; i < kAccounts; i++) {
+    accounts.push_back(absl::StrCat(kRoots[i % 4], ":Account", i));
+    absl::StrAppend(&chunk, "2010-01-01 open ", accounts.back(), " USD\n");
+  }
+  chunk += "2010-01-01 open Assets:Broker HOOL,USD \"FIFO\"\n\n";
+
+  std::vector<string> numbers = BenchmarkNumbers(ValueMix::kCash);
+  const Date first_day = Date::FromCivil(2010, 1, 2);
+  const int kDays = 15 * 365;
+  char date_text[Date::kTextSize];
+  const absl::string_view date(date_text, sizeof(date_text));
+  for (int64 i = 0; size_ + chunk.size() < bytes; i++) {
+    (first_day + static_cast<int32>((size_ + chunk.size()) * kDays / bytes))
+        .Format(date_text);
+    const string& number = numbers[i % kNumValues];
+    const string& account = accounts[i % kAccounts];
+    if (i % 50 == 0) {
+      absl::StrAppend(&chunk, date, " price HOOL ", numbers[i / 50 % 997],
+                      " USD\n\n");
+    }
+    if (i % 100 == 0) {
+      absl::StrAppend(&chunk, date, " balance ", account, " ",
+                      numbers[i / 100 % 991], " USD\n\n");
+    }
+    if (i % 20 == 0) {
+      absl::StrAppend(&chunk, date, " * \"Broker\" \"Buy shares\"\n",
+                      "  Assets:Broker  ", i % 7 + 1, " HOOL {", number,
+                      " USD} @ ", number, " USD\n", "  ", account, "\n\n");
+    }
+    else {
+      absl::StrAppend(&chunk, date, " * \"Payee ", i % 977,
+                      "\" \"Transaction ", i, "\"");
+      if (i % 7 == 0) chunk += " #trip";
+      chunk += "\n";
+      if (i % 10 == 0) absl::StrAppend(&chunk, "  invoice: \"INV-", i, "\"\n");
+      absl::StrAppend(&chunk, "  ", account, "  ", number, " USD\n", "  ",
+                      accounts[(i * 7 + 3) % kAccounts], "\n\n");
+    }
+    if (chunk.size() >= (1 << 20)) {
+      CHECK(fwrite(chunk.data(), 1, chunk.size(), file) == chunk.size());
+      size_ += chunk.size();
+      chunk.clear();
+    }
+  }
+  CHECK(fwrite(chunk.data(), 1, chunk.size(), file) == chunk.size());
+  size_ += chunk.size();
+  CHECK(fclose(file) == 0);
+}
+
+BenchmarkLedger::~BenchmarkLedger() { unlink(filename_.c_str()); }
+
+}  // namespace beanquick
+
+// Counts every allocation of the benchmark binary, see AllocationCounter.
+void* operator new(size_t size) { return beanquick::CountedAlloc(size); }
+void* operator new[](size_t size) { return beanquick::CountedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
@@ -0,0 +1,91 @@
+#ifndef BEANQUICK_BENCHMARK_UTIL_H_
+#define BEANQUICK_BENCHMARK_UTIL_H_
+
+#include <vector>
+
+#include "beanquick/core/amount.h"
+#include "beanquick/core/base.h"
+#include "beanquick/core/decimal.h"
+#include "benchmark/benchmark.h"
+
+// Shared by the *_benchmark.cc binaries, see bean_cc_benchmark() in
+// beanquick/beanquick.bzl and CMake/BeanquickHelper.cmake.
+namespace beanquick {
+
+// Calls to the global operator new since the program started, counted by the
+// replacement operators in benchmark_util.cc.
+int64 AllocationCount();
+
+// Reports the allocations made while it lives as the "allocs/op" counter,
+// averaged over the iterations of `state`. Create it right before the
+// benchmark loop, so that the setup isn't counted.
+class AllocationCounter {
+ public:
+  explicit AllocationCounter(benchmark::State* state)
+      : state_(state), start_(AllocationCount()) {}
+
+  ~AllocationCounter() {
+    state_->counters["allocs/op"] =
+        benchmark::Counter(static_cast<double>(AllocationCount() - start_),
+                           benchmark::Counter::kAvgIterations);
+  }
+
+ private:
+  benchmark::State* state_;
+  int64 start_;
+};
+
+// The shapes of numbers found in ledgers.
+enum class ValueMix {
+  // Cash postings and prices, two decimals.
+  kCash,
+  // Mostly cash, some with thousands separators, some crypto.
+  kLedger,
+  // Eight decimals.
+  kCrypto,
+  // Too many digits for a compact Decimal.
+  kLarge,
+};
+
+constexpr int kNumValueMixes = 4;
+
+// Benchmarks over values do one operation per iteration, cycling through
+// kNumValues of them, so the reported time is the time per operation.
+constexpr int kNumValues = 4096;
+
+// Registers one run per ValueMix, e.g. BENCHMARK(BM_Foo)->Apply(ValueMixes).
+void ValueMixes(benchmark::internal::Benchmark* b);
+
+// The mix a run is for, also sets it as the label of the run.
+ValueMix GetValueMix(benchmark::State* state);
+
+// kNumValues deterministic numbers of `mix`, as text.
+std::vector<string> BenchmarkNumbers(ValueMix mix);
+
+std::vector<Decimal> BenchmarkDecimals(ValueMix mix);
+
+// Amounts of `mix` in a handful of currencies, in runs like in a journal.
+std::vector<Amount> BenchmarkAmounts(ValueMix mix);
+
+// A generated ledger file of about `bytes`, removed with the object: opens,
+// then 15 years of mostly two posting transactions, with some metadata,
+// costs, prices and balances.
+class BenchmarkLedger {
+ public:
+  explicit BenchmarkLedger(size_t bytes);
+  ~BenchmarkLedger();
+
+  BenchmarkLedger(const BenchmarkLedger&) = delete;
+  BenchmarkLedger& operator=(const BenchmarkLedger&) = delete;
+
+  const string& filename() const { return filename_; }
+  size_t size() const { return size_; }
+
+ private:
+  string filename_;
+  size_t size_ = 0;
+};
+
+}  // namespace beanquick
+
+#endif  // BEANQUICK_BENCHMARK_UTIL_H_
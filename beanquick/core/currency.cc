@@ -0,0 +1,99 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "beanquick/core/currency.h"
+
+#include "beanquick/core/logging.h"
+
+namespace beanquick {
+
+namespace {
+inline bool IsUpper(char c) { return c >= 'A' && c <= 'Z'; }
+inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+}  // namespace
+
+bool IsValidCurrency(absl::string_view symbol) {
+  if (symbol.size() < 2 || symbol.size() > 24) return false;
+  if (!IsUpper(symbol.front())) return false;
+  char last = symbol.back();
+  if (!IsUpper(last) && !IsDigit(last)) return false;
+  for (size_t i = 1; i + 1 < symbol.size(); i++) {
+    char c = symbol[i];
+    if (!IsUpper(c) && !IsDigit(c) && c != '\'' && c != '.' && c != '_') {
+      return false;
+    }
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// CurrencyTable Implementation.
+// -----------------------------------------------------------------------------
+CurrencyTable &CurrencyTable::Global() {
+  // Leaked on purpose, Amounts may outlive static destructors.
+  static CurrencyTable *table = new CurrencyTable();
+  return *table;
+}
+
+CurrencyTable::CurrencyTable() : size_(0) {
+  for (auto &chunk : chunks_) chunk.store(nullptr, std::memory_order_relaxed);
+}
+
+CurrencyTable::~CurrencyTable() {
+  for (auto &chunk : chunks_) delete chunk.load(std::memory_order_relaxed);
+}
+
+bool CurrencyTable::Find(absl::string_view symbol, CurrencyId *id) const {
+  absl::ReaderMutexLock lock(&mu_);
+  auto it = ids_.find(symbol);
+  if (it == ids_.end()) return false;
+  *id = it->second;
+  return true;
+}
+
+bool CurrencyTable::Intern(absl::string_view symbol, CurrencyId *id) {
+  if (Find(symbol, id)) return true;
+  if (!IsValidCurrency(symbol)) return false;
+
+  absl::MutexLock lock(&mu_);
+  // Someone else may have added it in between.
+  auto it = ids_.find(symbol);
+  if (it != ids_.end()) {
+    *id = it->second;
+    return true;
+  }
+  int n = size_.load(std::memory_order_relaxed);
+  CHECK_LT(n, kMaxChunks * kChunkSize) << "too many currencies.";
+  Chunk *chunk = chunks_[n >> kChunkBits].load(std::memory_order_relaxed);
+  if (chunk == nullptr) {
+    chunk = new Chunk;
+    chunks_[n >> kChunkBits].store(chunk, std::memory_order_release);
+  }
+  string &name = chunk->names[n & (kChunkSize - 1)];
+  name.assign(symbol.data(), symbol.size());
+  *id = static_cast<CurrencyId>(n);
+  ids_.emplace(name, *id);
+  size_.store(n + 1, std::memory_order_release);
+  return true;
+}
+
+CurrencyId CurrencyTable::InternOrDie(absl::string_view symbol) {
+  CurrencyId id = 0;
+  CHECK(Intern(symbol, &id)) << "invalid currency: " << symbol;
+  return id;
+}
+
+}  // namespace beanquick
@@ -0,0 +1,109 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef DEANQUICK_CURRENCY_H_
+#define DEANQUICK_CURRENCY_H_
+
+#include <atomic>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "beanquick/core/base.h"
+
+namespace beanquick {
+
+// A small integer standing for an interned currency symbol, see
+// CurrencyTable. Ids are dense and handed out in first-seen order, so they
+// say nothing about how two symbols sort.
+typedef uint32 CurrencyId;
+
+// Never handed out by a CurrencyTable, marks a missing currency.
+constexpr CurrencyId kNoCurrency = 0xffffffff;
+
+// Whether `symbol` is a valid beancount currency, i.e. it matches
+// [A-Z][A-Z0-9'._]{0,22}[A-Z0-9].
+bool IsValidCurrency(absl::string_view symbol);
+
+// -----------------------------------------------------------------------------
+// CurrencyTable Definition.
+// -----------------------------------------------------------------------------
+// Process wide symbol table mapping currencies to CurrencyIds and back. A
+// symbol is validated once, the first time it is interned; after that
+// interning it is a hash lookup under a reader lock, and resolving an id back
+// to its name takes no lock at all. Names live as long as the process.
+// Thread safe.
+class CurrencyTable {
+ public:
+  // The table used by Amount.
+  static CurrencyTable &Global();
+
+  CurrencyTable();
+  ~CurrencyTable();
+
+  CurrencyTable(const CurrencyTable &) = delete;
+  CurrencyTable &operator=(const CurrencyTable &) = delete;
+
+  // Returns the id of `symbol`, adding it on first sight. Sets `*id` and
+  // returns false when `symbol` is not a valid currency.
+  bool Intern(absl::string_view symbol, CurrencyId *id);
+
+  // Like Intern(), CHECK-fails on invalid symbols.
+  CurrencyId InternOrDie(absl::string_view symbol);
+
+  // Returns the id of an already interned `symbol` through `id`, false when
+  // it has never been seen.
+  bool Find(absl::string_view symbol, CurrencyId *id) const;
+
+  // The symbol `id` was interned from. `id` must come from this table.
+  const string &Name(CurrencyId id) const {
+    return chunks_[id >> kChunkBits].load(std::memory_order_acquire)
+        ->names[id & (kChunkSize - 1)];
+  }
+
+  // Number of interned currencies.
+  int size() const { return size_.load(std::memory_order_acquire); }
+
+ private:
+  static constexpr int kChunkBits = 8;
+  static constexpr int kChunkSize = 1 << kChunkBits;
+  static constexpr int kMaxChunks = 4096;
+
+  // Names are appended in fixed size chunks which never move, so that Name()
+  // may read them while another thread interns.
+  struct Chunk {
+    string names[kChunkSize];
+  };
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<absl::string_view, CurrencyId> ids_ ABSL_GUARDED_BY(mu_);
+  std::atomic<Chunk *> chunks_[kMaxChunks];
+  std::atomic<int> size_;
+};
+
+// Shorthands for the global table.
+inline CurrencyId InternCurrency(absl::string_view symbol) {
+  return CurrencyTable::Global().InternOrDie(symbol);
+}
+
+inline const string &CurrencyName(CurrencyId id) {
+  return CurrencyTable::Global().Name(id);
+}
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_CURRENCY_H_
@@ -0,0 +1,82 @@
+#include "currency.h"
+
+#include <thread>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace beanquick {
+
+TEST(TestCurrency, IsValid) {
+  EXPECT_TRUE(IsValidCurrency("USD"));
+  EXPECT_TRUE(IsValidCurrency("VANGUARD_500"));
+  EXPECT_TRUE(IsValidCurrency("HOOL.A"));
+  EXPECT_TRUE(IsValidCurrency("NT'D"));
+  EXPECT_TRUE(IsValidCurrency("AB"));
+  EXPECT_TRUE(IsValidCurrency("ABCDEFGHIJKLMNOPQRSTUVWX"));
+
+  EXPECT_FALSE(IsValidCurrency(""));
+  EXPECT_FALSE(IsValidCurrency("A"));
+  EXPECT_FALSE(IsValidCurrency("usd"));
+  EXPECT_FALSE(IsValidCurrency("1USD"));
+  EXPECT_FALSE(IsValidCurrency("USD_"));
+  EXPECT_FALSE(IsValidCurrency("US D"));
+  EXPECT_FALSE(IsValidCurrency("ABCDEFGHIJKLMNOPQRSTUVWXY"));
+}
+
+TEST(TestCurrency, Intern) {
+  CurrencyTable table;
+  CurrencyId usd, eur, again;
+  ASSERT_TRUE(table.Intern("USD", &usd));
+  ASSERT_TRUE(table.Intern("EUR", &eur));
+  ASSERT_TRUE(table.Intern(string("USD"), &again));
+  EXPECT_NE(usd, eur);
+  EXPECT_EQ(usd, again);
+  EXPECT_EQ("USD", table.Name(usd));
+  EXPECT_EQ("EUR", table.Name(eur));
+  EXPECT_EQ(2, table.size());
+
+  CurrencyId id;
+  EXPECT_FALSE(table.Intern("usd", &id));
+  EXPECT_FALSE(table.Find("CAD", &id));
+  EXPECT_TRUE(table.Find("EUR", &id));
+  EXPECT_EQ(eur, id);
+  EXPECT_EQ(2, table.size());
+
+  EXPECT_DEATH({ table.InternOrDie("usd"); }, "invalid currency");
+}
+
+TEST(TestCurrency, ManyChunks) {
+  CurrencyTable table;
+  std::vector<CurrencyId> ids;
+  for (int i = 0; i < 1000; i++) {
+    ids.push_back(table.InternOrDie(absl::StrCat("C", i)));
+  }
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(absl::StrCat("C", i), table.Name(ids[i]));
+  }
+}
+
+TEST(TestCurrency, Concurrent) {
+  CurrencyTable table;
+  constexpr int kThreads = 4;
+  constexpr int kSymbols = 600;
+  std::vector<std::vector<CurrencyId>> ids(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&table, &ids, t] {
+      for (int i = 0; i < kSymbols; i++) {
+        CurrencyId id = table.InternOrDie(absl::StrCat("X", i));
+        // Names of ids handed out by other threads must be readable.
+        EXPECT_EQ(absl::StrCat("X", i), table.Name(id));
+        ids[t].push_back(id);
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  EXPECT_EQ(kSymbols, table.size());
+  for (int t = 1; t < kThreads; t++) EXPECT_EQ(ids[0], ids[t]);
+}
+
+}  // namespace beanquick
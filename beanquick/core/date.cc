@@ -0,0 +1,177 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "beanquick/core/date.h"
+
+#include <string.h>
+
+#include "absl/strings/str_cat.h"
+
+namespace beanquick {
+
+constexpr int Date::kTextSize;
+
+namespace {
+
+// The conversions are those of Neri and Schneider, "Euclidean affine
+// functions and their application to calendar algorithms": unsigned
+// arithmetic on days counted from 0000-03-01, so that February is last and
+// leap days fall at the end of a year. Dates are shifted by kEras cycles of
+// 400 years to keep the counts positive.
+constexpr uint32 kEras = 82;
+constexpr uint32 kYearShift = 400 * kEras;
+constexpr uint32 kDayShift = 719468 + 146097 * kEras;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define BEAN_DATE_SWAR 1
+
+// The year, month and day of eight digits, one byte each, YYYYMMDD in memory
+// order. Returns false if one of the bytes isn't a digit.
+inline bool ParseDigits(uint64 chunk, int *year, int *month, int *day) {
+  if (((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+       (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) !=
+      0x3333333333333333ULL) {
+    return false;
+  }
+  chunk -= 0x3030303030303030ULL;
+  // Pairs of digits, in the low byte of each 16 bits.
+  chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FFULL;
+  *year = static_cast<int>(chunk & 0xFF) * 100 +
+          static_cast<int>((chunk >> 16) & 0xFF);
+  *month = static_cast<int>((chunk >> 32) & 0xFF);
+  *day = static_cast<int>(chunk >> 48);
+  return true;
+}
+
+// The digits of four numbers below 100, each in 16 bits, as eight ASCII
+// characters.
+inline uint64 FormatPairs(uint64 pairs) {
+  // x * 103 >> 10 is x / 10 for x < 179, and doesn't overflow 16 bits.
+  uint64 tens = ((pairs * 103) >> 10) & 0x000F000F000F000FULL;
+  uint64 ones = pairs - tens * 10;
+  return tens | (ones << 8) | 0x3030303030303030ULL;
+}
+#endif
+
+}  // namespace
+
+Date Date::FromCivil(int year, int month, int day) {
+  const uint32 march = month <= 2;
+  const uint32 y = static_cast<uint32>(year) + kYearShift - march;
+  const uint32 m = static_cast<uint32>(month) + 12 * march;
+  const uint32 century = y / 100;
+  const uint32 year_days = 1461 * y / 4 - century + century / 4;
+  const uint32 month_days = (979 * m - 2919) / 32;
+  return Date(static_cast<int32>(year_days + month_days + day - 1 -
+                                 kDayShift));
+}
+
+void Date::ToCivil(int *year, int *month, int *day) const {
+  const uint32 n = static_cast<uint32>(days_) + kDayShift;
+  // The century and the day in it.
+  const uint32 n1 = 4 * n + 3;
+  const uint32 century = n1 / 146097;
+  const uint32 century_day = n1 % 146097 / 4;
+  // The year in the century and the day in the year.
+  const uint64 p2 = 2939745ULL * (4 * century_day + 3);
+  const uint32 y = 100 * century + static_cast<uint32>(p2 >> 32);
+  const uint32 year_day = static_cast<uint32>(p2) / 2939745 / 4;
+  // The month and the day in the month, from March on.
+  const uint32 n3 = 2141 * year_day + 197913;
+  const uint32 m = n3 >> 16;
+  const uint32 jan_feb = year_day >= 306;
+  *year = static_cast<int>(y - kYearShift + jan_feb);
+  *month = static_cast<int>(m - 12 * jan_feb);
+  *day = static_cast<int>((n3 & 0xFFFF) / 2141 + 1);
+}
+
+int Date::year() const {
+  int year, month, day;
+  ToCivil(&year, &month, &day);
+  return year;
+}
+
+bool Date::Parse(absl::string_view text, Date *date) {
+  if (text.size() != kTextSize) return false;
+  const char *p = text.data();
+  if ((p[4] != '-' && p[4] != '/') || p[7] != p[4]) return false;
+  int year, month, day;
+#ifdef BEAN_DATE_SWAR
+  uint64 chunk;
+  uint16 last;
+  memcpy(&chunk, p, sizeof(chunk));
+  memcpy(&last, p + 8, sizeof(last));
+  // YYYY-MM- to YYYYMMDD.
+  chunk = (chunk & 0xFFFFFFFFULL) | ((chunk >> 8) & 0xFFFF00000000ULL) |
+          (static_cast<uint64>(last) << 48);
+  if (!ParseDigits(chunk, &year, &month, &day)) return false;
+#else
+  static const int kDigits[] = {0, 1, 2, 3, 5, 6, 8, 9};
+  int digits[8];
+  for (int i = 0; i < 8; i++) {
+    digits[i] = p[kDigits[i]] - '0';
+    if (digits[i] < 0 || digits[i] > 9) return false;
+  }
+  year = digits[0] * 1000 + digits[1] * 100 + digits[2] * 10 + digits[3];
+  month = digits[4] * 10 + digits[5];
+  day = digits[6] * 10 + digits[7];
+#endif
+  if (year < 1 || !IsValid(year, month, day)) return false;
+  *date = FromCivil(year, month, day);
+  return true;
+}
+
+char *Date::Format(char *out) const {
+  int year, month, day;
+  ToCivil(&year, &month, &day);
+#ifdef BEAN_DATE_SWAR
+  uint64 chars = FormatPairs(
+      static_cast<uint64>(year / 100) | static_cast<uint64>(year % 100) << 16 |
+      static_cast<uint64>(month) << 32 | static_cast<uint64>(day) << 48);
+  memcpy(out, &chars, 4);
+  out[4] = '-';
+  memcpy(out + 5, reinterpret_cast<const char *>(&chars) + 4, 2);
+  out[7] = '-';
+  memcpy(out + 8, reinterpret_cast<const char *>(&chars) + 6, 2);
+#else
+  out[0] = static_cast<char>('0' + year / 1000);
+  out[1] = static_cast<char>('0' + year / 100 % 10);
+  out[2] = static_cast<char>('0' + year / 10 % 10);
+  out[3] = static_cast<char>('0' + year % 10);
+  out[4] = '-';
+  out[5] = static_cast<char>('0' + month / 10);
+  out[6] = static_cast<char>('0' + month % 10);
+  out[7] = '-';
+  out[8] = static_cast<char>('0' + day / 10);
+  out[9] = static_cast<char>('0' + day % 10);
+#endif
+  return out + kTextSize;
+}
+
+string Date::ToString() const {
+  int year, month, day;
+  ToCivil(&year, &month, &day);
+  if (year >= 0 && year <= 9999) {
+    string ret(kTextSize, '\0');
+    Format(&ret[0]);
+    return ret;
+  }
+  return absl::StrCat(year, month < 10 ? "-0" : "-", month,
+                      day < 10 ? "-0" : "-", day);
+}
+
+}  // namespace beanquick
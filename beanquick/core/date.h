@@ -0,0 +1,121 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef DEANQUICK_DATE_H_
+#define DEANQUICK_DATE_H_
+
+#include <iostream>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "beanquick/core/base.h"
+
+namespace beanquick {
+
+// A day of the proleptic Gregorian calendar, held as the number of days
+// since 1970-01-01. Comparing, sorting and hashing dates are those of the
+// int32, and so is taking the days between two of them.
+//
+//   Date date;
+//   if (!Date::Parse("2020-02-29", &date)) ...
+//   date += 1;
+//   char buffer[Date::kTextSize];
+//   date.Format(buffer);  // "2020-03-01"
+//
+class Date {
+ public:
+  // The size of YYYY-MM-DD.
+  static constexpr int kTextSize = 10;
+
+  // 1970-01-01.
+  constexpr Date() : days_(0) {}
+
+  static constexpr Date FromDays(int32 days) { return Date(days); }
+
+  // The date of `year`-`month`-`day`, which must be valid, see IsValid().
+  // Years from -32767 on are supported.
+  static Date FromCivil(int year, int month, int day);
+
+  static bool IsValid(int year, int month, int day) {
+    return month >= 1 && month <= 12 && day >= 1 &&
+           day <= DaysInMonth(year, month);
+  }
+
+  static bool IsLeapYear(int year) {
+    // Multiples of 100 are multiples of 16 when multiples of 400 as well.
+    return (year & (year % 100 == 0 ? 15 : 3)) == 0;
+  }
+
+  static int DaysInMonth(int year, int month) {
+    // 30 or 31 alternate, with the parity flipping after July.
+    return month == 2 ? 28 + IsLeapYear(year) : 30 | (month ^ (month >> 3));
+  }
+
+  // Parses `text` as YYYY-MM-DD or YYYY/MM/DD, from 0001-01-01 to 9999-12-31.
+  // Returns false when it is anything else, e.g. 2020-2-29 or 2021-02-29.
+  static bool Parse(absl::string_view text, Date *date);
+
+  int32 days() const { return days_; }
+
+  void ToCivil(int *year, int *month, int *day) const;
+  int year() const;
+
+  // Writes the kTextSize characters of YYYY-MM-DD to `out` and returns the
+  // end. The year must be within 0 to 9999.
+  char *Format(char *out) const;
+
+  // YYYY-MM-DD, with the year padded or signed as needed outside 0 to 9999.
+  string ToString() const;
+
+  Date &operator+=(int32 days) {
+    days_ += days;
+    return *this;
+  }
+  Date &operator-=(int32 days) {
+    days_ -= days;
+    return *this;
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, Date date) {
+    return H::combine(std::move(h), date.days_);
+  }
+
+ private:
+  explicit constexpr Date(int32 days) : days_(days) {}
+
+  int32 days_;
+};
+
+inline Date operator+(Date date, int32 days) { return date += days; }
+inline Date operator-(Date date, int32 days) { return date -= days; }
+inline int32 operator-(Date lhs, Date rhs) { return lhs.days() - rhs.days(); }
+
+inline bool operator==(Date lhs, Date rhs) { return lhs.days() == rhs.days(); }
+inline bool operator!=(Date lhs, Date rhs) { return lhs.days() != rhs.days(); }
+inline bool operator<(Date lhs, Date rhs) { return lhs.days() < rhs.days(); }
+inline bool operator<=(Date lhs, Date rhs) { return lhs.days() <= rhs.days(); }
+inline bool operator>(Date lhs, Date rhs) { return lhs.days() > rhs.days(); }
+inline bool operator>=(Date lhs, Date rhs) { return lhs.days() >= rhs.days(); }
+
+inline std::ostream &operator<<(std::ostream &os, Date date) {
+  return os << date.ToString();
+}
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_DATE_H_
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "benchmark/benchmark.h"
+#include "date.h"
+
+namespace beanquick {
+namespace {
+
+constexpr int kNumDates = 4096;
+
+// Dates spread over 2000 to 2030.
+std::vector<Date> BenchmarkDates() {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int32> days(
+      Date::FromCivil(2000, 1, 1).days(), Date::FromCivil(2030, 12, 31).days());
+  std::vector<Date> dates;
+  for (int i = 0; i < kNumDates; i++) {
+    dates.push_back(Date::FromDays(days(rng)));
+  }
+  return dates;
+}
+
+std::vector<string> BenchmarkDateTexts() {
+  std::vector<string> texts;
+  for (Date date : BenchmarkDates()) texts.push_back(date.ToString());
+  return texts;
+}
+
+// What the parser used to do: fields of one or two digits, checked one by
+// one, then Hinnant's days_from_civil().
+bool LegacyParse(absl::string_view text, int32 *date) {
+  int year = (text[0] - '0') * 1000 + (text[1] - '0') * 100 +
+             (text[2] - '0') * 10 + (text[3] - '0');
+  size_t second = text.find(text[4], 5);
+  if (second == absl::string_view::npos) return false;
+  int fields[2] = {0, 0};
+  absl::string_view parts[2] = {text.substr(5, second - 5),
+                                text.substr(second + 1)};
+  for (int i = 0; i < 2; i++) {
+    if (parts[i].empty() || parts[i].size() > 2) return false;
+    for (char c : parts[i]) {
+      if (c < '0' || c > '9') return false;
+      fields[i] = fields[i] * 10 + (c - '0');
+    }
+  }
+  int month = fields[0], day = fields[1];
+  if (year < 1 || !Date::IsValid(year, month, day)) return false;
+  year -= month <= 2;
+  const int era = (year >= 0 ? year : year - 399) / 400;
+  const int yoe = year - era * 400;
+  const int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  *date = era * 146097 + doe - 719468;
+  return true;
+}
+
+void BM_LegacyDateParse(benchmark::State& state) {
+  std::vector<string> texts = BenchmarkDateTexts();
+  size_t i = 0;
+  for (auto _ : state) {
+    int32 date = 0;
+    benchmark::DoNotOptimize(LegacyParse(texts[i++ % kNumDates], &date));
+    benchmark::DoNotOptimize(date);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LegacyDateParse);
+
+void BM_DateParse(benchmark::State& state) {
+  std::vector<string> texts = BenchmarkDateTexts();
+  size_t i = 0;
+  for (auto _ : state) {
+    Date date;
+    benchmark::DoNotOptimize(Date::Parse(texts[i++ % kNumDates], &date));
+    benchmark::DoNotOptimize(date);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DateParse);
+
+void BM_DateFormatPrintf(benchmark::State& state) {
+  std::vector<Date> dates = BenchmarkDates();
+  size_t i = 0;
+  char buffer[Date::kTextSize + 1];
+  for (auto _ : state) {
+    int year, month, day;
+    dates[i++ % kNumDates].ToCivil(&year, &month, &day);
+    absl::SNPrintF(buffer, sizeof(buffer), "%04d-%02d-%02d", year, month,
+                   day);
+    benchmark::DoNotOptimize(buffer);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DateFormatPrintf);
+
+void BM_DateFormat(benchmark::State& state) {
+  std::vector<Date> dates = BenchmarkDates();
+  size_t i = 0;
+  char buffer[Date::kTextSize];
+  for (auto _ : state) {
+    dates[i++ % kNumDates].Format(buffer);
+    benchmark::DoNotOptimize(buffer);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DateFormat);
+
+void BM_DateToCivil(benchmark::State& state) {
+  std::vector<Date> dates = BenchmarkDates();
+  size_t i = 0;
+  for (auto _ : state) {
+    int year, month, day;
+    dates[i++ % kNumDates].ToCivil(&year, &month, &day);
+    benchmark::DoNotOptimize(year);
+    benchmark::DoNotOptimize(month);
+    benchmark::DoNotOptimize(day);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DateToCivil);
+
+// Sorting dates is sorting int32.
+void BM_DateSort(benchmark::State& state) {
+  std::vector<Date> dates = BenchmarkDates();
+  for (auto _ : state) {
+    std::vector<Date> sorted = dates;
+    std::sort(sorted.begin(), sorted.end());
+    benchmark::DoNotOptimize(sorted.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumDates);
+}
+BENCHMARK(BM_DateSort);
+
+}  // namespace
+}  // namespace beanquick
@@ -0,0 +1,139 @@
+#include "date.h"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "absl/hash/hash_testing.h"
+#include "gtest/gtest.h"
+
+namespace beanquick {
+namespace {
+
+TEST(TestDate, Civil) {
+  EXPECT_EQ(0, Date::FromCivil(1970, 1, 1).days());
+  EXPECT_EQ(-1, Date::FromCivil(1969, 12, 31).days());
+  EXPECT_EQ(18321, Date::FromCivil(2020, 2, 29).days());
+  EXPECT_EQ(-719162, Date::FromCivil(1, 1, 1).days());
+  EXPECT_EQ(2932896, Date::FromCivil(9999, 12, 31).days());
+
+  // Every day from year -32767 to 40000, one after the other.
+  int32 days = Date::FromCivil(-32767, 1, 1).days();
+  for (int year = -32767; year <= 40000; year++) {
+    for (int month = 1; month <= 12; month++) {
+      for (int day = 1; day <= Date::DaysInMonth(year, month); day++) {
+        Date date = Date::FromCivil(year, month, day);
+        ASSERT_EQ(days, date.days()) << year << "-" << month << "-" << day;
+        int y, m, d;
+        date.ToCivil(&y, &m, &d);
+        ASSERT_EQ(year, y);
+        ASSERT_EQ(month, m);
+        ASSERT_EQ(day, d);
+        days++;
+      }
+    }
+  }
+}
+
+TEST(TestDate, LeapYears) {
+  EXPECT_TRUE(Date::IsLeapYear(2000));
+  EXPECT_TRUE(Date::IsLeapYear(2020));
+  EXPECT_TRUE(Date::IsLeapYear(0));
+  EXPECT_TRUE(Date::IsLeapYear(-4));
+  EXPECT_FALSE(Date::IsLeapYear(1900));
+  EXPECT_FALSE(Date::IsLeapYear(2021));
+  EXPECT_FALSE(Date::IsLeapYear(-100));
+
+  const int kDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  for (int month = 1; month <= 12; month++) {
+    EXPECT_EQ(kDays[month - 1], Date::DaysInMonth(2021, month));
+  }
+  EXPECT_EQ(29, Date::DaysInMonth(2020, 2));
+  EXPECT_TRUE(Date::IsValid(2020, 2, 29));
+  EXPECT_FALSE(Date::IsValid(2021, 2, 29));
+  EXPECT_FALSE(Date::IsValid(2021, 4, 31));
+  EXPECT_FALSE(Date::IsValid(2021, 0, 1));
+  EXPECT_FALSE(Date::IsValid(2021, 13, 1));
+  EXPECT_FALSE(Date::IsValid(2021, 1, 0));
+}
+
+TEST(TestDate, Parse) {
+  Date date;
+  ASSERT_TRUE(Date::Parse("2020-02-29", &date));
+  EXPECT_EQ(Date::FromCivil(2020, 2, 29), date);
+  ASSERT_TRUE(Date::Parse("2020/03/01", &date));
+  EXPECT_EQ(Date::FromCivil(2020, 3, 1), date);
+  ASSERT_TRUE(Date::Parse("0001-01-01", &date));
+  EXPECT_EQ(-719162, date.days());
+  ASSERT_TRUE(Date::Parse("9999-12-31", &date));
+  EXPECT_EQ(2932896, date.days());
+
+  for (const char *text :
+       {"2021-02-29", "2020-04-31", "2020-13-01", "2020-00-10", "2020-01-00",
+        "2020-01-32", "0000-01-01", "2020-1-1", "2020-01-1", "2020-01/01",
+        "2020:01:01", "202a-01-01", "2020-0b-01", "2020-01-0 ", "2020-01-01 ",
+        "", "2020-01"}) {
+    date = Date::FromDays(7);
+    EXPECT_FALSE(Date::Parse(text, &date)) << text;
+    EXPECT_EQ(7, date.days()) << text;
+  }
+
+  // Only the ten bytes of the view are read.
+  const char text[] = "2020-01-019";
+  ASSERT_TRUE(Date::Parse(absl::string_view(text, 10), &date));
+  EXPECT_EQ(Date::FromCivil(2020, 1, 1), date);
+}
+
+TEST(TestDate, Format) {
+  char buffer[Date::kTextSize + 2] = "xxxxxxxxxx!";
+  EXPECT_EQ(buffer + Date::kTextSize,
+            Date::FromCivil(2020, 2, 29).Format(buffer));
+  EXPECT_EQ("2020-02-29!", string(buffer));
+  EXPECT_EQ("1970-01-01", Date().ToString());
+  EXPECT_EQ("0001-01-01", Date::FromCivil(1, 1, 1).ToString());
+  EXPECT_EQ("9999-12-31", Date::FromCivil(9999, 12, 31).ToString());
+  EXPECT_EQ("12345-06-07", Date::FromCivil(12345, 6, 7).ToString());
+  EXPECT_EQ("-5-03-01", Date::FromCivil(-5, 3, 1).ToString());
+
+  std::ostringstream oss;
+  oss << Date::FromCivil(2021, 12, 5);
+  EXPECT_EQ("2021-12-05", oss.str());
+
+  // Formatting what was parsed gives it back, over all the years parsed.
+  for (Date date = Date::FromCivil(1, 1, 1);
+       date <= Date::FromCivil(9999, 12, 31); date += 1) {
+    date.Format(buffer);
+    Date back;
+    ASSERT_TRUE(Date::Parse(absl::string_view(buffer, Date::kTextSize), &back))
+        << date.days();
+    ASSERT_EQ(date, back);
+  }
+}
+
+TEST(TestDate, Arithmetic) {
+  Date date = Date::FromCivil(2020, 2, 28);
+  EXPECT_EQ(Date::FromCivil(2020, 2, 29), date + 1);
+  EXPECT_EQ(Date::FromCivil(2020, 3, 1), date + 2);
+  EXPECT_EQ(Date::FromCivil(2019, 2, 28), date - 365);
+  EXPECT_EQ(366, Date::FromCivil(2021, 1, 1) - Date::FromCivil(2020, 1, 1));
+  EXPECT_EQ(2020, date.year());
+
+  std::vector<Date> dates = {Date::FromCivil(2021, 1, 1),
+                             Date::FromCivil(1969, 12, 31), Date(),
+                             Date::FromCivil(2020, 12, 31)};
+  std::sort(dates.begin(), dates.end());
+  EXPECT_EQ("1969-12-31", dates[0].ToString());
+  EXPECT_EQ("1970-01-01", dates[1].ToString());
+  EXPECT_EQ("2020-12-31", dates[2].ToString());
+  EXPECT_EQ("2021-01-01", dates[3].ToString());
+  EXPECT_TRUE(std::binary_search(dates.begin(), dates.end(), Date()));
+  EXPECT_LT(dates[0], dates[1]);
+  EXPECT_GE(dates[3], dates[2]);
+  EXPECT_NE(dates[0], dates[1]);
+
+  EXPECT_TRUE(absl::VerifyTypeImplementsAbslHashCorrectly(
+      {Date(), Date::FromDays(-1), Date::FromDays(1), dates[3]}));
+}
+
+}  // namespace
+}  // namespace beanquick
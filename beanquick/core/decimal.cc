@@ -0,0 +1,541 @@
+#include "beanquick/core/decimal.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "absl/strings/str_cat.h"
+
+namespace beanquick {
+namespace {
+
+// Integer parts with more significant digits than this can't be represented.
+constexpr int kMaxIntegerDigits = 19;
+
+inline bool IsDigit(char c) { return static_cast<unsigned char>(c - '0') < 10; }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define BEAN_DECIMAL_SWAR 1
+
+inline uint64 LoadEight(const char *p) {
+  uint64 chunk;
+  memcpy(&chunk, p, sizeof(chunk));
+  return chunk;
+}
+
+// True if all eight bytes of `chunk` are ASCII digits.
+inline bool AllEightDigits(uint64 chunk) {
+  return (((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+           (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+          0x3333333333333333ULL);
+}
+
+// Converts eight ASCII digits to their value with three multiplications,
+// the first digit in memory being the most significant one.
+inline uint64 ParseEightDigits(uint64 chunk) {
+  const uint64 mask = 0x000000FF000000FFULL;
+  const uint64 mul1 = 0x000F424000000064ULL;  // 100 + (1000000ULL << 32)
+  const uint64 mul2 = 0x0000271000000001ULL;  // 1 + (10000ULL << 32)
+  chunk -= 0x3030303030303030ULL;
+  chunk = (chunk * 10) + (chunk >> 8);
+  chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+  return chunk;
+}
+#endif
+
+// Consumes a run of digits starting at `p`, accumulating them into `value`.
+// Returns the position right after the run.
+inline const char *ScanDigits(const char *p, const char *end, uint64 *value) {
+  uint64 v = *value;
+#ifdef BEAN_DECIMAL_SWAR
+  while (end - p >= 8) {
+    uint64 chunk = LoadEight(p);
+    if (!AllEightDigits(chunk)) break;
+    v = v * 100000000ULL + ParseEightDigits(chunk);
+    p += 8;
+  }
+#endif
+  while (p < end && IsDigit(*p)) {
+    v = v * 10 + (*p - '0');
+    ++p;
+  }
+  *value = v;
+  return p;
+}
+
+// "00" to "99", so two digits can be written per division.
+constexpr char kDigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536"
+    "37383940414243444546474849505152535455565758596061626364656667686970717273"
+    "7475767778798081828384858687888990919293949596979899";
+
+// "000" to "999", so the groups of FormatGroupedTo() take one division each.
+struct DigitTriples {
+  constexpr DigitTriples() : chars() {
+    for (int i = 0; i < 1000; i++) {
+      chars[3 * i] = static_cast<char>('0' + i / 100);
+      chars[3 * i + 1] = static_cast<char>('0' + i / 10 % 10);
+      chars[3 * i + 2] = static_cast<char>('0' + i % 10);
+    }
+  }
+  char chars[3000];
+};
+constexpr DigitTriples kDigitTriples;
+
+// Integer parts never exceed MAX_INTEGER_VALUE, so 19 digits at most.
+inline int CountDigits(uint64 value) {
+  int count = 1;
+  while (count < 19 && value >= static_cast<uint64>(internal::kPow10[count])) {
+    count++;
+  }
+  return count;
+}
+
+// Writes exactly `width` digits of `value`, zero padded, ending at `end`.
+inline void WriteDigitsBackward(uint64 value, char *end, int width) {
+  while (width >= 2) {
+    end -= 2;
+    memcpy(end, kDigitPairs + 2 * (value % 100), 2);
+    value /= 100;
+    width -= 2;
+  }
+  if (width) *--end = static_cast<char>('0' + value % 10);
+}
+
+// Writes `value` with `separator` between groups of three digits, ending at
+// `end`, and returns where it starts.
+inline char *WriteGroupedBackward(uint64 value, char *end, char separator) {
+  while (value >= 1000) {
+    end -= 3;
+    memcpy(end, kDigitTriples.chars + 3 * (value % 1000), 3);
+    *--end = separator;
+    value /= 1000;
+  }
+  if (value >= 100) {
+    end -= 3;
+    memcpy(end, kDigitTriples.chars + 3 * value, 3);
+  }
+  else if (value >= 10) {
+    end -= 2;
+    memcpy(end, kDigitPairs + 2 * value, 2);
+  }
+  else {
+    *--end = static_cast<char>('0' + value);
+  }
+  return end;
+}
+
+}  // namespace
+
+constexpr int Decimal::kMaxScale;
+constexpr int Decimal::kMaxFormattedSize;
+constexpr int Decimal::kMaxGroupedSize;
+
+absl::Status Decimal::Parse(absl::string_view str, Decimal *out) {
+  const char *p = str.data();
+  const char *end = p + str.size();
+  if (p == end) {
+    return absl::InvalidArgumentError("Decimal::Parse: empty string");
+  }
+
+  bool has_sign = false;
+  Base::Sign sign = Base::Sign::POSITIVE;
+  if (*p == '+' || *p == '-') {
+    has_sign = true;
+    if (*p == '-') sign = Base::Sign::NEGATIVE;
+    ++p;
+  }
+  if (p == end || !IsDigit(*p)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Decimal::Parse: no digits in '", str, "'"));
+  }
+
+  // Integer part, leading zeros don't count against the representable range
+  // but do count as written digits, matching what gets displayed.
+  while (p + 1 < end && *p == '0' && IsDigit(p[1])) ++p;
+  int integer_count = static_cast<int>(p - str.data()) - (has_sign ? 1 : 0);
+  int significant = 0;
+  uint64 integer_value = 0;
+  while (true) {
+    const char *run = p;
+    p = ScanDigits(p, end, &integer_value);
+    significant += static_cast<int>(p - run);
+    if (significant > kMaxIntegerDigits) {
+      return absl::OutOfRangeError(absl::StrCat(
+          "Decimal::Parse: integer part too large in '", str, "'"));
+    }
+    // A thousands separator must sit between two digits.
+    if (p + 1 < end && *p == ',' && IsDigit(p[1])) {
+      ++p;
+      continue;
+    }
+    break;
+  }
+  integer_count += significant;
+  if (integer_value > Base::MAX_INTEGER_VALUE) {
+    return absl::OutOfRangeError(
+        absl::StrCat("Decimal::Parse: integer part too large in '", str, "'"));
+  }
+
+  int frac_count = 0;
+  uint64 frac_value = 0;
+  if (p < end && *p == '.') {
+    ++p;
+    const char *frac = p;
+    if (end - frac > static_cast<int>(Base::MAX_DECIMAL_PLACES)) {
+      // Only scan what fits, anything left over is reported below.
+      p = ScanDigits(p, frac + Base::MAX_DECIMAL_PLACES, &frac_value);
+      if (p < end && IsDigit(*p)) {
+        return absl::OutOfRangeError(absl::StrCat(
+            "Decimal::Parse: too many fractional digits in '", str, "'"));
+      }
+    }
+    else {
+      p = ScanDigits(p, end, &frac_value);
+    }
+    frac_count = static_cast<int>(p - frac);
+    if (frac_count == 0) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Decimal::Parse: missing fractional digits in '", str, "'"));
+    }
+  }
+
+  if (p != end) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Decimal::Parse: unexpected character '", absl::string_view(p, 1),
+        "' in '", str, "'"));
+  }
+
+  // Everything was validated above, so this can't throw.
+  unsigned __int128 mantissa =
+      static_cast<unsigned __int128>(integer_value) *
+          internal::kPow10[frac_count] +
+      frac_value;
+  if (mantissa <= static_cast<uint64>(std::numeric_limits<int64>::max())) {
+    int64 m = static_cast<int64>(mantissa);
+    out->SetCompact(sign == Base::Sign::NEGATIVE ? -m : m, frac_count);
+  }
+  else {
+    out->SetNumber(Base(integer_value, frac_value, frac_count, sign));
+  }
+  if (has_sign) out->flags_ |= kHasSign;
+  out->integer_count_ = static_cast<uint8>(std::min(integer_count, 255));
+  return absl::OkStatus();
+}
+
+Decimal::Decimal(const Base &number) : Decimal() { SetNumber(number); }
+
+int Decimal::Integer() const {
+  if (integer_count_ != 0) return integer_count_;
+  uint64 integer = IsBoxed() ? number_->integerValue()
+                             : static_cast<uint64>(std::abs(mantissa_)) /
+                                   internal::kPow10[scale_];
+  int count = 1;
+  while (integer >= 10) {
+    integer /= 10;
+    count++;
+  }
+  return count;
+}
+
+char *Decimal::SplitForFormat(char *buf, uint64 *integer,
+                              uint64 *fraction) const {
+  if (IsBoxed()) {
+    *integer = number_->integerValue();
+    *fraction = number_->fractionalValue();
+    if (number_->isNegative()) *buf++ = '-';
+    return buf;
+  }
+  uint64 magnitude = static_cast<uint64>(std::abs(mantissa_));
+  if (mantissa_ < 0) *buf++ = '-';
+  if (scale_ == 0) {
+    *integer = magnitude;
+    *fraction = 0;
+  }
+  else {
+    *integer = magnitude / internal::kPow10[scale_];
+    *fraction = magnitude % internal::kPow10[scale_];
+  }
+  return buf;
+}
+
+char *Decimal::FormatTo(char *buf) const {
+  uint64 integer;
+  uint64 fraction;
+  buf = SplitForFormat(buf, &integer, &fraction);
+  int digits = CountDigits(integer);
+  WriteDigitsBackward(integer, buf + digits, digits);
+  buf += digits;
+  if (scale_ > 0) {
+    *buf++ = '.';
+    WriteDigitsBackward(fraction, buf + scale_, scale_);
+    buf += scale_;
+  }
+  return buf;
+}
+
+char *Decimal::FormatGroupedTo(char *buf, char separator) const {
+  uint64 integer;
+  uint64 fraction;
+  buf = SplitForFormat(buf, &integer, &fraction);
+  int digits = CountDigits(integer);
+  buf += digits + (digits - 1) / 3;
+  WriteGroupedBackward(integer, buf, separator);
+  if (scale_ > 0) {
+    *buf++ = '.';
+    WriteDigitsBackward(fraction, buf + scale_, scale_);
+    buf += scale_;
+  }
+  return buf;
+}
+
+Decimal::Base Decimal::ToNumber() const {
+  if (IsBoxed()) return *number_;
+  uint64 magnitude = static_cast<uint64>(std::abs(mantissa_));
+  uint64 pow = internal::kPow10[scale_];
+  return Base(magnitude / pow, magnitude % pow, scale_,
+              mantissa_ < 0 ? Base::Sign::NEGATIVE : Base::Sign::POSITIVE);
+}
+
+void Decimal::SetNumber(const Base &number) {
+  int scale = number.decimalPlaces();
+  unsigned __int128 magnitude =
+      static_cast<unsigned __int128>(number.integerValue()) *
+          internal::kPow10[scale] +
+      number.fractionalValue();
+  if (magnitude <= static_cast<uint64>(std::numeric_limits<int64>::max())) {
+    int64 m = static_cast<int64>(magnitude);
+    SetCompact(number.isNegative() ? -m : m, scale);
+    return;
+  }
+  if (IsBoxed()) {
+    *number_ = number;
+  }
+  else {
+    number_ = new Base(number);
+  }
+  scale_ = static_cast<uint8>(scale);
+  flags_ = kBoxed | (number.isNegative() ? kHasSign : 0);
+  integer_count_ = 0;
+}
+
+void Decimal::AddSlow(const Decimal &rhs) {
+  Base number = ToNumber();
+  number += rhs.ToNumber();
+  SetNumber(number);
+}
+
+void Decimal::SubSlow(const Decimal &rhs) {
+  Base number = ToNumber();
+  number -= rhs.ToNumber();
+  SetNumber(number);
+}
+
+void Decimal::MulSlow(const Decimal &rhs) {
+  Base number = ToNumber();
+  number *= rhs.ToNumber();
+  SetNumber(number);
+}
+
+Decimal &Decimal::Quantize(int scale, Rounding::Mode mode) {
+  assert(scale >= 0 && scale <= kMaxScale);
+  if (scale == scale_) return *this;
+  const bool has_sign = HasSign();
+  if (!IsBoxed()) {
+    int64 mantissa;
+    if (scale < scale_) {
+      // Number::decreaseDecimalPlaces64() in a single step.
+      const int64_t pow = internal::kPow10[scale_ - scale];
+      const int64_t rounded = Rounding::round<int64_t>(
+          mode, mantissa_ / pow, std::abs(mantissa_ % pow), pow / 2,
+          mantissa_ < 0);
+      SetCompact(rounded, scale);
+      if (has_sign) flags_ |= kHasSign;
+      return *this;
+    }
+    if (!__builtin_mul_overflow(mantissa_, internal::kPow10[scale - scale_],
+                                &mantissa) &&
+        mantissa != std::numeric_limits<int64>::min()) {
+      SetCompact(mantissa, scale);
+      if (has_sign) flags_ |= kHasSign;
+      return *this;
+    }
+  }
+  Base number = ToNumber();
+  number.setRoundingMode(mode);
+  number.setDecimalPlaces(scale);
+  SetNumber(number);
+  if (has_sign) flags_ |= kHasSign;
+  return *this;
+}
+
+absl::Status Decimal::CheckedSlow(Op op, const Decimal &rhs) {
+  if (op == Op::kDiv && rhs.IsZero()) {
+    return absl::InvalidArgumentError("Decimal: division by zero");
+  }
+  try {
+    Base number = ToNumber();
+    switch (op) {
+      case Op::kAdd:
+        number += rhs.ToNumber();
+        break;
+      case Op::kSub:
+        number -= rhs.ToNumber();
+        break;
+      case Op::kMul:
+        number *= rhs.ToNumber();
+        break;
+      case Op::kDiv:
+        number /= rhs.ToNumber();
+        break;
+    }
+    SetNumber(number);
+  } catch (const ::fixed::OverflowException &e) {
+    return absl::OutOfRangeError(e.what());
+  }
+  return absl::OkStatus();
+}
+
+void Decimal::ThrowBadValue(const absl::Status &status) {
+  throw ::fixed::BadValueException(string(status.message()));
+}
+
+void Decimal::ThrowOverflow(const char *message) {
+  throw ::fixed::OverflowException(message);
+}
+
+Decimal &Decimal::operator/=(const Decimal &rhs) {
+  Base number = ToNumber();
+  number /= rhs.ToNumber();
+  SetNumber(number);
+  return *this;
+}
+
+Decimal &Decimal::operator%=(const Decimal &rhs) {
+  Base number = ToNumber();
+  number %= rhs.ToNumber();
+  SetNumber(number);
+  return *this;
+}
+
+__int128 Decimal::WideSlow() const {
+  __int128 magnitude = static_cast<__int128>(number_->integerValue()) *
+                            internal::kPow10[scale_] +
+                        number_->fractionalValue();
+  return number_->isNegative() ? -magnitude : magnitude;
+}
+
+Decimal Decimal::FromWide(__int128 mantissa, int scale) {
+  Decimal ret;
+  if (mantissa > std::numeric_limits<int64>::min() &&
+      mantissa <= std::numeric_limits<int64>::max()) {
+    ret.SetCompact(static_cast<int64>(mantissa), scale);
+    return ret;
+  }
+  unsigned __int128 magnitude =
+      mantissa < 0 ? -static_cast<unsigned __int128>(mantissa) : mantissa;
+  unsigned __int128 integer = magnitude / internal::kPow10[scale];
+  if (integer > Base::MAX_INTEGER_VALUE) {
+    ThrowOverflow("Decimal: integer part too large");
+  }
+  Base::Sign sign =
+      mantissa < 0 ? Base::Sign::NEGATIVE : Base::Sign::POSITIVE;
+  ret.SetNumber(Base(static_cast<uint64>(integer),
+                     static_cast<uint64>(magnitude % internal::kPow10[scale]),
+                     scale, sign));
+  return ret;
+}
+
+bool Decimal::SumSameScale(const Decimal *values, size_t count,
+                           __int128 *sum) {
+  // Each mantissa is biased to unsigned and split into 32-bit halves, summed
+  // in separate 64-bit lanes, which takes nothing but 64-bit adds and logical
+  // shifts. Blocks of at most 2^32 values keep the lanes from wrapping. The
+  // scales are checked along the way, saving a second pass over the values.
+  const uint64 kBias = uint64{1} << 63;
+  const size_t kBlock = size_t{1} << 32;
+  const uint8 scale = values[0].scale_;
+  __int128 total = 0;
+  while (count > 0) {
+    size_t n = std::min(count, kBlock);
+    size_t i = 0;
+    uint64 hi = 0;
+    uint64 lo = 0;
+    uint64 mismatch = 0;
+#ifdef __SSE2__
+    // Two values per iteration, one 128-bit load each: the low halves hold
+    // the mantissas, the high halves the scale and flags bytes.
+    static_assert(offsetof(Decimal, scale_) == 8 &&
+                      offsetof(Decimal, flags_) == 9,
+                  "SumSameScale expects scale and flags in the second word");
+    const __m128i bias = _mm_set1_epi64x(kBias);
+    const __m128i low32 = _mm_set1_epi64x(0xFFFFFFFFLL);
+    const __m128i meta_mask = _mm_set1_epi64x(0xFF | (kBoxed << 8));
+    const __m128i meta_want = _mm_set1_epi64x(scale);
+    __m128i vhi = _mm_setzero_si128();
+    __m128i vlo = _mm_setzero_si128();
+    __m128i vbad = _mm_setzero_si128();
+    for (; i + 2 <= n; i += 2) {
+      const __m128i *p = reinterpret_cast<const __m128i *>(values + i);
+      __m128i a = _mm_loadu_si128(p);
+      __m128i b = _mm_loadu_si128(p + 1);
+      __m128i u = _mm_xor_si128(_mm_unpacklo_epi64(a, b), bias);
+      __m128i meta = _mm_and_si128(_mm_unpackhi_epi64(a, b), meta_mask);
+      vhi = _mm_add_epi64(vhi, _mm_srli_epi64(u, 32));
+      vlo = _mm_add_epi64(vlo, _mm_and_si128(u, low32));
+      vbad = _mm_or_si128(vbad, _mm_xor_si128(meta, meta_want));
+    }
+    uint64 lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), vhi);
+    hi = lanes[0] + lanes[1];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), vlo);
+    lo = lanes[0] + lanes[1];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), vbad);
+    mismatch = lanes[0] | lanes[1];
+#endif
+    for (; i < n; i++) {
+      uint64 u = static_cast<uint64>(values[i].mantissa_) ^ kBias;
+      hi += u >> 32;
+      lo += u & 0xFFFFFFFFULL;
+      mismatch |= (values[i].scale_ ^ scale) | (values[i].flags_ & kBoxed);
+    }
+    if (mismatch) return false;
+    total += (static_cast<__int128>(hi) << 32) + lo -
+             static_cast<__int128>(n) * kBias;
+    values += n;
+    count -= n;
+  }
+  *sum = total;
+  return true;
+}
+
+void DecimalAccumulator::Rescale(int scale) {
+  if (__builtin_mul_overflow(sum_, internal::kPow10[scale - scale_], &sum_)) {
+    Decimal::ThrowOverflow("DecimalAccumulator: sum overflow");
+  }
+  scale_ = scale;
+}
+
+Decimal SumDecimals(absl::Span<const Decimal> values) {
+  if (values.empty()) return Decimal();
+  __int128 sum;
+  if (Decimal::SumSameScale(values.data(), values.size(), &sum)) {
+    return Decimal::FromWide(sum, values[0].scale_);
+  }
+  DecimalAccumulator accumulator;
+  for (const Decimal &value : values) accumulator.Add(value);
+  return accumulator.Total();
+}
+
+int Decimal::CompareSlow(const Decimal &lhs, const Decimal &rhs) {
+  Base a = lhs.ToNumber();
+  Base b = rhs.ToNumber();
+  return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+}  // namespace beanquick
@@ -3,69 +3,552 @@
 
 #include <cassert>
 #include <iostream>
+#include <limits>
 #include <string>
+#include <utility>
 
-#include "absl/strings/str_replace.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "beanquick/core/base.h"
 #include "third_party/fixed/include/Number.h"
 
 namespace beanquick {
-class Decimal : public ::fixed::Number {
+namespace internal {
+// Powers of ten up to 10^18, the largest one an int64 can hold.
+constexpr int64 kPow10[19] = {1LL,
+                              10LL,
+                              100LL,
+                              1000LL,
+                              10000LL,
+                              100000LL,
+                              1000000LL,
+                              10000000LL,
+                              100000000LL,
+                              1000000000LL,
+                              10000000000LL,
+                              100000000000LL,
+                              1000000000000LL,
+                              10000000000000LL,
+                              100000000000000LL,
+                              1000000000000000LL,
+                              10000000000000000LL,
+                              100000000000000000LL,
+                              1000000000000000000LL};
+}  // namespace internal
+
+using Rounding = ::fixed::Rounding;
+
+// A decimal number stored as a scaled int64 mantissa and a one byte scale,
+// i.e. the value is mantissa / 10^scale. That covers nearly every number of
+// a real ledger in 16 bytes. Values that don't fit (e.g. a huge integer part
+// with many decimals) are promoted to a heap allocated fixed::Number, and
+// demoted back as soon as a result fits again.
+//
+// Arithmetic follows fixed::Number with its default policies: sums keep the
+// largest scale of the operands, products and quotients keep up to
+// kMaxScale decimals, rounding half to even.
+class Decimal {
  public:
   using Base = ::fixed::Number;
 
-  Decimal() : Base() {}
+  // The maximum number of fractional digits, same as fixed::Number.
+  static constexpr int kMaxScale = Base::MAX_DECIMAL_PLACES;
 
-  // TODO(zq7): add string validation and checks.
-  Decimal(const string &str) : Base(helper(str)) {
-    string tmp = helper(str);
-    if (tmp[0] == '+' || tmp[0] == '-') {
-      has_sign_ = true;
-    }
-    else {
-      has_sign_ = false;
-    }
+  Decimal() : mantissa_(0), scale_(0), flags_(0), integer_count_(0) {}
 
-    std::size_t pos = tmp.find('.');
-    int one = (has_sign_ ? 1 : 0);
-    if (pos != std::string::npos) {
-      integer_count_ = pos - one;
-      frac_count_ = tmp.size() - (pos + 1);
-    }
-    else {
-      integer_count_ = tmp.size() - one;
-      frac_count_ = 0;
-    }
+  // Throws fixed::BadValueException if the string is not a valid number,
+  // use Decimal::Parse() to get a status instead.
+  Decimal(const string &str) : Decimal() {
+    absl::Status status = Parse(str, this);
+    if (!status.ok()) ThrowBadValue(status);
+  }
+
+  explicit Decimal(const Base &number);
+
+  Decimal(const Decimal &from);
+  Decimal(Decimal &&from) noexcept;
+  Decimal &operator=(const Decimal &from);
+  Decimal &operator=(Decimal &&from) noexcept;
+
+  ~Decimal() {
+    if (IsBoxed()) delete number_;
   }
 
-  string helper(const string &str) {
-    string tmp = str;
-    tmp = absl::StrReplaceAll(tmp, {{",", ""}});
-    return tmp;
+  // Parses a number like "-1,234.5678" into `out` in a single pass, without
+  // copying the input. Thousands separators are allowed between the digits
+  // of the integer part. On error `out` is left untouched.
+  static absl::Status Parse(absl::string_view str, Decimal *out);
+
+  // Whether the number was written with an explicit sign, or is negative.
+  bool HasSign() const { return flags_ & kHasSign; }
+
+  int Fractional() const { return scale_; }
+
+  int Integer() const;
+
+  bool IsNegative() const {
+    return IsBoxed() ? number_->isNegative() : mantissa_ < 0;
+  }
+
+  bool IsZero() const { return IsBoxed() ? number_->isZero() : mantissa_ == 0; }
+
+  // Whether the value lives in the inline mantissa, rather than being
+  // promoted to a fixed::Number.
+  bool IsCompact() const { return !IsBoxed(); }
+
+  Decimal &Negate();
+
+  // Rounds or pads this value to `scale` decimals, in [0, kMaxScale], the way
+  // fixed::Number::setDecimalPlaces() does with `mode`. Only falls back to
+  // fixed::Number when the padded value doesn't fit the mantissa.
+  Decimal &Quantize(int scale, Rounding::Mode mode);
+
+  // Converts to a fixed::Number, for the operations Decimal doesn't have.
+  Base ToNumber() const;
+
+  // The longest output of FormatTo(): a sign, 19 integer digits, the point
+  // and kMaxScale decimals.
+  static constexpr int kMaxFormattedSize = 1 + 19 + 1 + kMaxScale;
+
+  // Writes the same text as ToString() to `buf`, which must have room for
+  // kMaxFormattedSize chars, and returns the end of it. Neither allocates nor
+  // NUL terminates, like std::to_chars.
+  char *FormatTo(char *buf) const;
+
+  // The longest output of FormatGroupedTo(), six separators more.
+  static constexpr int kMaxGroupedSize = kMaxFormattedSize + 6;
+
+  // Like FormatTo(), with `separator` between groups of three integer digits,
+  // e.g. "-1,234,567.89". `buf` must have room for kMaxGroupedSize chars.
+  char *FormatGroupedTo(char *buf, char separator = ',') const;
+
+  string ToString() const {
+    char buf[kMaxFormattedSize];
+    return string(buf, FormatTo(buf));
   }
 
-  bool HasSign() const { return has_sign_; }
+  // Same as ToString(), kept from when Decimal was a fixed::Number.
+  string toString() const { return ToString(); }
 
-  int Fractional() const { return frac_count_; }
+  Decimal &operator+=(const Decimal &rhs);
+  Decimal &operator-=(const Decimal &rhs);
+  Decimal &operator*=(const Decimal &rhs);
+  // Can throw fixed::DivideByZeroException.
+  Decimal &operator/=(const Decimal &rhs);
+  Decimal &operator%=(const Decimal &rhs);
 
-  int Integer() const { return integer_count_; }
+  // *this += value * factor, without a temporary for the product when all
+  // three are compact, e.g. accumulating price * quantity.
+  Decimal &AddScaled(const Decimal &value, const Decimal &factor);
 
-  string ToString() const { return toString(); }
+  // Versions of the operators above that don't throw: the result replaces
+  // this value and OkStatus is returned, or this value is left untouched and
+  // an OutOfRange status is returned on overflow, InvalidArgument when
+  // dividing by zero.
+  absl::Status CheckedAdd(const Decimal &rhs);
+  absl::Status CheckedSub(const Decimal &rhs);
+  absl::Status CheckedMul(const Decimal &rhs);
+  absl::Status CheckedDiv(const Decimal &rhs);
 
   friend Decimal operator-(const Decimal &from);
+  friend Decimal SumDecimals(absl::Span<const Decimal> values);
+  friend class DecimalAccumulator;
+
+  // Hashes the value with trailing zeros stripped, so that equal Decimals
+  // like 1.5 and 1.50 hash alike. Doesn't allocate, also for boxed values.
+  template <typename H>
+  friend H AbslHashValue(H h, const Decimal &value) {
+    int scale;
+    __int128 mantissa = value.Normalized(&scale);
+    return H::combine(std::move(h), static_cast<uint64>(mantissa),
+                      static_cast<uint64>(mantissa >> 64), scale);
+  }
+
+  friend bool operator==(const Decimal &lhs, const Decimal &rhs);
+  friend bool operator<(const Decimal &lhs, const Decimal &rhs);
 
  private:
-  bool has_sign_;
-  int integer_count_;
-  int frac_count_;
+  enum Flags : uint8 {
+    // number_ is set instead of mantissa_.
+    kBoxed = 1,
+    kHasSign = 2,
+  };
+
+  bool IsBoxed() const { return flags_ & kBoxed; }
+
+  void SetCompact(int64 mantissa, int scale) {
+    if (IsBoxed()) delete number_;
+    mantissa_ = mantissa;
+    scale_ = static_cast<uint8>(scale);
+    flags_ = mantissa < 0 ? kHasSign : 0;
+    integer_count_ = 0;
+  }
+
+  // Stores `number` either inline or boxed, whichever it needs.
+  void SetNumber(const Base &number);
+
+  // Brings both mantissas to the larger scale, false on overflow.
+  static bool Align(const Decimal &lhs, const Decimal &rhs, int64 *a, int64 *b,
+                    int *scale);
+
+  // The inline paths, false when the operands or the result aren't compact.
+  bool AddFast(const Decimal &rhs);
+  bool SubFast(const Decimal &rhs);
+  bool MulFast(const Decimal &rhs);
+
+  // The general paths, through fixed::Number.
+  void AddSlow(const Decimal &rhs);
+  void SubSlow(const Decimal &rhs);
+  void MulSlow(const Decimal &rhs);
+
+  enum class Op { kAdd, kSub, kMul, kDiv };
+  absl::Status CheckedSlow(Op op, const Decimal &rhs);
+
+  // Out of line, so that this header builds with -fno-exceptions.
+  [[noreturn]] static void ThrowBadValue(const absl::Status &status);
+  [[noreturn]] static void ThrowOverflow(const char *message);
+
+  // The magnitude as integer and fractional digits, writes the sign to `buf`
+  // and returns past it.
+  char *SplitForFormat(char *buf, uint64 *integer, uint64 *fraction) const;
+
+  static int Compare(const Decimal &lhs, const Decimal &rhs);
+  static int CompareSlow(const Decimal &lhs, const Decimal &rhs);
+
+  // The value as Wide() without trailing zeros, and its scale.
+  __int128 Normalized(int *scale) const;
+
+  // The value scaled by 10^scale_, which always fits 128 bits.
+  __int128 Wide() const { return IsBoxed() ? WideSlow() : mantissa_; }
+  __int128 WideSlow() const;
+
+  // The inverse of Wide(), throws fixed::OverflowException when the integer
+  // part doesn't fit.
+  static Decimal FromWide(__int128 mantissa, int scale);
+
+  // Sums the mantissas of `count` values into `sum` if they are all compact
+  // and have the same scale, returns false otherwise.
+  static bool SumSameScale(const Decimal *values, size_t count,
+                           __int128 *sum);
+
+  union {
+    int64 mantissa_;
+    Base *number_;
+  };
+  uint8 scale_;
+  uint8 flags_;
+  // Integer digits as written when parsed, 0 when it has to be derived.
+  uint8 integer_count_;
+};
+
+static_assert(sizeof(Decimal) == 16, "Decimal should stay two words");
+
+// Sums Decimals exactly in 128 bits, at the largest scale seen so far, so
+// there is no alignment or overflow handling per value as with a chain of
+// operator+=. Only Total() can fail, when the sum doesn't fit a Decimal.
+class DecimalAccumulator {
+ public:
+  void Add(const Decimal &value);
+
+  // Can throw fixed::OverflowException.
+  Decimal Total() const { return Decimal::FromWide(sum_, scale_); }
+
+ private:
+  void Rescale(int scale);
+
+  __int128 sum_ = 0;
+  int scale_ = 0;
 };
 
+// Sums all `values`, same as a chain of operator+= but faster: when all the
+// scales agree the mantissas are summed with a vectorizable kernel, else
+// each value is rescaled once into a DecimalAccumulator. Can throw
+// fixed::OverflowException.
+Decimal SumDecimals(absl::Span<const Decimal> values);
+
+inline Decimal::Decimal(const Decimal &from)
+    : mantissa_(from.mantissa_),
+      scale_(from.scale_),
+      flags_(from.flags_),
+      integer_count_(from.integer_count_) {
+  if (from.IsBoxed()) number_ = new Base(*from.number_);
+}
+
+inline Decimal::Decimal(Decimal &&from) noexcept
+    : mantissa_(from.mantissa_),
+      scale_(from.scale_),
+      flags_(from.flags_),
+      integer_count_(from.integer_count_) {
+  from.flags_ = 0;
+  from.mantissa_ = 0;
+}
+
+inline Decimal &Decimal::operator=(const Decimal &from) {
+  if (this == &from) return *this;
+  if (from.IsBoxed()) {
+    SetNumber(*from.number_);
+  }
+  else {
+    if (IsBoxed()) delete number_;
+    mantissa_ = from.mantissa_;
+  }
+  scale_ = from.scale_;
+  flags_ = from.flags_;
+  integer_count_ = from.integer_count_;
+  return *this;
+}
+
+inline Decimal &Decimal::operator=(Decimal &&from) noexcept {
+  if (this == &from) return *this;
+  if (IsBoxed()) delete number_;
+  mantissa_ = from.mantissa_;
+  scale_ = from.scale_;
+  flags_ = from.flags_;
+  integer_count_ = from.integer_count_;
+  from.flags_ = 0;
+  from.mantissa_ = 0;
+  return *this;
+}
+
+inline bool Decimal::Align(const Decimal &lhs, const Decimal &rhs, int64 *a,
+                           int64 *b, int *scale) {
+  *a = lhs.mantissa_;
+  *b = rhs.mantissa_;
+  if (lhs.scale_ == rhs.scale_) {
+    *scale = lhs.scale_;
+    return true;
+  }
+  if (lhs.scale_ < rhs.scale_) {
+    *scale = rhs.scale_;
+    return !__builtin_mul_overflow(
+        *a, internal::kPow10[rhs.scale_ - lhs.scale_], a);
+  }
+  *scale = lhs.scale_;
+  return !__builtin_mul_overflow(*b, internal::kPow10[lhs.scale_ - rhs.scale_],
+                                 b);
+}
+
+inline bool Decimal::AddFast(const Decimal &rhs) {
+  int64 a, b, sum;
+  int scale;
+  if (!IsBoxed() && !rhs.IsBoxed() && Align(*this, rhs, &a, &b, &scale) &&
+      !__builtin_add_overflow(a, b, &sum) &&
+      sum != std::numeric_limits<int64>::min()) {
+    SetCompact(sum, scale);
+    return true;
+  }
+  return false;
+}
+
+inline bool Decimal::SubFast(const Decimal &rhs) {
+  int64 a, b, diff;
+  int scale;
+  if (!IsBoxed() && !rhs.IsBoxed() && Align(*this, rhs, &a, &b, &scale) &&
+      !__builtin_sub_overflow(a, b, &diff) &&
+      diff != std::numeric_limits<int64>::min()) {
+    SetCompact(diff, scale);
+    return true;
+  }
+  return false;
+}
+
+inline bool Decimal::MulFast(const Decimal &rhs) {
+  int64 product;
+  int scale = scale_ + rhs.scale_;
+  // Products with more than kMaxScale decimals need rounding, leave those to
+  // fixed::Number.
+  if (!IsBoxed() && !rhs.IsBoxed() && scale <= kMaxScale &&
+      !__builtin_mul_overflow(mantissa_, rhs.mantissa_, &product) &&
+      product != std::numeric_limits<int64>::min()) {
+    SetCompact(product, scale);
+    return true;
+  }
+  return false;
+}
+
+inline Decimal &Decimal::operator+=(const Decimal &rhs) {
+  if (!AddFast(rhs)) AddSlow(rhs);
+  return *this;
+}
+
+inline __int128 Decimal::Normalized(int *scale) const {
+  int s = scale_;
+  if (!IsBoxed()) {
+    int64 mantissa = mantissa_;
+    if (mantissa == 0) s = 0;
+    while (s > 0 && mantissa % 10 == 0) {
+      mantissa /= 10;
+      s--;
+    }
+    *scale = s;
+    return mantissa;
+  }
+  __int128 mantissa = WideSlow();
+  if (mantissa == 0) s = 0;
+  while (s > 0 && mantissa % 10 == 0) {
+    mantissa /= 10;
+    s--;
+  }
+  *scale = s;
+  return mantissa;
+}
+
+inline Decimal &Decimal::AddScaled(const Decimal &value,
+                                   const Decimal &factor) {
+  if (!IsBoxed() && !value.IsBoxed() && !factor.IsBoxed()) {
+    Decimal product;
+    product.SetCompact(value.mantissa_, value.scale_);
+    if (product.MulFast(factor) && AddFast(product)) return *this;
+  }
+  Decimal product(value);
+  product *= factor;
+  return *this += product;
+}
+
+inline Decimal &Decimal::operator-=(const Decimal &rhs) {
+  if (!SubFast(rhs)) SubSlow(rhs);
+  return *this;
+}
+
+inline Decimal &Decimal::operator*=(const Decimal &rhs) {
+  if (!MulFast(rhs)) MulSlow(rhs);
+  return *this;
+}
+
+inline absl::Status Decimal::CheckedAdd(const Decimal &rhs) {
+  return AddFast(rhs) ? absl::OkStatus() : CheckedSlow(Op::kAdd, rhs);
+}
+
+inline absl::Status Decimal::CheckedSub(const Decimal &rhs) {
+  return SubFast(rhs) ? absl::OkStatus() : CheckedSlow(Op::kSub, rhs);
+}
+
+inline absl::Status Decimal::CheckedMul(const Decimal &rhs) {
+  return MulFast(rhs) ? absl::OkStatus() : CheckedSlow(Op::kMul, rhs);
+}
+
+inline absl::Status Decimal::CheckedDiv(const Decimal &rhs) {
+  return CheckedSlow(Op::kDiv, rhs);
+}
+
+inline Decimal &Decimal::Negate() {
+  if (IsBoxed()) {
+    number_->negate();
+  }
+  else {
+    mantissa_ = -mantissa_;
+  }
+  flags_ = IsNegative() ? (flags_ | kHasSign) : (flags_ & ~kHasSign);
+  return *this;
+}
+
+inline int Decimal::Compare(const Decimal &lhs, const Decimal &rhs) {
+  if (lhs.IsBoxed() || rhs.IsBoxed()) return CompareSlow(lhs, rhs);
+  // Rescaling to a common scale can't overflow 128 bits.
+  __int128 a = lhs.mantissa_;
+  __int128 b = rhs.mantissa_;
+  if (lhs.scale_ < rhs.scale_) {
+    a *= internal::kPow10[rhs.scale_ - lhs.scale_];
+  }
+  else if (lhs.scale_ > rhs.scale_) {
+    b *= internal::kPow10[lhs.scale_ - rhs.scale_];
+  }
+  return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+inline void DecimalAccumulator::Add(const Decimal &value) {
+  __int128 mantissa = value.Wide();
+  if (value.scale_ < scale_) {
+    // Can't overflow, |mantissa| < 2^63 * 10^kMaxScale.
+    mantissa *= internal::kPow10[scale_ - value.scale_];
+  }
+  else if (value.scale_ > scale_) {
+    Rescale(value.scale_);
+  }
+  // The sum would be way beyond what a Decimal holds anyway.
+  if (__builtin_add_overflow(sum_, mantissa, &sum_)) {
+    Decimal::ThrowOverflow("DecimalAccumulator: sum overflow");
+  }
+}
+
 inline Decimal operator-(const Decimal &from) {
   Decimal ret = from;
-  ret.negate();
+  ret.Negate();
   return ret;
 }
 
+inline const Decimal operator+(const Decimal &lhs, const Decimal &rhs) {
+  return Decimal(lhs) += rhs;
+}
+
+inline const Decimal operator-(const Decimal &lhs, const Decimal &rhs) {
+  return Decimal(lhs) -= rhs;
+}
+
+inline const Decimal operator*(const Decimal &lhs, const Decimal &rhs) {
+  return Decimal(lhs) *= rhs;
+}
+
+inline const Decimal operator/(const Decimal &lhs, const Decimal &rhs) {
+  return Decimal(lhs) /= rhs;
+}
+
+inline const Decimal operator%(const Decimal &lhs, const Decimal &rhs) {
+  return Decimal(lhs) %= rhs;
+}
+
+inline bool operator==(const Decimal &lhs, const Decimal &rhs) {
+  return Decimal::Compare(lhs, rhs) == 0;
+}
+
+inline bool operator!=(const Decimal &lhs, const Decimal &rhs) {
+  return !(lhs == rhs);
+}
+
+inline bool operator<(const Decimal &lhs, const Decimal &rhs) {
+  return Decimal::Compare(lhs, rhs) < 0;
+}
+
+inline bool operator>(const Decimal &lhs, const Decimal &rhs) {
+  return rhs < lhs;
+}
+
+inline bool operator<=(const Decimal &lhs, const Decimal &rhs) {
+  return !(rhs < lhs);
+}
+
+inline bool operator>=(const Decimal &lhs, const Decimal &rhs) {
+  return !(lhs < rhs);
+}
+
+inline std::ostream &operator<<(std::ostream &os, const Decimal &decimal) {
+  char buf[Decimal::kMaxFormattedSize];
+  return os.write(buf, decimal.FormatTo(buf) - buf);
+}
+
+namespace internal {
+struct DecimalBuffer {
+  explicit DecimalBuffer(const Decimal &decimal)
+      : length(decimal.FormatTo(chars) - chars) {}
+
+  char chars[Decimal::kMaxFormattedSize];
+  size_t length;
+};
+}  // namespace internal
+
+// Formats a Decimal on the stack for absl::StrCat() and friends, e.g.
+// absl::StrAppend(&out, DecimalAlphaNum(number), " ", currency), which saves
+// the string ToString() would allocate. Like absl::AlphaNum it must not
+// outlive the expression it is created in.
+class DecimalAlphaNum : private internal::DecimalBuffer, public absl::AlphaNum {
+ public:
+  explicit DecimalAlphaNum(const Decimal &decimal)
+      : internal::DecimalBuffer(decimal),
+        absl::AlphaNum(absl::string_view(chars, length)) {}
+};
+
 }  // namespace beanquick
 
 #endif  // BEANQUICK_DECIMAL_H_
@@ -0,0 +1,270 @@
+#include <random>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_replace.h"
+#include "beanquick/core/benchmark_util.h"
+#include "benchmark/benchmark.h"
+#include "decimal.h"
+
+namespace beanquick {
+namespace {
+
+// What Decimal(const string&) used to do: strip the separators from a copy
+// of the input twice, then let fixed::Number parse the result.
+void BM_LegacyConstructor(benchmark::State& state) {
+  std::vector<string> numbers = BenchmarkNumbers(GetValueMix(&state));
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    const string& n = numbers[i++ % kNumValues];
+    ::fixed::Number number(absl::StrReplaceAll(n, {{",", ""}}));
+    string tmp = absl::StrReplaceAll(n, {{",", ""}});
+    benchmark::DoNotOptimize(number);
+    benchmark::DoNotOptimize(tmp);
+  }
+}
+BENCHMARK(BM_LegacyConstructor)->Apply(ValueMixes);
+
+void BM_DecimalConstructor(benchmark::State& state) {
+  std::vector<string> numbers = BenchmarkNumbers(GetValueMix(&state));
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    Decimal d(numbers[i++ % kNumValues]);
+    benchmark::DoNotOptimize(d);
+  }
+}
+BENCHMARK(BM_DecimalConstructor)->Apply(ValueMixes);
+
+void BM_DecimalParse(benchmark::State& state) {
+  std::vector<string> numbers = BenchmarkNumbers(GetValueMix(&state));
+  Decimal d;
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Decimal::Parse(numbers[i++ % kNumValues], &d));
+  }
+}
+BENCHMARK(BM_DecimalParse)->Apply(ValueMixes);
+
+// Long digit runs, where the eight digits at a time scanner kicks in.
+void BM_DecimalParseLong(benchmark::State& state) {
+  std::vector<string> numbers = {
+      "9223372036854775807.12345678901234", "-1234567890123.12345678",
+      "12345678901234567.1234", "0.12345678901234"};
+  Decimal d;
+  for (auto _ : state) {
+    for (auto& n : numbers) {
+      benchmark::DoNotOptimize(Decimal::Parse(n, &d));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * numbers.size());
+}
+BENCHMARK(BM_DecimalParseLong);
+
+// Prices and ratios to multiply or divide the values of a mix by, between
+// 0.5 and 2 so that no result overflows.
+std::vector<Decimal> Rates() {
+  std::mt19937 rng(20200202);
+  std::uniform_int_distribution<int> rate(5000, 20000);
+  std::vector<Decimal> rates;
+  for (int i = 0; i < kNumValues; i++) {
+    int r = rate(rng);
+    rates.emplace_back(absl::StrFormat("%d.%04d", r / 10000, r % 10000));
+  }
+  return rates;
+}
+
+void BM_DecimalAdd(benchmark::State& state) {
+  std::vector<Decimal> decimals = BenchmarkDecimals(GetValueMix(&state));
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(decimals[i % kNumValues] +
+                             decimals[(i + 1) % kNumValues]);
+    i++;
+  }
+}
+BENCHMARK(BM_DecimalAdd)->Apply(ValueMixes);
+
+void BM_DecimalMul(benchmark::State& state) {
+  std::vector<Decimal> decimals = BenchmarkDecimals(GetValueMix(&state));
+  std::vector<Decimal> rates = Rates();
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(decimals[i % kNumValues] * rates[i % kNumValues]);
+    i++;
+  }
+}
+BENCHMARK(BM_DecimalMul)->Apply(ValueMixes);
+
+void BM_DecimalDiv(benchmark::State& state) {
+  std::vector<Decimal> decimals = BenchmarkDecimals(GetValueMix(&state));
+  std::vector<Decimal> rates = Rates();
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(decimals[i % kNumValues] / rates[i % kNumValues]);
+    i++;
+  }
+}
+BENCHMARK(BM_DecimalDiv)->Apply(ValueMixes);
+
+// What ToString() used to be, an ostringstream in fixed::Number.
+void BM_NumberToString(benchmark::State& state) {
+  std::vector<::fixed::Number> numbers;
+  for (auto& d : BenchmarkDecimals(GetValueMix(&state))) {
+    numbers.push_back(d.ToNumber());
+  }
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(numbers[i++ % kNumValues].toString());
+  }
+}
+BENCHMARK(BM_NumberToString)->Apply(ValueMixes);
+
+void BM_DecimalToString(benchmark::State& state) {
+  std::vector<Decimal> decimals = BenchmarkDecimals(GetValueMix(&state));
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(decimals[i++ % kNumValues].ToString());
+  }
+}
+BENCHMARK(BM_DecimalToString)->Apply(ValueMixes);
+
+void BM_DecimalFormatTo(benchmark::State& state) {
+  std::vector<Decimal> decimals = BenchmarkDecimals(GetValueMix(&state));
+  char buf[Decimal::kMaxFormattedSize];
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(decimals[i++ % kNumValues].FormatTo(buf));
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_DecimalFormatTo)->Apply(ValueMixes);
+
+// Rounding to two decimals through fixed::Number, what Quantize() replaces.
+void BM_NumberSetDecimalPlaces(benchmark::State& state) {
+  std::vector<Decimal> decimals = BenchmarkDecimals(ValueMix::kLedger);
+  for (auto _ : state) {
+    for (auto& d : decimals) {
+      ::fixed::Number number = d.ToNumber();
+      number.setDecimalPlaces(2);
+      benchmark::DoNotOptimize(Decimal(number));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * decimals.size());
+}
+BENCHMARK(BM_NumberSetDecimalPlaces);
+
+void BM_DecimalQuantize(benchmark::State& state) {
+  std::vector<Decimal> decimals = BenchmarkDecimals(ValueMix::kLedger);
+  for (auto _ : state) {
+    for (auto& d : decimals) {
+      Decimal q = d;
+      benchmark::DoNotOptimize(
+          q.Quantize(2, Rounding::Mode::TO_NEAREST_HALF_TO_EVEN));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * decimals.size());
+}
+BENCHMARK(BM_DecimalQuantize);
+
+// The layout Decimal had when it derived from fixed::Number.
+struct LegacyDecimal : public ::fixed::Number {
+  using ::fixed::Number::Number;
+  bool has_sign_ = false;
+  int integer_count_ = 1;
+  int frac_count_ = 0;
+};
+
+constexpr int kPostings = 1000000;
+
+// Memory taken by the numbers of one million postings, and the time of a scan
+// for the largest one, which is dominated by how much of it stays in cache.
+void BM_LegacyFootprint(benchmark::State& state) {
+  std::vector<string> numbers = BenchmarkNumbers(ValueMix::kLedger);
+  std::vector<LegacyDecimal> postings;
+  postings.reserve(kPostings);
+  for (int i = 0; i < kPostings; i++) {
+    postings.emplace_back(
+        absl::StrReplaceAll(numbers[i % numbers.size()], {{",", ""}}));
+  }
+  for (auto _ : state) {
+    const ::fixed::Number* max = &postings[0];
+    for (auto& p : postings) {
+      if (*max < p) max = &p;
+    }
+    benchmark::DoNotOptimize(max);
+  }
+  state.SetItemsProcessed(state.iterations() * postings.size());
+  state.counters["bytes_per_posting"] = sizeof(LegacyDecimal);
+  state.counters["total_mb"] = sizeof(LegacyDecimal) * kPostings / 1e6;
+}
+BENCHMARK(BM_LegacyFootprint)->Unit(benchmark::kMillisecond);
+
+void BM_DecimalFootprint(benchmark::State& state) {
+  std::vector<string> numbers = BenchmarkNumbers(ValueMix::kLedger);
+  std::vector<Decimal> postings;
+  postings.reserve(kPostings);
+  int boxed = 0;
+  for (int i = 0; i < kPostings; i++) {
+    postings.emplace_back(numbers[i % numbers.size()]);
+    if (!postings.back().IsCompact()) boxed++;
+  }
+  for (auto _ : state) {
+    const Decimal* max = &postings[0];
+    for (auto& p : postings) {
+      if (*max < p) max = &p;
+    }
+    benchmark::DoNotOptimize(max);
+  }
+  state.SetItemsProcessed(state.iterations() * postings.size());
+  state.counters["bytes_per_posting"] = sizeof(Decimal);
+  state.counters["total_mb"] = sizeof(Decimal) * kPostings / 1e6;
+  state.counters["boxed"] = boxed;
+}
+BENCHMARK(BM_DecimalFootprint)->Unit(benchmark::kMillisecond);
+
+// Postings of one currency, `mixed_scales` says whether they all have the same
+// number of decimals.
+std::vector<Decimal> Postings(bool mixed_scales) {
+  std::vector<string> numbers = BenchmarkNumbers(ValueMix::kLedger);
+  std::vector<Decimal> postings;
+  postings.reserve(kPostings);
+  for (int i = 0; i < kPostings; i++) {
+    Decimal d(numbers[i % numbers.size()]);
+    if (!mixed_scales && d.Fractional() != 2) continue;
+    postings.push_back(d);
+  }
+  return postings;
+}
+
+void BM_SumChained(benchmark::State& state) {
+  std::vector<Decimal> postings = Postings(state.range(0));
+  for (auto _ : state) {
+    Decimal sum;
+    for (auto& p : postings) sum += p;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * postings.size());
+}
+BENCHMARK(BM_SumChained)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+void BM_SumDecimals(benchmark::State& state) {
+  std::vector<Decimal> postings = Postings(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(SumDecimals(postings));
+  }
+  state.SetItemsProcessed(state.iterations() * postings.size());
+}
+BENCHMARK(BM_SumDecimals)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace beanquick
@@ -1,5 +1,10 @@
 #include "decimal.h"
 
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "absl/hash/hash_testing.h"
 #include "gtest/gtest.h"
 
 namespace beanquick {
@@ -61,6 +66,329 @@ TEST(TestDecimal, Operation) {
   EXPECT_EQ(d2 * d3, D("4.02"));
 }
 
+TEST(TestDecimal, Parse) {
+  Decimal d;
+  EXPECT_TRUE(Decimal::Parse("1.238", &d).ok());
+  EXPECT_EQ(d, D("1.238"));
+  EXPECT_FALSE(d.HasSign());
+  EXPECT_EQ(d.Integer(), 1);
+  EXPECT_EQ(d.Fractional(), 3);
+
+  // Thousands separators are skipped.
+  EXPECT_TRUE(Decimal::Parse("-1,234,567.125", &d).ok());
+  EXPECT_EQ(d, D("-1234567.125"));
+  EXPECT_TRUE(d.HasSign());
+  EXPECT_EQ(d.Integer(), 7);
+  EXPECT_EQ(d.Fractional(), 3);
+
+  // Long digit runs.
+  EXPECT_TRUE(Decimal::Parse("+9223372036854775807.12345678901234", &d).ok());
+  EXPECT_EQ(d.ToString(), "9223372036854775807.12345678901234");
+  EXPECT_EQ(d.Integer(), 19);
+  EXPECT_EQ(d.Fractional(), 14);
+
+  EXPECT_TRUE(Decimal::Parse("00012345678.000000001", &d).ok());
+  EXPECT_EQ(d.ToString(), "12345678.000000001");
+  EXPECT_EQ(d.Integer(), 11);
+}
+
+TEST(TestDecimal, ParseErrors) {
+  Decimal d("42");
+  EXPECT_EQ(Decimal::Parse("", &d).code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(Decimal::Parse("-", &d).code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(Decimal::Parse("1.", &d).code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(Decimal::Parse(".5", &d).code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(Decimal::Parse(",100", &d).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(Decimal::Parse("100,", &d).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(Decimal::Parse("1.2.3", &d).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(Decimal::Parse("12 USD", &d).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(Decimal::Parse("9223372036854775808", &d).code(),
+            absl::StatusCode::kOutOfRange);
+  EXPECT_EQ(Decimal::Parse("0.123456789012345", &d).code(),
+            absl::StatusCode::kOutOfRange);
+  // Failed parses leave the value untouched.
+  EXPECT_EQ(d, D("42"));
+
+  EXPECT_THROW(D("1.2.3"), ::fixed::BadValueException);
+}
+
+TEST(TestDecimal, Compact) {
+  EXPECT_EQ(sizeof(Decimal), 16);
+  EXPECT_TRUE(D("1234.56").IsCompact());
+  EXPECT_TRUE(D("-0.00000001").IsCompact());
+
+  // Too large for an int64 mantissa, promoted to a fixed::Number.
+  Decimal big("92233720368547758.12345678");
+  EXPECT_FALSE(big.IsCompact());
+  EXPECT_EQ(big.Fractional(), 8);
+
+  // Copies and arithmetic on promoted values.
+  Decimal copy = big;
+  EXPECT_FALSE(copy.IsCompact());
+  EXPECT_EQ(copy, big);
+  Decimal sum = big + D("1");
+  EXPECT_GT(sum, big);
+  EXPECT_EQ(sum - big, D("1"));
+  // And back to compact once the result fits again.
+  EXPECT_TRUE((sum - big).IsCompact());
+
+  // Overflowing the mantissa promotes instead of wrapping.
+  Decimal max("9223372036854775807");
+  EXPECT_TRUE(max.IsCompact());
+  EXPECT_EQ((max + D("0.5")).ToString(), "9223372036854775807.5");
+  EXPECT_FALSE((max + D("0.5")).IsCompact());
+
+  EXPECT_EQ((-D("3")).ToString(), "-3");
+  EXPECT_TRUE((-D("3")).HasSign());
+}
+
+#define BINARY_OP(name, op)                     \
+  struct name {                                 \
+    template <typename T>                       \
+    T operator()(const T &x, const T &y) const { \
+      return x op y;                            \
+    }                                           \
+  }
+BINARY_OP(Add, +);
+BINARY_OP(Sub, -);
+BINARY_OP(Mul, *);
+BINARY_OP(Div, /);
+#undef BINARY_OP
+
+// Runs `op` on both a Decimal and a fixed::Number pair, expecting the same
+// result or the same overflow.
+template <typename Op>
+void ExpectSameAsNumber(const char *a, const char *b, Op op) {
+  string expected;
+  try {
+    expected = op(::fixed::Number(a), ::fixed::Number(b)).toString();
+  } catch (const ::fixed::OverflowException &) {
+    EXPECT_THROW(op(Decimal(a), Decimal(b)), ::fixed::OverflowException)
+        << a << " " << b;
+    return;
+  }
+  EXPECT_EQ(op(Decimal(a), Decimal(b)).ToString(), expected) << a << " " << b;
+}
+
+// The compact paths must give the same results as fixed::Number.
+TEST(TestDecimal, MatchesNumber) {
+  const char *values[] = {"0",          "1",
+                          "-1",         "0.5",
+                          "-2.25",      "123456.789",
+                          "0.00000001", "-99999999.99999999",
+                          "3.14159265", "92233720368547.75807",
+                          "7",          "-0.0000000000001"};
+  for (const char *a : values) {
+    for (const char *b : values) {
+      ExpectSameAsNumber(a, b, Add());
+      ExpectSameAsNumber(a, b, Sub());
+      ExpectSameAsNumber(a, b, Mul());
+      if (!::fixed::Number(b).isZero()) ExpectSameAsNumber(a, b, Div());
+      EXPECT_EQ(D(a) < D(b), ::fixed::Number(a) < ::fixed::Number(b));
+      EXPECT_EQ(D(a) == D(b), ::fixed::Number(a) == ::fixed::Number(b));
+    }
+  }
+}
+
+TEST(TestDecimal, AddScaled) {
+  const char *values[] = {"0",        "1.5",   "-2.25",       "123456.789",
+                          "0.000001", "-7",    "922337",      "0.1234567"};
+  for (const char *acc : values) {
+    for (const char *a : values) {
+      for (const char *b : values) {
+        D expected = D(acc) + D(a) * D(b);
+        D sum(acc);
+        sum.AddScaled(D(a), D(b));
+        EXPECT_EQ(expected, sum) << acc << " + " << a << " * " << b;
+        EXPECT_EQ(expected.ToString(), sum.ToString());
+      }
+    }
+  }
+  // Overflowing the compact paths falls back to fixed::Number.
+  D sum("1");
+  sum.AddScaled(D("92233720368547"), D("1000.12345"));
+  EXPECT_EQ(D("92245106621326498.12715"), sum);
+}
+
+TEST(TestDecimal, FormatGroupedTo) {
+  auto grouped = [](const char *s) {
+    char buf[D::kMaxGroupedSize];
+    return string(buf, D(s).FormatGroupedTo(buf));
+  };
+  EXPECT_EQ("0", grouped("0"));
+  EXPECT_EQ("999", grouped("999"));
+  EXPECT_EQ("1,000", grouped("1000"));
+  EXPECT_EQ("-12,345.670", grouped("-12345.670"));
+  EXPECT_EQ("100,000,000.00000001", grouped("100000000.00000001"));
+  EXPECT_EQ("123,456,789,012,345,678.12345678",
+            grouped("123456789012345678.12345678"));
+  char buf[D::kMaxGroupedSize];
+  EXPECT_EQ("1 000 000", string(buf, D("1000000").FormatGroupedTo(buf, ' ')));
+
+  // Against grouping the output of FormatTo().
+  std::mt19937_64 rng(7);
+  for (int i = 0; i < 10000; i++) {
+    string digits = std::to_string(rng() >> (4 + rng() % 60));
+    size_t scale = std::min<size_t>(rng() % 9, digits.size() - 1);
+    if (scale > 0) digits.insert(digits.size() - scale, ".");
+    D value((i % 2 ? "-" : "") + digits);
+    string plain = value.ToString();
+    size_t begin = plain[0] == '-' ? 1 : 0;
+    size_t point = std::min(plain.find('.'), plain.size());
+    for (size_t at = point; at > begin + 3; at -= 3) plain.insert(at - 3, ",");
+    EXPECT_EQ(plain, grouped(value.ToString().c_str()));
+  }
+}
+
+TEST(TestDecimal, Hash) {
+  EXPECT_TRUE(absl::VerifyTypeImplementsAbslHashCorrectly({
+      D("0"), D("0.00"), D("-0.0"), D("1"), D("1.0"), D("1.50"), D("1.5"),
+      D("-1.5"), D("15"), D("0.15"), D("123456789.123456789"),
+      D("123456789.1234567890"), D("99999999999999999.99999999"),
+      D("99999999999999999.999999990"), D("-99999999999999999.99999999")}));
+  // Equal values hash alike, whether compact or boxed.
+  absl::Hash<Decimal> hash;
+  EXPECT_EQ(hash(D("1.5")), hash(D("1.500000")));
+  EXPECT_EQ(hash(D("0")), hash(D("-0.000")));
+  D boxed("99999999999999999.99999999");
+  ASSERT_FALSE(boxed.IsCompact());
+  D compact = boxed - D("99999999999999999");
+  ASSERT_TRUE(compact.IsCompact());
+  EXPECT_EQ(hash(D("0.99999999")), hash(compact));
+  EXPECT_NE(hash(D("1.5")), hash(D("15")));
+}
+
+TEST(TestDecimal, SumDecimals) {
+  EXPECT_EQ(SumDecimals({}), D("0"));
+
+  // One scale, the vectorized path.
+  std::vector<Decimal> same = {D("1.25"), D("-3.50"), D("100.00"), D("0.01")};
+  EXPECT_EQ(SumDecimals(same).ToString(), "97.76");
+
+  // Mixed scales end up at the largest one, like operator+ does.
+  std::vector<Decimal> mixed = {D("1"), D("0.00000001"), D("-2.5"), D("7.25")};
+  Decimal chained;
+  for (const Decimal &d : mixed) chained += d;
+  EXPECT_EQ(SumDecimals(mixed).ToString(), chained.ToString());
+  EXPECT_EQ(SumDecimals(mixed).Fractional(), 8);
+
+  // Partial sums beyond an int64 mantissa are fine as long as the total
+  // fits.
+  std::vector<Decimal> wide = {D("9223372036854775807"),
+                               D("9223372036854775807"),
+                               D("-9223372036854775807"), D("0.5")};
+  EXPECT_EQ(SumDecimals(wide).ToString(), "9223372036854775807.5");
+  EXPECT_FALSE(SumDecimals(wide).IsCompact());
+  wide.push_back(D("-9223372036854775807"));
+  EXPECT_TRUE(SumDecimals(wide).IsCompact());
+
+  // Promoted values are accumulated as well.
+  std::vector<Decimal> boxed = {D("92233720368547758.12345678"), D("-1")};
+  EXPECT_EQ(SumDecimals(boxed), boxed[0] - D("1"));
+
+  std::vector<Decimal> overflow = {D("9223372036854775807"), D("1")};
+  EXPECT_THROW(SumDecimals(overflow), ::fixed::OverflowException);
+}
+
+TEST(TestDecimal, Checked) {
+  Decimal d("1.5");
+  EXPECT_TRUE(d.CheckedAdd(D("2.25")).ok());
+  EXPECT_EQ(d.ToString(), "3.75");
+  EXPECT_TRUE(d.CheckedSub(D("4")).ok());
+  EXPECT_EQ(d.ToString(), "-0.25");
+  EXPECT_TRUE(d.CheckedMul(D("-2")).ok());
+  EXPECT_EQ(d.ToString(), "0.50");
+  EXPECT_TRUE(d.CheckedDiv(D("0.25")).ok());
+  EXPECT_EQ(d, D("2"));
+
+  // Boxed values go through the general path.
+  Decimal big("92233720368547758.12345678");
+  EXPECT_TRUE(big.CheckedAdd(D("1")).ok());
+  EXPECT_EQ(big.ToString(), "92233720368547759.12345678");
+
+  // Failures leave the value alone.
+  Decimal max("9223372036854775807");
+  absl::Status status = max.CheckedAdd(D("1"));
+  EXPECT_EQ(status.code(), absl::StatusCode::kOutOfRange);
+  EXPECT_EQ(max.ToString(), "9223372036854775807");
+  EXPECT_EQ(max.CheckedMul(D("10")).code(), absl::StatusCode::kOutOfRange);
+  EXPECT_EQ(max.CheckedSub(D("-1")).code(), absl::StatusCode::kOutOfRange);
+  EXPECT_EQ(max.ToString(), "9223372036854775807");
+
+  status = d.CheckedDiv(D("0.00"));
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(d, D("2"));
+}
+
+TEST(TestDecimal, Quantize) {
+  EXPECT_EQ(D("1.2345").Quantize(2, Rounding::Mode::TO_NEAREST_HALF_UP)
+                .ToString(),
+            "1.23");
+  EXPECT_EQ(D("2.5").Quantize(0, Rounding::Mode::TO_NEAREST_HALF_TO_EVEN)
+                .ToString(),
+            "2");
+  EXPECT_EQ(D("-2.5").Quantize(0, Rounding::Mode::DOWN).ToString(), "-3");
+  EXPECT_EQ(D("7").Quantize(3, Rounding::Mode::DOWN).ToString(), "7.000");
+  EXPECT_TRUE(D("+1.25").Quantize(1, Rounding::Mode::UP).HasSign());
+
+  // Same results as fixed::Number, for every rounding mode, compact or not.
+  const char *values[] = {"0",
+                          "1.5",
+                          "-1.5",
+                          "0.125",
+                          "-0.005",
+                          "123456.789",
+                          "-99999999.99999999",
+                          "922337203685477.5807",
+                          "92233720368547758.12345678",
+                          "-9223372036854775807"};
+  for (const char *value : values) {
+    for (int mode = 0;
+         mode < static_cast<int>(Rounding::Mode::MODE_MAX_VAL); mode++) {
+      for (int scale = 0; scale <= Decimal::kMaxScale; scale++) {
+        Rounding::Mode m = static_cast<Rounding::Mode>(mode);
+        ::fixed::Number expected(value);
+        expected.setRoundingMode(m);
+        expected.setDecimalPlaces(scale);
+        Decimal d(value);
+        d.Quantize(scale, m);
+        EXPECT_EQ(d.ToString(), expected.toString())
+            << value << " " << Rounding::modeToString(m) << " " << scale;
+        EXPECT_EQ(d.Fractional(), scale);
+      }
+    }
+  }
+}
+
+TEST(TestDecimal, FormatTo) {
+  const char *values[] = {"0",
+                          "-7",
+                          "1.0",
+                          "-0.5",
+                          "0.00000001",
+                          "100034.027456",
+                          "-9223372036854775807",
+                          "9223372036854775807.00000000000001",
+                          "-92233720368547758.12345678"};
+  for (const char *value : values) {
+    Decimal d(value);
+    char buf[Decimal::kMaxFormattedSize];
+    char *end = d.FormatTo(buf);
+    EXPECT_EQ(string(buf, end), value);
+    EXPECT_EQ(d.ToString(), d.ToNumber().toString());
+    EXPECT_EQ(absl::StrCat("[", DecimalAlphaNum(d), "]"),
+              absl::StrCat("[", value, "]"));
+  }
+
+  // Computed values keep their scale.
+  EXPECT_EQ((D("1.5") * D("2.00")).ToString(), "3.000");
+  EXPECT_EQ((D("1") - D("1.25")).ToString(), "-0.25");
+}
+
 #undef D
 
 }  // namespace beanquick
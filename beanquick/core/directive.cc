@@ -0,0 +1,135 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "beanquick/core/directive.h"
+
+namespace beanquick {
+
+constexpr DirectiveType Transaction::kType;
+constexpr DirectiveType Open::kType;
+constexpr DirectiveType Close::kType;
+constexpr DirectiveType Commodity::kType;
+constexpr DirectiveType Pad::kType;
+constexpr DirectiveType Balance::kType;
+constexpr DirectiveType Note::kType;
+constexpr DirectiveType Event::kType;
+constexpr DirectiveType Query::kType;
+constexpr DirectiveType Price::kType;
+constexpr DirectiveType Document::kType;
+constexpr DirectiveType Custom::kType;
+
+void Ledger::ReleaseNumber(void *number) {
+  *static_cast<Decimal *>(number) = Decimal();
+}
+
+void Ledger::ReleaseAmount(void *amount) {
+  *static_cast<Amount *>(amount) = Amount(Decimal(), kNoCurrency);
+}
+
+AccountId Ledger::InternAccount(absl::string_view account) {
+  auto it = account_ids_.find(account);
+  if (it != account_ids_.end()) {
+    return it->second;
+  }
+  AccountId id = static_cast<AccountId>(accounts_.size());
+  absl::string_view name = arena_.CopyString(account);
+  accounts_.push_back(name);
+  account_ids_.emplace(name, id);
+  return id;
+}
+
+bool Ledger::FindAccount(absl::string_view account, AccountId *id) const {
+  auto it = account_ids_.find(account);
+  if (it == account_ids_.end()) {
+    return false;
+  }
+  *id = it->second;
+  return true;
+}
+
+std::vector<AccountId> Ledger::InternAccounts(const Ledger &other) {
+  std::vector<AccountId> ids;
+  ids.reserve(other.accounts_.size());
+  for (absl::string_view account : other.accounts_) {
+    ids.push_back(InternAccount(account));
+  }
+  return ids;
+}
+
+void Ledger::RemapAccounts(absl::Span<const AccountId> ids) {
+  // The directives are in the arena of this ledger, const only to others.
+  for (const Directive *directive : directives_) {
+    Directive *mutable_directive = const_cast<Directive *>(directive);
+    switch (directive->type) {
+      case DirectiveType::kTransaction:
+        for (const Posting &posting :
+             static_cast<Transaction *>(mutable_directive)->postings) {
+          const_cast<Posting &>(posting).account = ids[posting.account];
+        }
+        break;
+      case DirectiveType::kOpen: {
+        Open *open = static_cast<Open *>(mutable_directive);
+        open->account = ids[open->account];
+        break;
+      }
+      case DirectiveType::kClose: {
+        Close *close = static_cast<Close *>(mutable_directive);
+        close->account = ids[close->account];
+        break;
+      }
+      case DirectiveType::kPad: {
+        Pad *pad = static_cast<Pad *>(mutable_directive);
+        pad->account = ids[pad->account];
+        pad->source_account = ids[pad->source_account];
+        break;
+      }
+      case DirectiveType::kBalance: {
+        Balance *balance = static_cast<Balance *>(mutable_directive);
+        balance->account = ids[balance->account];
+        break;
+      }
+      case DirectiveType::kNote: {
+        Note *note = static_cast<Note *>(mutable_directive);
+        note->account = ids[note->account];
+        break;
+      }
+      case DirectiveType::kDocument: {
+        Document *document = static_cast<Document *>(mutable_directive);
+        document->account = ids[document->account];
+        break;
+      }
+      case DirectiveType::kCommodity:
+      case DirectiveType::kEvent:
+      case DirectiveType::kQuery:
+      case DirectiveType::kPrice:
+      case DirectiveType::kCustom:
+        break;
+    }
+  }
+}
+
+void Ledger::Splice(std::unique_ptr<Ledger> other) {
+  directives_.insert(directives_.end(), other->directives_.begin(),
+                     other->directives_.end());
+  // Only the arena is still of use.
+  std::vector<const Directive *>().swap(other->directives_);
+  std::vector<absl::string_view>().swap(other->accounts_);
+  absl::flat_hash_map<absl::string_view, AccountId>().swap(
+      other->account_ids_);
+  Adopt(std::move(other));
+}
+
+}  // namespace beanquick
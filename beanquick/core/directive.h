@@ -0,0 +1,369 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef DEANQUICK_DIRECTIVE_H_
+#define DEANQUICK_DIRECTIVE_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "beanquick/core/amount.h"
+#include "beanquick/core/arena.h"
+#include "beanquick/core/base.h"
+#include "beanquick/core/currency.h"
+#include "beanquick/core/date.h"
+#include "beanquick/core/inventory.h"
+
+// The in-memory form of the directives of schema.proto. Directives, their
+// postings, strings and metadata all live in the Arena of the Ledger which
+// holds them, and refer to accounts and currencies by id. Once added to a
+// ledger they are read only. See directive_proto.h for the conversion to and
+// from the messages.
+namespace beanquick {
+
+// A small integer standing for an account of a Ledger, dense from 0 in
+// first-seen order.
+typedef uint32 AccountId;
+
+enum class DirectiveType : uint8 {
+  kTransaction,
+  kOpen,
+  kClose,
+  kCommodity,
+  kPad,
+  kBalance,
+  kNote,
+  kEvent,
+  kQuery,
+  kPrice,
+  kDocument,
+  kCustom,
+};
+
+// Same values as the Booking enum of schema.proto.
+enum class Booking : uint8 {
+  kUnknown = 0,
+  kStrict = 1,
+  kNone = 2,
+  kAverage = 3,
+  kFifo = 4,
+  kLifo = 5,
+};
+
+// A metadata entry, the KV message.
+struct MetaEntry {
+  absl::string_view key;
+  absl::string_view value;
+};
+
+typedef absl::Span<const MetaEntry> Meta;
+
+// The cost of a posting, a Cost which doesn't own its label.
+struct PostingCost {
+  bool empty() const { return currency == kNoCurrency; }
+
+  Cost ToCost() const {
+    Cost cost;
+    cost.number = number;
+    cost.currency = currency;
+    cost.date = date;
+    cost.label.assign(label.data(), label.size());
+    return cost;
+  }
+
+  Decimal number;
+  CurrencyId currency = kNoCurrency;
+  // Days since 1970-01-01, Date::days().
+  int32 date = Cost::kNoDate;
+  absl::string_view label;
+};
+
+// Amounts, costs and prices which are missing, e.g. the units left for the
+// booking to fill in, have kNoCurrency as currency.
+struct Posting {
+  Posting() : units(Decimal(), kNoCurrency), price(Decimal(), kNoCurrency) {}
+
+  bool has_units() const { return units.currency_id() != kNoCurrency; }
+  bool has_price() const { return price.currency_id() != kNoCurrency; }
+
+  Meta meta;
+  // The flag character, 0 when there is none.
+  char flag = 0;
+  AccountId account = 0;
+  Amount units;
+  PostingCost cost;
+  Amount price;
+};
+
+// -----------------------------------------------------------------------------
+// Directive Definition.
+// -----------------------------------------------------------------------------
+// What all directives have in common. The rest is in the struct for its
+// type, see As().
+struct Directive {
+  explicit Directive(DirectiveType type) : type(type) {}
+
+  // Returns this directive as a T, nullptr if it is of another type.
+  template <class T>
+  const T *As() const {
+    return type == T::kType ? static_cast<const T *>(this) : nullptr;
+  }
+
+  DirectiveType type;
+  Date date;
+  Meta meta;
+};
+
+struct Transaction : Directive {
+  static constexpr DirectiveType kType = DirectiveType::kTransaction;
+  Transaction() : Directive(kType) {}
+
+  char flag = 0;
+  absl::string_view payee;
+  absl::string_view narration;
+  absl::Span<const absl::string_view> tags;
+  absl::Span<const absl::string_view> links;
+  absl::Span<const Posting> postings;
+};
+
+struct Open : Directive {
+  static constexpr DirectiveType kType = DirectiveType::kOpen;
+  Open() : Directive(kType) {}
+
+  AccountId account = 0;
+  absl::Span<const CurrencyId> currencies;
+  Booking booking = Booking::kUnknown;
+};
+
+struct Close : Directive {
+  static constexpr DirectiveType kType = DirectiveType::kClose;
+  Close() : Directive(kType) {}
+
+  AccountId account = 0;
+};
+
+struct Commodity : Directive {
+  static constexpr DirectiveType kType = DirectiveType::kCommodity;
+  Commodity() : Directive(kType) {}
+
+  CurrencyId currency = kNoCurrency;
+};
+
+struct Pad : Directive {
+  static constexpr DirectiveType kType = DirectiveType::kPad;
+  Pad() : Directive(kType) {}
+
+  AccountId account = 0;
+  AccountId source_account = 0;
+};
+
+struct Balance : Directive {
+  static constexpr DirectiveType kType = DirectiveType::kBalance;
+  Balance()
+      : Directive(kType),
+        amount(Decimal(), kNoCurrency),
+        diff_amount(Decimal(), kNoCurrency) {}
+
+  AccountId account = 0;
+  Amount amount;
+  bool has_tolerance = false;
+  Decimal tolerance;
+  Amount diff_amount;
+};
+
+struct Note : Directive {
+  static constexpr DirectiveType kType = DirectiveType::kNote;
+  Note() : Directive(kType) {}
+
+  AccountId account = 0;
+  absl::string_view comment;
+};
+
+struct Event : Directive {
+  static constexpr DirectiveType kType = DirectiveType::kEvent;
+  Event() : Directive(kType) {}
+
+  // The type field of the message, named apart from Directive::type.
+  absl::string_view event_type;
+  absl::string_view description;
+};
+
+struct Query : Directive {
+  static constexpr DirectiveType kType = DirectiveType::kQuery;
+  Query() : Directive(kType) {}
+
+  absl::string_view name;
+  absl::string_view query_string;
+};
+
+struct Price : Directive {
+  static constexpr DirectiveType kType = DirectiveType::kPrice;
+  Price() : Directive(kType), amount(Decimal(), kNoCurrency) {}
+
+  CurrencyId currency = kNoCurrency;
+  Amount amount;
+};
+
+struct Document : Directive {
+  static constexpr DirectiveType kType = DirectiveType::kDocument;
+  Document() : Directive(kType) {}
+
+  AccountId account = 0;
+  absl::string_view filename;
+  absl::Span<const absl::string_view> tags;
+  absl::Span<const absl::string_view> links;
+};
+
+struct Custom : Directive {
+  static constexpr DirectiveType kType = DirectiveType::kCustom;
+  Custom() : Directive(kType) {}
+
+  absl::string_view custom_type;
+};
+
+// -----------------------------------------------------------------------------
+// Ledger Definition.
+// -----------------------------------------------------------------------------
+// The directives of a ledger, in the order they were added, and the arena
+// and account table they live in. Destroying a ledger releases everything
+// at once rather than directive by directive. Not thread safe.
+//
+//   Ledger ledger;
+//   Transaction *txn = ledger.Add<Transaction>(date);
+//   txn->narration = ledger.CopyString("Coffee");
+//   absl::Span<Posting> postings = ledger.NewArray<Posting>(2);
+//   postings[0].account = ledger.InternAccount("Expenses:Coffee");
+//   ledger.SetAmount(&postings[0].units, Amount(Decimal("3.50"), "USD"));
+//   ...
+//   txn->postings = postings;
+//
+class Ledger {
+ public:
+  Ledger() {}
+
+  Ledger(const Ledger &) = delete;
+  Ledger &operator=(const Ledger &) = delete;
+
+  // Returns a new directive of type T dated `date`, appended to the ledger.
+  template <class T>
+  T *Add(Date date) {
+    T *directive = New<T>(date);
+    Append(directive);
+    return directive;
+  }
+
+  // Like Add(), leaving it to the caller to Append() the directive once it
+  // is complete, or not.
+  template <class T>
+  T *New(Date date) {
+    T *directive = arena_.New<T>();
+    directive->date = date;
+    return directive;
+  }
+
+  // Appends `directive`, which must come from New() on this ledger.
+  void Append(const Directive *directive) { directives_.push_back(directive); }
+
+  template <class T>
+  absl::Span<T> NewArray(size_t count) {
+    return arena_.NewArray<T>(count);
+  }
+
+  template <class T>
+  absl::Span<const T> CopyArray(absl::Span<const T> from) {
+    return arena_.CopyArray<T>(from);
+  }
+
+  absl::string_view CopyString(absl::string_view str) {
+    return arena_.CopyString(str);
+  }
+
+  // Stores numbers into directives of this ledger. Numbers too large to be
+  // compact own heap memory, which is freed with the ledger.
+  void SetNumber(Decimal *slot, const Decimal &number) {
+    *slot = number;
+    if (!slot->IsCompact()) arena_.AddCleanup(slot, &ReleaseNumber);
+  }
+
+  void SetAmount(Amount *slot, const Amount &amount) {
+    *slot = amount;
+    if (!slot->Number().IsCompact()) arena_.AddCleanup(slot, &ReleaseAmount);
+  }
+
+  // Keeps `object` alive as long as the ledger, e.g. the mapped text of a
+  // file its directives point into.
+  template <class T>
+  T *Adopt(std::unique_ptr<T> object) {
+    T *ptr = object.release();
+    arena_.AddCleanup(ptr, [](void *p) { delete static_cast<T *>(p); });
+    return ptr;
+  }
+
+  // Returns the id of `account`, adding it on first sight.
+  AccountId InternAccount(absl::string_view account);
+
+  // Returns the id of an already interned `account` through `id`, false
+  // when it has never been seen.
+  bool FindAccount(absl::string_view account, AccountId *id) const;
+
+  absl::string_view AccountName(AccountId id) const { return accounts_[id]; }
+
+  // Merging ledgers built apart, e.g. from chunks of a file parsed in
+  // parallel, takes three steps:
+  //
+  //   std::vector<AccountId> ids = ledger.InternAccounts(*chunk);
+  //   chunk->RemapAccounts(ids);  // Can run in parallel for many chunks.
+  //   ledger.Splice(std::move(chunk));
+  //
+  // Interns the accounts of `other` and returns the ids they have in this
+  // ledger, by their id in `other`.
+  std::vector<AccountId> InternAccounts(const Ledger &other);
+
+  // Changes the accounts of all directives to `ids[account]`. The account
+  // table no longer matches them, so all that is left to do with the
+  // ledger is to Splice() it into the one `ids` are from.
+  void RemapAccounts(absl::Span<const AccountId> ids);
+
+  // Appends the directives of `other`, whose accounts must be of this ledger
+  // already, and keeps its arena for as long as this ledger.
+  void Splice(std::unique_ptr<Ledger> other);
+
+  int num_accounts() const { return static_cast<int>(accounts_.size()); }
+
+  absl::Span<const Directive *const> directives() const {
+    return directives_;
+  }
+
+  const Arena &arena() const { return arena_; }
+
+ private:
+  // Reset the number to zero, which frees it and makes a second call a no-op.
+  static void ReleaseNumber(void *number);
+  static void ReleaseAmount(void *amount);
+
+  Arena arena_;
+  std::vector<const Directive *> directives_;
+  // Names in the arena.
+  std::vector<absl::string_view> accounts_;
+  absl::flat_hash_map<absl::string_view, AccountId> account_ids_;
+};
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_DIRECTIVE_H_
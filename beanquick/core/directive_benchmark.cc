@@ -0,0 +1,160 @@
+#include <memory>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "beanquick/core/benchmark_util.h"
+#include "benchmark/benchmark.h"
+#include "directive_proto.h"
+
+namespace beanquick {
+namespace {
+
+constexpr int kTransactions = 100 * 1000;
+
+// Two posting transactions between 1000 accounts, with some metadata.
+struct Postings {
+  std::vector<string> accounts;
+  std::vector<Amount> amounts;
+
+  Postings() : amounts(BenchmarkAmounts(ValueMix::kLedger)) {
+    for (int i = 0; i < 1000; i++) {
+      accounts.push_back(absl::StrCat("Assets:Bank:Account", i));
+    }
+  }
+
+  const string &Account(int i) const { return accounts[i % accounts.size()]; }
+  const Amount &Units(int i) const { return amounts[i % kNumValues]; }
+};
+
+void AddTransaction(const Postings &data, int i, Ledger *ledger) {
+  Transaction *txn = ledger->Add<Transaction>(Date::FromDays(18000 + i / 100));
+  txn->flag = '*';
+  txn->narration = ledger->CopyString("Transfer between accounts");
+  absl::Span<MetaEntry> meta = ledger->NewArray<MetaEntry>(1);
+  meta[0].key = ledger->CopyString("lineno");
+  meta[0].value = ledger->CopyString(absl::StrCat(i));
+  txn->meta = meta;
+  absl::Span<Posting> postings = ledger->NewArray<Posting>(2);
+  postings[0].account = ledger->InternAccount(data.Account(i));
+  ledger->SetAmount(&postings[0].units, data.Units(i));
+  postings[1].account = ledger->InternAccount(data.Account(i + 7));
+  ledger->SetAmount(&postings[1].units, -data.Units(i));
+  txn->postings = postings;
+}
+
+void AddTransaction(const Postings &data, int i, pb::Directive *proto) {
+  proto->mutable_date()->set_year(2020);
+  proto->mutable_date()->set_month(1 + i % 12);
+  proto->mutable_date()->set_day(1 + i % 28);
+  pb::KV *kv = proto->mutable_meta()->add_kv();
+  kv->set_key("lineno");
+  kv->set_value(absl::StrCat(i));
+  pb::Transaction *txn = proto->mutable_txn();
+  txn->set_flag("*");
+  txn->set_narration("Transfer between accounts");
+  for (int j = 0; j < 2; j++) {
+    pb::Posting *posting = txn->add_postings();
+    posting->set_account(data.Account(i + 7 * j));
+    Amount units = j == 0 ? data.Units(i) : -data.Units(i);
+    posting->mutable_units()->mutable_number()->set_strvalue(
+        units.Number().ToString());
+    posting->mutable_units()->set_currency(units.Currency());
+  }
+}
+
+void SetCounters(benchmark::State &state, int64 allocs) {
+  state.SetItemsProcessed(state.iterations() * kTransactions);
+  state.counters["allocs/txn"] =
+      static_cast<double>(allocs) /
+      (static_cast<double>(state.iterations()) * kTransactions);
+}
+
+// Loading kTransactions transactions into a Ledger, then dropping it.
+void BM_LedgerBuild(benchmark::State &state) {
+  Postings data;
+  int64 allocs = 0;
+  for (auto _ : state) {
+    int64 start = AllocationCount();
+    Ledger ledger;
+    for (int i = 0; i < kTransactions; i++) {
+      AddTransaction(data, i, &ledger);
+    }
+    allocs += AllocationCount() - start;
+    benchmark::DoNotOptimize(ledger.directives().data());
+  }
+  SetCounters(state, allocs);
+}
+BENCHMARK(BM_LedgerBuild)->Unit(benchmark::kMillisecond);
+
+// The same transactions as Directive messages, for reference.
+void BM_ProtoBuild(benchmark::State &state) {
+  Postings data;
+  int64 allocs = 0;
+  for (auto _ : state) {
+    int64 start = AllocationCount();
+    std::vector<pb::Directive> directives(kTransactions);
+    for (int i = 0; i < kTransactions; i++) {
+      AddTransaction(data, i, &directives[i]);
+    }
+    allocs += AllocationCount() - start;
+    benchmark::DoNotOptimize(directives.data());
+  }
+  SetCounters(state, allocs);
+}
+BENCHMARK(BM_ProtoBuild)->Unit(benchmark::kMillisecond);
+
+// Only freeing the ledger.
+void BM_LedgerDestroy(benchmark::State &state) {
+  Postings data;
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::unique_ptr<Ledger> ledger(new Ledger);
+    for (int i = 0; i < kTransactions; i++) {
+      AddTransaction(data, i, ledger.get());
+    }
+    state.ResumeTiming();
+    ledger.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * kTransactions);
+}
+BENCHMARK(BM_LedgerDestroy)->Unit(benchmark::kMicrosecond);
+
+void BM_ProtoDestroy(benchmark::State &state) {
+  Postings data;
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::unique_ptr<std::vector<pb::Directive>> directives(
+        new std::vector<pb::Directive>(kTransactions));
+    for (int i = 0; i < kTransactions; i++) {
+      AddTransaction(data, i, &(*directives)[i]);
+    }
+    state.ResumeTiming();
+    directives.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * kTransactions);
+}
+BENCHMARK(BM_ProtoDestroy)->Unit(benchmark::kMicrosecond);
+
+// Converting the messages to a Ledger.
+void BM_DirectiveFromProto(benchmark::State &state) {
+  Postings data;
+  std::vector<pb::Directive> directives(kTransactions);
+  for (int i = 0; i < kTransactions; i++) {
+    AddTransaction(data, i, &directives[i]);
+  }
+  int64 allocs = 0;
+  for (auto _ : state) {
+    int64 start = AllocationCount();
+    Ledger ledger;
+    for (const auto &proto : directives) {
+      absl::Status status = DirectiveFromProto(proto, &ledger);
+      if (!status.ok()) state.SkipWithError("bad directive");
+    }
+    allocs += AllocationCount() - start;
+  }
+  SetCounters(state, allocs);
+}
+BENCHMARK(BM_DirectiveFromProto)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace beanquick
@@ -0,0 +1,480 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "beanquick/core/directive_proto.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace beanquick {
+
+namespace {
+typedef google::protobuf::RepeatedPtrField<string> RepeatedString;
+
+// ---- To proto. ----
+
+void NumberToProto(const Decimal &number, pb::Decimal *proto) {
+  proto->set_strvalue(number.ToString());
+}
+
+void AmountToProto(const Amount &amount, pb::Amount *proto) {
+  NumberToProto(amount.Number(), proto->mutable_number());
+  proto->set_currency(amount.Currency());
+}
+
+void FlagToProto(char flag, string *proto) {
+  if (flag != 0) proto->assign(1, flag);
+}
+
+void StringsToProto(absl::Span<const absl::string_view> strings,
+                    RepeatedString *proto) {
+  proto->Reserve(static_cast<int>(strings.size()));
+  for (absl::string_view str : strings) {
+    proto->Add()->assign(str.data(), str.size());
+  }
+}
+
+void MetaToProto(Meta meta, pb::Meta *proto) {
+  for (const MetaEntry &entry : meta) {
+    pb::KV *kv = proto->add_kv();
+    kv->set_key(entry.key.data(), entry.key.size());
+    kv->set_value(entry.value.data(), entry.value.size());
+  }
+}
+
+void PostingToProto(const Ledger &ledger, const Posting &posting,
+                    pb::Posting *proto) {
+  if (!posting.meta.empty()) MetaToProto(posting.meta, proto->mutable_meta());
+  FlagToProto(posting.flag, proto->mutable_flag());
+  absl::string_view account = ledger.AccountName(posting.account);
+  proto->set_account(account.data(), account.size());
+  if (posting.has_units()) AmountToProto(posting.units, proto->mutable_units());
+  if (!posting.cost.empty()) {
+    pb::Cost *cost = proto->mutable_cost();
+    NumberToProto(posting.cost.number, cost->mutable_number());
+    cost->set_currency(CurrencyName(posting.cost.currency));
+    if (posting.cost.date != Cost::kNoDate) {
+      DateToProto(Date::FromDays(posting.cost.date), cost->mutable_date());
+    }
+    cost->set_label(posting.cost.label.data(), posting.cost.label.size());
+  }
+  if (posting.has_price()) AmountToProto(posting.price, proto->mutable_price());
+}
+
+void SetAccount(const Ledger &ledger, AccountId id, string *proto) {
+  absl::string_view account = ledger.AccountName(id);
+  proto->assign(account.data(), account.size());
+}
+
+void SetString(absl::string_view str, string *proto) {
+  proto->assign(str.data(), str.size());
+}
+
+// ---- From proto. ----
+
+absl::Status ParseNumber(const pb::Decimal &proto, Decimal *number) {
+  absl::Status status = Decimal::Parse(proto.strvalue(), number);
+  if (!status.ok()) {
+    return absl::InvalidArgumentError(status.message());
+  }
+  return absl::OkStatus();
+}
+
+absl::Status NumberFromProto(const pb::Decimal &proto, Ledger *ledger,
+                             Decimal *slot) {
+  Decimal number;
+  absl::Status status = ParseNumber(proto, &number);
+  if (!status.ok()) return status;
+  ledger->SetNumber(slot, number);
+  return absl::OkStatus();
+}
+
+absl::Status CurrencyFromProto(const string &proto, CurrencyId *id) {
+  if (!CurrencyTable::Global().Intern(proto, id)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("invalid currency '", proto, "'"));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status AmountFromProto(const pb::Amount &proto, Ledger *ledger,
+                             Amount *slot) {
+  CurrencyId currency;
+  absl::Status status = CurrencyFromProto(proto.currency(), &currency);
+  if (!status.ok()) return status;
+  Decimal number;
+  status = ParseNumber(proto.number(), &number);
+  if (!status.ok()) return status;
+  ledger->SetAmount(slot, Amount(std::move(number), currency));
+  return absl::OkStatus();
+}
+
+absl::Status FlagFromProto(const string &proto, char *flag) {
+  if (proto.size() > 1) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("flag '", proto, "' is not a single character"));
+  }
+  *flag = proto.empty() ? 0 : proto[0];
+  return absl::OkStatus();
+}
+
+absl::Span<const absl::string_view> StringsFromProto(
+    const RepeatedString &proto, Ledger *ledger) {
+  absl::Span<absl::string_view> strings =
+      ledger->NewArray<absl::string_view>(proto.size());
+  for (int i = 0; i < proto.size(); i++) {
+    strings[i] = ledger->CopyString(proto.Get(i));
+  }
+  return strings;
+}
+
+Meta MetaFromProto(const pb::Meta &proto, Ledger *ledger) {
+  absl::Span<MetaEntry> meta = ledger->NewArray<MetaEntry>(proto.kv_size());
+  for (int i = 0; i < proto.kv_size(); i++) {
+    meta[i].key = ledger->CopyString(proto.kv(i).key());
+    meta[i].value = ledger->CopyString(proto.kv(i).value());
+  }
+  return meta;
+}
+
+absl::Status PostingFromProto(const pb::Posting &proto, Ledger *ledger,
+                              Posting *posting) {
+  posting->meta = MetaFromProto(proto.meta(), ledger);
+  absl::Status status = FlagFromProto(proto.flag(), &posting->flag);
+  if (!status.ok()) return status;
+  posting->account = ledger->InternAccount(proto.account());
+  if (proto.has_units()) {
+    status = AmountFromProto(proto.units(), ledger, &posting->units);
+    if (!status.ok()) return status;
+  }
+  if (proto.has_cost()) {
+    const pb::Cost &cost = proto.cost();
+    status = CurrencyFromProto(cost.currency(), &posting->cost.currency);
+    if (!status.ok()) return status;
+    status = NumberFromProto(cost.number(), ledger, &posting->cost.number);
+    if (!status.ok()) return status;
+    if (cost.has_date()) {
+      Date date;
+      status = DateFromProto(cost.date(), &date);
+      if (!status.ok()) return status;
+      posting->cost.date = date.days();
+    }
+    posting->cost.label = ledger->CopyString(cost.label());
+  }
+  if (proto.has_price()) {
+    status = AmountFromProto(proto.price(), ledger, &posting->price);
+    if (!status.ok()) return status;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status TransactionFromProto(const pb::Transaction &proto, Date date,
+                                  Ledger *ledger, Directive **out) {
+  Transaction *txn = ledger->New<Transaction>(date);
+  absl::Status status = FlagFromProto(proto.flag(), &txn->flag);
+  if (!status.ok()) return status;
+  txn->payee = ledger->CopyString(proto.payee());
+  txn->narration = ledger->CopyString(proto.narration());
+  txn->tags = StringsFromProto(proto.tags(), ledger);
+  txn->links = StringsFromProto(proto.links(), ledger);
+  absl::Span<Posting> postings =
+      ledger->NewArray<Posting>(proto.postings_size());
+  for (int i = 0; i < proto.postings_size(); i++) {
+    status = PostingFromProto(proto.postings(i), ledger, &postings[i]);
+    if (!status.ok()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("posting ", i, ": ", status.message()));
+    }
+  }
+  txn->postings = postings;
+  *out = txn;
+  return absl::OkStatus();
+}
+
+absl::Status OpenFromProto(const pb::Open &proto, Date date, Ledger *ledger,
+                           Directive **out) {
+  Open *open = ledger->New<Open>(date);
+  open->account = ledger->InternAccount(proto.account());
+  absl::Span<CurrencyId> currencies =
+      ledger->NewArray<CurrencyId>(proto.currencies_size());
+  for (int i = 0; i < proto.currencies_size(); i++) {
+    absl::Status status =
+        CurrencyFromProto(proto.currencies(i), &currencies[i]);
+    if (!status.ok()) return status;
+  }
+  open->currencies = currencies;
+  if (proto.booking() < pb::UNKNOWN || proto.booking() > pb::LIFO) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("unknown booking ", proto.booking()));
+  }
+  open->booking = static_cast<Booking>(proto.booking());
+  *out = open;
+  return absl::OkStatus();
+}
+
+absl::Status BalanceFromProto(const pb::Balance &proto, Date date,
+                              Ledger *ledger, Directive **out) {
+  Balance *balance = ledger->New<Balance>(date);
+  balance->account = ledger->InternAccount(proto.account());
+  absl::Status status;
+  if (proto.has_amount()) {
+    status = AmountFromProto(proto.amount(), ledger, &balance->amount);
+    if (!status.ok()) return status;
+  }
+  if (proto.has_tolerance()) {
+    balance->has_tolerance = true;
+    status = NumberFromProto(proto.tolerance(), ledger, &balance->tolerance);
+    if (!status.ok()) return status;
+  }
+  if (proto.has_diff_amount()) {
+    status =
+        AmountFromProto(proto.diff_amount(), ledger, &balance->diff_amount);
+    if (!status.ok()) return status;
+  }
+  *out = balance;
+  return absl::OkStatus();
+}
+
+absl::Status PriceFromProto(const pb::Price &proto, Date date,
+                            Ledger *ledger, Directive **out) {
+  Price *price = ledger->New<Price>(date);
+  absl::Status status = CurrencyFromProto(proto.currency(), &price->currency);
+  if (!status.ok()) return status;
+  if (proto.has_amount()) {
+    status = AmountFromProto(proto.amount(), ledger, &price->amount);
+    if (!status.ok()) return status;
+  }
+  *out = price;
+  return absl::OkStatus();
+}
+}  // namespace
+
+void DateToProto(Date date, pb::Date *proto) {
+  int year, month, day;
+  date.ToCivil(&year, &month, &day);
+  proto->set_year(year);
+  proto->set_month(month);
+  proto->set_day(day);
+}
+
+absl::Status DateFromProto(const pb::Date &proto, Date *date) {
+  if (proto.year() < 1 || proto.year() > 9999 ||
+      !Date::IsValid(proto.year(), proto.month(), proto.day())) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("invalid date ", proto.year(), "-", proto.month(), "-",
+                     proto.day()));
+  }
+  *date = Date::FromCivil(proto.year(), proto.month(), proto.day());
+  return absl::OkStatus();
+}
+
+void DirectiveToProto(const Ledger &ledger, const Directive &directive,
+                      pb::Directive *proto) {
+  if (!directive.meta.empty()) {
+    MetaToProto(directive.meta, proto->mutable_meta());
+  }
+  DateToProto(directive.date, proto->mutable_date());
+  switch (directive.type) {
+    case DirectiveType::kTransaction: {
+      const Transaction &txn = *directive.As<Transaction>();
+      pb::Transaction *out = proto->mutable_txn();
+      FlagToProto(txn.flag, out->mutable_flag());
+      SetString(txn.payee, out->mutable_payee());
+      SetString(txn.narration, out->mutable_narration());
+      StringsToProto(txn.tags, out->mutable_tags());
+      StringsToProto(txn.links, out->mutable_links());
+      out->mutable_postings()->Reserve(static_cast<int>(txn.postings.size()));
+      for (const Posting &posting : txn.postings) {
+        PostingToProto(ledger, posting, out->add_postings());
+      }
+      break;
+    }
+    case DirectiveType::kOpen: {
+      const Open &open = *directive.As<Open>();
+      pb::Open *out = proto->mutable_open();
+      SetAccount(ledger, open.account, out->mutable_account());
+      for (CurrencyId currency : open.currencies) {
+        out->add_currencies(CurrencyName(currency));
+      }
+      out->set_booking(static_cast<pb::Booking>(open.booking));
+      break;
+    }
+    case DirectiveType::kClose: {
+      SetAccount(ledger, directive.As<Close>()->account,
+                 proto->mutable_close()->mutable_account());
+      break;
+    }
+    case DirectiveType::kCommodity: {
+      proto->mutable_commodity()->set_currency(
+          CurrencyName(directive.As<Commodity>()->currency));
+      break;
+    }
+    case DirectiveType::kPad: {
+      const Pad &pad = *directive.As<Pad>();
+      pb::Pad *out = proto->mutable_pad();
+      SetAccount(ledger, pad.account, out->mutable_account());
+      SetAccount(ledger, pad.source_account, out->mutable_source_account());
+      break;
+    }
+    case DirectiveType::kBalance: {
+      const Balance &balance = *directive.As<Balance>();
+      pb::Balance *out = proto->mutable_balance();
+      SetAccount(ledger, balance.account, out->mutable_account());
+      if (balance.amount.currency_id() != kNoCurrency) {
+        AmountToProto(balance.amount, out->mutable_amount());
+      }
+      if (balance.has_tolerance) {
+        NumberToProto(balance.tolerance, out->mutable_tolerance());
+      }
+      if (balance.diff_amount.currency_id() != kNoCurrency) {
+        AmountToProto(balance.diff_amount, out->mutable_diff_amount());
+      }
+      break;
+    }
+    case DirectiveType::kNote: {
+      const Note &note = *directive.As<Note>();
+      pb::Note *out = proto->mutable_note();
+      SetAccount(ledger, note.account, out->mutable_account());
+      SetString(note.comment, out->mutable_comment());
+      break;
+    }
+    case DirectiveType::kEvent: {
+      const Event &event = *directive.As<Event>();
+      pb::Event *out = proto->mutable_event();
+      SetString(event.event_type, out->mutable_type());
+      SetString(event.description, out->mutable_description());
+      break;
+    }
+    case DirectiveType::kQuery: {
+      const Query &query = *directive.As<Query>();
+      pb::Query *out = proto->mutable_query();
+      SetString(query.name, out->mutable_name());
+      SetString(query.query_string, out->mutable_query_string());
+      break;
+    }
+    case DirectiveType::kPrice: {
+      const Price &price = *directive.As<Price>();
+      pb::Price *out = proto->mutable_price();
+      out->set_currency(CurrencyName(price.currency));
+      if (price.amount.currency_id() != kNoCurrency) {
+        AmountToProto(price.amount, out->mutable_amount());
+      }
+      break;
+    }
+    case DirectiveType::kDocument: {
+      const Document &document = *directive.As<Document>();
+      pb::Document *out = proto->mutable_document();
+      SetAccount(ledger, document.account, out->mutable_account());
+      SetString(document.filename, out->mutable_filename());
+      StringsToProto(document.tags, out->mutable_tags());
+      StringsToProto(document.links, out->mutable_links());
+      break;
+    }
+    case DirectiveType::kCustom: {
+      SetString(directive.As<Custom>()->custom_type,
+                proto->mutable_custom()->mutable_type());
+      break;
+    }
+  }
+}
+
+absl::Status DirectiveFromProto(const pb::Directive &proto, Ledger *ledger,
+                                const Directive **out) {
+  int count = proto.has_txn() + proto.has_open() + proto.has_close() +
+              proto.has_commodity() + proto.has_pad() + proto.has_balance() +
+              proto.has_note() + proto.has_event() + proto.has_query() +
+              proto.has_price() + proto.has_document() + proto.has_custom();
+  if (count != 1) {
+    return absl::InvalidArgumentError(
+        count == 0 ? "no directive" : "more than one directive");
+  }
+  if (!proto.has_date()) {
+    return absl::InvalidArgumentError("missing date");
+  }
+  Date date;
+  absl::Status status = DateFromProto(proto.date(), &date);
+  if (!status.ok()) return status;
+
+  Directive *directive = nullptr;
+  if (proto.has_txn()) {
+    status = TransactionFromProto(proto.txn(), date, ledger, &directive);
+  }
+  else if (proto.has_open()) {
+    status = OpenFromProto(proto.open(), date, ledger, &directive);
+  }
+  else if (proto.has_close()) {
+    Close *close = ledger->New<Close>(date);
+    close->account = ledger->InternAccount(proto.close().account());
+    directive = close;
+  }
+  else if (proto.has_commodity()) {
+    Commodity *commodity = ledger->New<Commodity>(date);
+    status =
+        CurrencyFromProto(proto.commodity().currency(), &commodity->currency);
+    directive = commodity;
+  }
+  else if (proto.has_pad()) {
+    Pad *pad = ledger->New<Pad>(date);
+    pad->account = ledger->InternAccount(proto.pad().account());
+    pad->source_account = ledger->InternAccount(proto.pad().source_account());
+    directive = pad;
+  }
+  else if (proto.has_balance()) {
+    status = BalanceFromProto(proto.balance(), date, ledger, &directive);
+  }
+  else if (proto.has_note()) {
+    Note *note = ledger->New<Note>(date);
+    note->account = ledger->InternAccount(proto.note().account());
+    note->comment = ledger->CopyString(proto.note().comment());
+    directive = note;
+  }
+  else if (proto.has_event()) {
+    Event *event = ledger->New<Event>(date);
+    event->event_type = ledger->CopyString(proto.event().type());
+    event->description = ledger->CopyString(proto.event().description());
+    directive = event;
+  }
+  else if (proto.has_query()) {
+    Query *query = ledger->New<Query>(date);
+    query->name = ledger->CopyString(proto.query().name());
+    query->query_string = ledger->CopyString(proto.query().query_string());
+    directive = query;
+  }
+  else if (proto.has_price()) {
+    status = PriceFromProto(proto.price(), date, ledger, &directive);
+  }
+  else if (proto.has_document()) {
+    const pb::Document &document = proto.document();
+    Document *out = ledger->New<Document>(date);
+    out->account = ledger->InternAccount(document.account());
+    out->filename = ledger->CopyString(document.filename());
+    out->tags = StringsFromProto(document.tags(), ledger);
+    out->links = StringsFromProto(document.links(), ledger);
+    directive = out;
+  }
+  else {
+    Custom *custom = ledger->New<Custom>(date);
+    custom->custom_type = ledger->CopyString(proto.custom().type());
+    directive = custom;
+  }
+  if (!status.ok()) return status;
+
+  directive->meta = MetaFromProto(proto.meta(), ledger);
+  ledger->Append(directive);
+  if (out != nullptr) *out = directive;
+  return absl::OkStatus();
+}
+
+}  // namespace beanquick
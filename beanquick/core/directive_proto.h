@@ -0,0 +1,45 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef DEANQUICK_DIRECTIVE_PROTO_H_
+#define DEANQUICK_DIRECTIVE_PROTO_H_
+
+#include "absl/status/status.h"
+#include "beanquick/core/directive.h"
+#include "beanquick/core/schema.pb.h"
+
+// Conversion between the directives of a Ledger and the Directive message of
+// schema.proto, for interchange. Processing should stay on the native model.
+namespace beanquick {
+
+// Fills `proto` with `directive`, which belongs to `ledger`.
+void DirectiveToProto(const Ledger &ledger, const Directive &directive,
+                      pb::Directive *proto);
+
+// Appends the directive `proto` holds to `ledger`, and returns it through
+// `out` if not null. Returns an InvalidArgument error when `proto` holds no
+// directive or more than one, or an invalid date, flag, number or currency;
+// nothing is appended then.
+absl::Status DirectiveFromProto(const pb::Directive &proto, Ledger *ledger,
+                                const Directive **out = nullptr);
+
+// Conversions of dates to and from the Date message.
+void DateToProto(Date date, pb::Date *proto);
+absl::Status DateFromProto(const pb::Date &proto, Date *date);
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_DIRECTIVE_PROTO_H_
@@ -0,0 +1,181 @@
+#include "directive_proto.h"
+
+#include "google/protobuf/text_format.h"
+#include "google/protobuf/util/message_differencer.h"
+#include "gtest/gtest.h"
+
+namespace beanquick {
+namespace {
+
+pb::Directive ParseText(const string &text) {
+  pb::Directive proto;
+  CHECK(google::protobuf::TextFormat::ParseFromString(text, &proto)) << text;
+  return proto;
+}
+
+// Converts `text` to the native model and back.
+void ExpectRoundTrip(const string &text) {
+  pb::Directive proto = ParseText(text);
+  Ledger ledger;
+  const Directive *directive = nullptr;
+  absl::Status status = DirectiveFromProto(proto, &ledger, &directive);
+  ASSERT_TRUE(status.ok()) << status << "\n" << text;
+  ASSERT_EQ(1, ledger.directives().size());
+  EXPECT_EQ(ledger.directives()[0], directive);
+
+  pb::Directive back;
+  DirectiveToProto(ledger, *directive, &back);
+  EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(proto, back))
+      << "expected:\n" << proto.DebugString() << "actual:\n"
+      << back.DebugString();
+}
+
+TEST(TestDirectiveProto, Transaction) {
+  ExpectRoundTrip(R"(
+    meta { kv { key: "filename" value: "main.beancount" } }
+    date { year: 2020 month: 2 day: 29 }
+    txn {
+      flag: "*"
+      payee: "Cafe"
+      narration: "Coffee"
+      tags: "trip"
+      links: "receipt-1"
+      postings {
+        meta { kv { key: "note" value: "card" } }
+        account: "Liabilities:Card"
+        units { number { strvalue: "-3.50" } currency: "USD" }
+      }
+      postings {
+        flag: "!"
+        account: "Assets:Stock"
+        units { number { strvalue: "10" } currency: "HOOL" }
+        cost {
+          number { strvalue: "123456789012345678.123456789" }
+          currency: "USD"
+          date { year: 1999 month: 12 day: 31 }
+          label: "lot-1"
+        }
+        price { number { strvalue: "520.25" } currency: "USD" }
+      }
+      postings { account: "Expenses:Coffee" }
+    })");
+
+  pb::Directive proto = ParseText(R"(
+    date { year: 2020 month: 2 day: 29 }
+    txn {
+      postings {
+        account: "Assets:Stock"
+        units { number { strvalue: "10" } currency: "HOOL" }
+        cost { number { strvalue: "5" } currency: "USD" }
+      }
+    })");
+  Ledger ledger;
+  const Directive *directive;
+  ASSERT_TRUE(DirectiveFromProto(proto, &ledger, &directive).ok());
+  const Transaction *txn = directive->As<Transaction>();
+  ASSERT_NE(nullptr, txn);
+  EXPECT_EQ(18321, txn->date.days());
+  const Posting &posting = txn->postings[0];
+  EXPECT_EQ("Assets:Stock", ledger.AccountName(posting.account));
+  EXPECT_EQ(Amount(Decimal("10"), "HOOL"), posting.units);
+  EXPECT_EQ(Cost(Decimal("5"), "USD"), posting.cost.ToCost());
+  EXPECT_FALSE(posting.has_price());
+}
+
+TEST(TestDirectiveProto, OtherDirectives) {
+  ExpectRoundTrip(R"(
+    date { year: 1970 month: 1 day: 1 }
+    open { account: "Assets:Cash" currencies: "USD" currencies: "CAD"
+           booking: FIFO })");
+  ExpectRoundTrip(R"(
+    date { year: 1969 month: 12 day: 31 }
+    close { account: "Assets:Cash" })");
+  ExpectRoundTrip(R"(
+    date { year: 2000 month: 3 day: 1 }
+    commodity { currency: "HOOL" })");
+  ExpectRoundTrip(R"(
+    date { year: 2021 month: 1 day: 1 }
+    pad { account: "Assets:Cash" source_account: "Equity:Opening" })");
+  ExpectRoundTrip(R"(
+    date { year: 2021 month: 1 day: 2 }
+    balance {
+      account: "Assets:Cash"
+      amount { number { strvalue: "100.00" } currency: "USD" }
+      tolerance { strvalue: "0.005" }
+      diff_amount { number { strvalue: "-0.01" } currency: "USD" }
+    })");
+  ExpectRoundTrip(R"(
+    date { year: 2021 month: 1 day: 3 }
+    note { account: "Assets:Cash" comment: "Counted" })");
+  ExpectRoundTrip(R"(
+    date { year: 2021 month: 1 day: 4 }
+    event { type: "location" description: "Paris" })");
+  ExpectRoundTrip(R"(
+    date { year: 2021 month: 1 day: 5 }
+    query { name: "cash" query_string: "SELECT 1" })");
+  ExpectRoundTrip(R"(
+    date { year: 2021 month: 1 day: 6 }
+    price { currency: "HOOL"
+            amount { number { strvalue: "520.25" } currency: "USD" } })");
+  ExpectRoundTrip(R"(
+    date { year: 2021 month: 1 day: 7 }
+    document { account: "Assets:Cash" filename: "/tmp/receipt.pdf"
+               tags: "receipts" links: "l" })");
+  ExpectRoundTrip(R"(
+    date { year: 2021 month: 1 day: 8 }
+    custom { type: "budget" })");
+}
+
+TEST(TestDirectiveProto, Dates) {
+  for (int32 days : {-719162, -1, 0, 1, 11016, 18321, 2932896}) {
+    pb::Date proto;
+    DateToProto(Date::FromDays(days), &proto);
+    Date back;
+    ASSERT_TRUE(DateFromProto(proto, &back).ok()) << proto.DebugString();
+    EXPECT_EQ(days, back.days());
+  }
+  pb::Date proto;
+  DateToProto(Date(), &proto);
+  EXPECT_EQ(1970, proto.year());
+  EXPECT_EQ(1, proto.month());
+  EXPECT_EQ(1, proto.day());
+
+  Date date;
+  proto.set_year(2021);
+  proto.set_month(2);
+  proto.set_day(29);
+  EXPECT_FALSE(DateFromProto(proto, &date).ok());
+  proto.set_month(13);
+  proto.set_day(1);
+  EXPECT_FALSE(DateFromProto(proto, &date).ok());
+}
+
+TEST(TestDirectiveProto, Errors) {
+  auto error = [](const string &text) {
+    Ledger ledger;
+    absl::Status status = DirectiveFromProto(ParseText(text), &ledger);
+    EXPECT_EQ(absl::StatusCode::kInvalidArgument, status.code()) << text;
+    EXPECT_EQ(0, ledger.directives().size()) << text;
+    return string(status.message());
+  };
+  EXPECT_EQ("no directive", error("date { year: 2021 month: 1 day: 1 }"));
+  EXPECT_EQ("more than one directive",
+            error("date { year: 2021 month: 1 day: 1 } close {} note {}"));
+  EXPECT_EQ("missing date", error("close { account: \"Assets:Cash\" }"));
+  EXPECT_EQ("invalid date 2021-4-31",
+            error("date { year: 2021 month: 4 day: 31 } close {}"));
+  EXPECT_EQ("invalid currency 'usd'",
+            error("date { year: 2021 month: 1 day: 1 } "
+                  "commodity { currency: \"usd\" }"));
+  EXPECT_EQ("posting 1: flag '**' is not a single character",
+            error("date { year: 2021 month: 1 day: 1 } "
+                  "txn { postings {} postings { flag: \"**\" } }"));
+  EXPECT_NE(string::npos,
+            error("date { year: 2021 month: 1 day: 1 } price { currency: "
+                  "\"HOOL\" amount { number { strvalue: \"1.2.3\" } "
+                  "currency: \"USD\" } }")
+                .find("1.2.3"));
+}
+
+}  // namespace
+}  // namespace beanquick
@@ -0,0 +1,113 @@
+#include "directive.h"
+
+#include "gtest/gtest.h"
+
+namespace beanquick {
+namespace {
+#define D Decimal
+#define A Amount
+
+TEST(TestLedger, Accounts) {
+  Ledger ledger;
+  AccountId cash = ledger.InternAccount("Assets:Cash");
+  AccountId bank = ledger.InternAccount("Assets:Bank");
+  EXPECT_EQ(0, cash);
+  EXPECT_EQ(1, bank);
+  EXPECT_EQ(cash, ledger.InternAccount(string("Assets:Cash")));
+  EXPECT_EQ(2, ledger.num_accounts());
+  EXPECT_EQ("Assets:Bank", ledger.AccountName(bank));
+
+  AccountId id;
+  EXPECT_TRUE(ledger.FindAccount("Assets:Cash", &id));
+  EXPECT_EQ(cash, id);
+  EXPECT_FALSE(ledger.FindAccount("Assets:Card", &id));
+}
+
+TEST(TestLedger, Directives) {
+  Ledger ledger;
+  Open *open = ledger.Add<Open>(Date::FromDays(18262));
+  open->account = ledger.InternAccount("Assets:Cash");
+  CurrencyId usd = InternCurrency("USD");
+  open->currencies = ledger.NewArray<CurrencyId>(1);
+  const_cast<CurrencyId &>(open->currencies[0]) = usd;
+
+  Transaction *txn = ledger.Add<Transaction>(Date::FromDays(18263));
+  txn->flag = '*';
+  txn->narration = ledger.CopyString("Coffee");
+  absl::Span<Posting> postings = ledger.NewArray<Posting>(2);
+  postings[0].account = ledger.InternAccount("Expenses:Coffee");
+  ledger.SetAmount(&postings[0].units, A(D("3.50"), "USD"));
+  postings[1].account = open->account;
+  txn->postings = postings;
+
+  // Not appended until asked to.
+  Close *close = ledger.New<Close>(Date::FromDays(18264));
+  EXPECT_EQ(2, ledger.directives().size());
+  ledger.Append(close);
+
+  ASSERT_EQ(3, ledger.directives().size());
+  const Directive *first = ledger.directives()[0];
+  EXPECT_EQ(DirectiveType::kOpen, first->type);
+  EXPECT_EQ(18262, first->date.days());
+  EXPECT_EQ(nullptr, first->As<Transaction>());
+  ASSERT_NE(nullptr, first->As<Open>());
+  EXPECT_EQ(usd, first->As<Open>()->currencies[0]);
+
+  const Transaction *second = ledger.directives()[1]->As<Transaction>();
+  ASSERT_NE(nullptr, second);
+  EXPECT_EQ("Coffee", second->narration);
+  ASSERT_EQ(2, second->postings.size());
+  EXPECT_TRUE(second->postings[0].has_units());
+  EXPECT_FALSE(second->postings[0].has_price());
+  EXPECT_TRUE(second->postings[0].cost.empty());
+  EXPECT_EQ(A(D("3.50"), "USD"), second->postings[0].units);
+  EXPECT_FALSE(second->postings[1].has_units());
+  EXPECT_EQ(ledger.directives()[2], close);
+}
+
+TEST(TestLedger, BoxedNumbers) {
+  // Numbers which don't fit 64 bits own memory, freed with the ledger; run
+  // under a leak checker to see it.
+  Ledger ledger;
+  Balance *balance = ledger.Add<Balance>(Date());
+  D boxed("123456789012345678.123456789");
+  ASSERT_FALSE(boxed.IsCompact());
+  ledger.SetAmount(&balance->amount, A(boxed, "USD"));
+  ledger.SetNumber(&balance->tolerance, boxed);
+  // Set twice, the first one is freed by the assignment.
+  ledger.SetNumber(&balance->tolerance, boxed);
+  balance->has_tolerance = true;
+  EXPECT_EQ(boxed, balance->amount.Number());
+  EXPECT_EQ(boxed, balance->tolerance);
+}
+
+TEST(TestLedger, Splice) {
+  Ledger ledger;
+  ledger.Add<Open>(Date())->account = ledger.InternAccount("Assets:Cash");
+
+  std::unique_ptr<Ledger> other(new Ledger);
+  Pad *pad = other->Add<Pad>(Date::FromDays(1));
+  pad->account = other->InternAccount("Assets:Bank");
+  pad->source_account = other->InternAccount("Assets:Cash");
+  Transaction *txn = other->Add<Transaction>(Date::FromDays(2));
+  absl::Span<Posting> postings = other->NewArray<Posting>(1);
+  postings[0].account = other->InternAccount("Expenses:Food");
+  other->SetAmount(&postings[0].units, A(D("123456789012345678.1"), "USD"));
+  txn->postings = postings;
+
+  std::vector<AccountId> ids = ledger.InternAccounts(*other);
+  EXPECT_EQ(std::vector<AccountId>({1, 0, 2}), ids);
+  other->RemapAccounts(ids);
+  ledger.Splice(std::move(other));
+
+  ASSERT_EQ(3, ledger.directives().size());
+  EXPECT_EQ(3, ledger.num_accounts());
+  EXPECT_EQ(pad, ledger.directives()[1]);
+  EXPECT_EQ("Assets:Bank", ledger.AccountName(pad->account));
+  EXPECT_EQ("Assets:Cash", ledger.AccountName(pad->source_account));
+  EXPECT_EQ("Expenses:Food", ledger.AccountName(txn->postings[0].account));
+  EXPECT_EQ(A(D("123456789012345678.1"), "USD"), txn->postings[0].units);
+}
+
+}  // namespace
+}  // namespace beanquick
@@ -1,136 +1,229 @@
 #include "beanquick/core/display_context.h"
 
-#include "absl/functional/bind_front.h"
+#include <algorithm>
+#include <cstring>
 
 namespace beanquick {
 
-UMAPSS_PTR DisplayContext::build_natural(std::unique_ptr<DisplayConfig> config) {
-  auto fmtstrings = absl::make_unique<UMAPSS>();
-  // for (auto& [currency, ccontexts] : ccontexts_) { C++17 feature
-  for (auto& it : ccontexts_) {
-    string currency = it.first;
-    CurrencyContext ccontext = it.second;
-    int frac_num = ccontext.Fractional(config->precision);
-    string fmt_str;
-    // Construct "%.3f"
-    absl::StrAppend(&fmt_str, "%.");
-    absl::StrAppend(&fmt_str, std::to_string(frac_num));
-    absl::StrAppend(&fmt_str, "f");
-    fmtstrings->insert({currency, fmt_str});
-  }
-  return fmtstrings;
+namespace {
+bool SameConfig(const DisplayConfig& lhs, const DisplayConfig& rhs) {
+  return lhs.noinit == rhs.noinit && lhs.reserved == rhs.reserved &&
+         lhs.comma_position == rhs.comma_position &&
+         lhs.alignment == rhs.alignment && lhs.precision == rhs.precision;
 }
+}  // namespace
 
-UMAPSS_PTR DisplayContext::build_right(std::unique_ptr<DisplayConfig> config) {
-  auto fmtstrings = absl::make_unique<UMAPSS>();
-  int max_width = 0;
-  for (auto& it : ccontexts_) {
-    string currency = it.first;
-    CurrencyContext ccontext = it.second;
-    int curr_num = 0;
-    if (ccontext.HasSign()) {
-      curr_num += 1;
-    }
-    int frac_num = ccontext.Fractional(config->precision);
-    curr_num += (frac_num > 0 ? 1 : 0);  // period
-    curr_num += frac_num;
-    int integer_num = ccontext.Integer();
-    curr_num += (integer_num - 1) / 3 + integer_num;
-    curr_num += config->reserved;  // reserved
-    max_width = std::max(max_width, curr_num);
-  }
-  // Compute the format string
-  for (auto& it : ccontexts_) {
-    string currency = it.first;
-    CurrencyContext ccontext = it.second;
-    int frac_num = ccontext.Fractional(config->precision);
-    string fmt_str;
-    // Construct "%12.6f"
-    absl::StrAppend(&fmt_str, "%");
-    absl::StrAppend(&fmt_str, std::to_string(max_width));
-    absl::StrAppend(&fmt_str, ".");
-    absl::StrAppend(&fmt_str, std::to_string(frac_num));
-    absl::StrAppend(&fmt_str, "f");
-    fmtstrings->insert({currency, fmt_str});
-  }
-  return fmtstrings;
+constexpr int8 FormatPlan::kUnseen;
+
+CurrencyId DisplayContext::DefaultCurrency() {
+  static const CurrencyId id = InternCurrency(kDefulatCurrency);
+  return id;
 }
 
-UMAPSS_PTR DisplayContext::build_dot(std::unique_ptr<DisplayConfig> config) {
-  int max_sign = 0;
-  int max_integer = 0;
-  int max_width = 0;
-  int max_frac = -1;
-  for (auto& it : ccontexts_) {
-    string currency = it.first;
-    CurrencyContext ccontext = it.second;
-    if (ccontext.HasSign()) {
-      max_sign = 1;
-    }
-    int integer_num = ccontext.Integer();
-    if (config->comma_position != kDefulatNoComma) {
-      integer_num += (integer_num - 1) / config->comma_position;
+int DisplayContext::Fractional(const string& currency,
+                               DisplayPrecision precision) const {
+  CurrencyId id;
+  if (!CurrencyTable::Global().Find(currency, &id)) {
+    return -1;
+  }
+  return Fractional(id, precision);
+}
+
+DisplayContext::Columns DisplayContext::ColumnsOf(
+    const CurrencyContext& ccontext) const {
+  const DisplayConfig& config = plan_->config;
+  Columns columns;
+  columns.sign = ccontext.HasSign() ? 1 : 0;
+  columns.integer = ccontext.Integer();
+  if (config.comma_position != kDefulatNoComma) {
+    columns.integer += (columns.integer - 1) / config.comma_position;
+  }
+  if (config.alignment != DisplayAlignment::NATURAL) {
+    int frac_num = ccontext.Fractional(config.precision);
+    columns.fraction = frac_num + (frac_num > 0 ? 1 : 0);  // period
+  }
+  return columns;
+}
+
+void DisplayContext::Merge(const DisplayContext& other) {
+  for (CurrencyId id : other.currencies_) {
+    Context(id).Merge(other.ccontexts_[id]);
+    Invalidate(id);
+  }
+  if (comma_position_ == kDefulatNoComma) {
+    comma_position_ = other.comma_position_;
+  }
+}
+
+void DisplayContext::Refresh() {
+  FormatPlan& plan = *plan_;
+  const DisplayConfig& config = plan.config;
+  plan.precision.resize(ccontexts_.size(), FormatPlan::kUnseen);
+  columns_.resize(ccontexts_.size());
+  // The widths are maxima over the currencies, which only need a rescan when
+  // the columns of one of them shrink; a most common precision can drop.
+  bool rescan = false;
+  for (CurrencyId id : dirty_) {
+    states_[id] = kClean;
+    const CurrencyContext& ccontext = ccontexts_[id];
+    // Numbers of a currency never seen are rendered as written.
+    plan.precision[id] =
+        ccontext.Empty() ? -1 : ccontext.Fractional(config.precision);
+    Columns old = columns_[id];
+    Columns columns = ColumnsOf(ccontext);
+    columns_[id] = columns;
+    rescan = rescan || columns.sign < old.sign ||
+             columns.integer < old.integer || columns.fraction < old.fraction;
+    max_columns_.sign = std::max(max_columns_.sign, columns.sign);
+    max_columns_.integer = std::max(max_columns_.integer, columns.integer);
+    max_columns_.fraction = std::max(max_columns_.fraction, columns.fraction);
+    max_total_ = std::max(max_total_,
+                          columns.sign + columns.integer + columns.fraction);
+  }
+  dirty_.clear();
+  if (rescan) {
+    max_columns_ = Columns();
+    max_total_ = 0;
+    for (CurrencyId id : currencies_) {
+      const Columns& columns = columns_[id];
+      max_columns_.sign = std::max(max_columns_.sign, columns.sign);
+      max_columns_.integer = std::max(max_columns_.integer, columns.integer);
+      max_columns_.fraction =
+          std::max(max_columns_.fraction, columns.fraction);
+      max_total_ = std::max(
+          max_total_, columns.sign + columns.integer + columns.fraction);
     }
-    max_integer = std::max(max_integer, integer_num);
-    int frac_num = ccontext.Fractional(config->precision);
-    max_frac = std::max(max_frac, frac_num + (frac_num > 0));
-  }
-  if (max_frac == -1) {
-    max_frac = kDefaultUninitPrecision;
-  }
-  max_width = std::max(max_sign + max_integer + max_frac, max_width);
-  // Compute the format string for each currency.
-  auto fmtstrings = absl::make_unique<UMAPSS>();
-  for (auto& it : ccontexts_) {
-    string currency = it.first;
-    CurrencyContext ccontext = it.second;
-    // Construct "%{max_width}.{max_frac}"
-    string fmt_str;
-    absl::StrAppend(&fmt_str, "%");
-    absl::StrAppend(&fmt_str, std::to_string(max_width));
-    absl::StrAppend(&fmt_str, ".");
-    absl::StrAppend(&fmt_str, std::to_string(max_frac));
-    absl::StrAppend(&fmt_str, "f");
-    fmtstrings->insert({currency, fmt_str});
-  }
-  return fmtstrings;
+  }
+
+  if (config.alignment == DisplayAlignment::RIGHT) {
+    // Right align every currency to the widest one.
+    plan.width = max_total_ + config.reserved;
+  }
+  else if (config.alignment == DisplayAlignment::DOT) {
+    // Pad the fractions of each currency to the longest one, so that the
+    // points line up, and right align the rest.
+    plan.width =
+        max_columns_.sign + max_columns_.integer + max_columns_.fraction;
+    plan.fraction_width = max_columns_.fraction;
+  }
 }
 
-inline DisplayFormatter DisplayContext::Build(DisplayConfig config) {
+DisplayFormatter DisplayContext::Build(DisplayConfig config) {
   if (!config.comma_position) {
     config.comma_position = comma_position_;
   }
-  if (config.alignment == DisplayAlignment::NATURAL) {
-    build_method_ =
-        absl::bind_front(&DisplayContext::build_natural, this);
+  if (config.alignment != DisplayAlignment::NATURAL &&
+      config.alignment != DisplayAlignment::RIGHT &&
+      config.alignment != DisplayAlignment::DOT) {
+    LOG(FATAL) << "Unknown alignment: " << int(config.alignment);
   }
-  else if (config.alignment == DisplayAlignment::RIGHT) {
-    build_method_ = absl::bind_front(&DisplayContext::build_right, this);
+  if (plan_ == nullptr || !SameConfig(plan_->config, config)) {
+    // Start over.
+    plan_ = std::make_shared<FormatPlan>();
+    plan_->config = config;
+    columns_.assign(ccontexts_.size(), Columns());
+    max_columns_ = Columns();
+    max_total_ = 0;
+    for (CurrencyId id : currencies_) {
+      Invalidate(id);
+    }
   }
-  else if (config.alignment == DisplayAlignment::DOT) {
-    build_method_ = absl::bind_front(&DisplayContext::build_dot, this);
+  else if (dirty_.empty()) {
+    return DisplayFormatter(plan_);
   }
-  else {
-    LOG(FATAL) << "Unknown alignment: " << int(config.alignment);
+  else if (plan_.use_count() > 1) {
+    // Formatters handed out before keep the plan they were built with.
+    plan_ = std::make_shared<FormatPlan>(*plan_);
   }
-  // TODO(zq7): looks ugly I would say.
-  auto umass_ptr = build_method_(absl::make_unique<DisplayConfig>(config));
-  return DisplayFormatter(absl::make_unique<DisplayConfig>(config),
-                          std::move(umass_ptr));
+  Refresh();
+  return DisplayFormatter(plan_);
 }
 
-template <>
-string DisplayFormatter::Format(const Decimal& number, const string& currency) {
-  if (dconfig_->comma_position == 0) {
-    CHECK(fmtstrings_->count(currency)) << "Not find currency: " << currency;
-    ::testing::internal::CaptureStdout();
-    printf(fmtstrings_->find(currency)->second.c_str(), number);
-    return ::testing::internal::GetCapturedStdout();
+void QuantizeAll(absl::Span<Amount> amounts, const DisplayContext& dcontext,
+                 DisplayPrecision precision, Rounding::Mode mode) {
+  // Postings come in runs of the same currency, only look it up on changes.
+  CurrencyId currency = 0;
+  int scale = -1;
+  bool first = true;
+  for (Amount& amount : amounts) {
+    if (first || amount.currency_id() != currency) {
+      first = false;
+      currency = amount.currency_id();
+      scale = dcontext.Fractional(currency, precision);
+    }
+    if (scale >= 0) amount.Quantize(scale, mode);
+  }
+}
+
+namespace {
+// Inserts a comma between each `group` integer digits of the number in
+// [buf, end), in place. Thousands go through Decimal::FormatGroupedTo().
+char* InsertCommas(char* buf, char* end, int group) {
+  char* begin = *buf == '-' || *buf == '+' ? buf + 1 : buf;
+  char* point = std::find(begin, end, '.');
+  int digits = static_cast<int>(point - begin);
+  int commas = (digits - 1) / group;
+  if (commas <= 0) return end;
+  // Move the fraction, then the digits from the last group backward.
+  std::memmove(point + commas, point, end - point);
+  char* dst = point + commas;
+  char* src = point;
+  for (int i = 0; src > begin; i++) {
+    if (i > 0 && i % group == 0) *--dst = ',';
+    *--dst = *--src;
+  }
+  return end + commas;
+}
+}  // namespace
+
+void DisplayFormatter::AppendTo(const Decimal& number, const string& currency,
+                                string* out) const {
+  CurrencyId id;
+  CHECK(CurrencyTable::Global().Find(currency, &id))
+      << "Not find currency: " << currency;
+  AppendTo(number, id, out);
+}
+
+void DisplayFormatter::AppendTo(const Decimal& number, CurrencyId currency,
+                                string* out) const {
+  const FormatPlan& plan = *plan_;
+  CHECK(currency < plan.precision.size() &&
+        plan.precision[currency] != FormatPlan::kUnseen)
+      << "Not find currency: " << CurrencyName(currency);
+  int precision = plan.precision[currency];
+
+  const Decimal* value = &number;
+  Decimal rounded;
+  if (precision >= 0 && precision != number.Fractional()) {
+    rounded = number;
+    rounded.Quantize(precision, Rounding::Mode::TO_NEAREST_HALF_TO_EVEN);
+    value = &rounded;
+  }
+  // Room for a separator between every two digits.
+  char buf[2 * Decimal::kMaxFormattedSize];
+  char* end;
+  int comma_position = plan.config.comma_position;
+  if (comma_position == 0) {
+    end = value->FormatTo(buf);
+  }
+  else if (comma_position == 3) {
+    end = value->FormatGroupedTo(buf);
   }
   else {
-    // Print with comma_position
-    return "TODO";
+    end = InsertCommas(buf, value->FormatTo(buf), comma_position);
+  }
+  int length = static_cast<int>(end - buf);
+
+  int fraction_pad = 0;
+  if (plan.fraction_width > 0) {
+    char* point = std::find(buf, end, '.');
+    fraction_pad =
+        std::max(0, plan.fraction_width - static_cast<int>(end - point));
   }
+  int left_pad = std::max(0, plan.width - length - fraction_pad);
+  out->append(left_pad, ' ');
+  out->append(buf, length);
+  out->append(fraction_pad, ' ');
 }
 
 //
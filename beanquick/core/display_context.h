@@ -1,23 +1,30 @@
 #ifndef DEANQUICK_DISPLAY_CONTEXT_H_
 #define DEANQUICK_DISPLAY_CONTEXT_H_
 
-#include "absl/memory/memory.h"
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "beanquick/core/amount.h"
+#include "beanquick/core/currency.h"
 #include "beanquick/core/logging.h"
-#include "gmock/gmock.h"
 
 namespace beanquick {
 
 // -----------------------------------------------------------------------------
 // Distribution Definition.
 // -----------------------------------------------------------------------------
-template <class T>
+// Counts values of T. With kLimit > 0, T is an integer type whose values are
+// in [0, kLimit], and the counts live in an array instead of a hash map.
+template <class T, int kLimit = 0, bool kBounded = (kLimit > 0)>
 class Distribution {
  public:
   Distribution() {}
 
-  bool Empty() { return hist_.empty(); }
+  bool Empty() const { return hist_.empty(); }
 
   void Update(T value) {
     if (Empty()) {
@@ -28,22 +35,46 @@ class Distribution {
       min_ = std::min(value, min_);
       max_ = std::max(value, max_);
     }
-    hist_[value]++;
-    int count = hist_[value];
-    if (count >= mode_.first) {
-      mode_.first = hist_[value];
+    int count = ++hist_[value];
+    if (count > mode_.first ||
+        (count == mode_.first && mode_.second < value)) {
+      mode_.first = count;
       mode_.second = value;
     }
   }
 
+  // Adds the counts of `other` to this distribution.
+  void Merge(const Distribution& other) {
+    if (other.Empty()) {
+      return;
+    }
+    if (Empty()) {
+      *this = other;
+      return;
+    }
+    min_ = std::min(other.min_, min_);
+    max_ = std::max(other.max_, max_);
+    for (const auto& it : other.hist_) {
+      hist_[it.first] += it.second;
+    }
+    mode_.first = 0;
+    for (const auto& it : hist_) {
+      if (it.second > mode_.first ||
+          (it.second == mode_.first && mode_.second < it.first)) {
+        mode_ = {it.second, it.first};
+      }
+    }
+  }
+
   // Returns the std::min value in this distribution.
-  T Min() { return min_; };
+  T Min() const { return min_; };
 
   // Returns the std::max value in this distribution
-  T Max() { return max_; }
+  T Max() const { return max_; }
 
-  // Returns the the most counted value.
-  T Mode() { return mode_.second; }
+  // Returns the the most counted value, the largest one on ties, so that it
+  // doesn't depend on the order of the updates.
+  T Mode() const { return mode_.second; }
 
  private:
   T min_;
@@ -52,6 +83,65 @@ class Distribution {
   std::pair<int, T> mode_;
 };
 
+template <class T, int kLimit>
+class Distribution<T, kLimit, true> {
+ public:
+  Distribution() {}
+
+  bool Empty() const { return total_ == 0; }
+
+  void Update(T value) {
+    DCHECK_GE(value, 0);
+    DCHECK_LE(value, kLimit);
+    if (Empty()) {
+      min_ = max_ = value;
+    }
+    else {
+      min_ = std::min(value, min_);
+      max_ = std::max(value, max_);
+    }
+    total_++;
+    int count = ++hist_[value];
+    if (count > hist_[mode_] || (count == hist_[mode_] && mode_ < value)) {
+      mode_ = value;
+    }
+  }
+
+  // Adds the counts of `other` to this distribution.
+  void Merge(const Distribution& other) {
+    if (other.Empty()) {
+      return;
+    }
+    if (Empty()) {
+      *this = other;
+      return;
+    }
+    min_ = std::min(other.min_, min_);
+    max_ = std::max(other.max_, max_);
+    total_ += other.total_;
+    mode_ = 0;
+    for (int i = 0; i <= kLimit; i++) {
+      hist_[i] += other.hist_[i];
+      if (hist_[i] >= hist_[mode_]) {
+        mode_ = static_cast<T>(i);
+      }
+    }
+  }
+
+  T Min() const { return min_; };
+
+  T Max() const { return max_; }
+
+  T Mode() const { return mode_; }
+
+ private:
+  T min_ = 0;
+  T max_ = 0;
+  T mode_ = 0;
+  int total_ = 0;
+  int hist_[kLimit + 1] = {};
+};
+
 //
 // -----------------------------------------------------------------------------
 // CurrencyContext Definition.
@@ -74,19 +164,35 @@ class CurrencyContext {
  public:
   CurrencyContext() {};
 
-  // Use a decial to update this context.
-  void Update(const Decimal& decimal) {
-    has_sign_ = decimal.HasSign();
+  // Use a decial to update this context. Returns whether the sign, integer
+  // digits or fractional digits it reports changed.
+  bool Update(const Decimal& decimal) {
+    bool changed = Empty() || (decimal.HasSign() && !has_sign_) ||
+                   decimal.Integer() > integer_max_;
+    int mode = frac_dist_.Mode();
+    int max = frac_dist_.Max();
+    has_sign_ = has_sign_ || decimal.HasSign();
     frac_dist_.Update(decimal.Fractional());
     integer_max_ = std::max(decimal.Integer(), integer_max_);
+    return changed || mode != frac_dist_.Mode() || max != frac_dist_.Max();
+  }
+
+  // Folds in the numbers `other` was updated with.
+  void Merge(const CurrencyContext& other) {
+    has_sign_ = has_sign_ || other.has_sign_;
+    frac_dist_.Merge(other.frac_dist_);
+    integer_max_ = std::max(other.integer_max_, integer_max_);
   }
 
   // Whether this context has signed currency.
-  bool HasSign() { return has_sign_; }
+  bool HasSign() const { return has_sign_; }
+
+  // Whether no number was seen for this currency.
+  bool Empty() const { return frac_dist_.Empty(); }
 
-  int Integer() { return integer_max_; }
+  int Integer() const { return integer_max_; }
 
-  int Fractional(DisplayPrecision precision) {
+  int Fractional(DisplayPrecision precision) const {
     if (frac_dist_.Empty()) {
       return 0;
     }
@@ -102,8 +208,7 @@ class CurrencyContext {
     }
   }
 
-  void DebugPrint() {
-    string fmt = "sign=%d integer_max=%d frac_common=%d frac_max=%d %s %s";
+  void DebugPrint(std::ostream& os = std::cout) const {
     string example;
     if (has_sign_) {
       absl::StrAppend(&example, "-");
@@ -124,8 +229,10 @@ class CurrencyContext {
       absl::StrAppend(&example_max, string(frac_max, '0'));
     }
 
-    printf(fmt.c_str(), has_sign_, integer_max_, frac_dist_.Mode(),
-           frac_dist_.Max(), example_common.c_str(), example_max.c_str());
+    os << "sign=" << has_sign_ << " integer_max=" << integer_max_
+       << " frac_common=" << frac_dist_.Mode()
+       << " frac_max=" << frac_dist_.Max() << " " << example_common << " "
+       << example_max;
   }
 
  private:
@@ -137,7 +244,7 @@ class CurrencyContext {
   int integer_max_ = 1;
 
   // A frequency distribution of fractionals seen for this currency.
-  Distribution<int> frac_dist_;
+  Distribution<int, Decimal::kMaxScale> frac_dist_;
 };
 
 //
@@ -148,11 +255,29 @@ class CurrencyContext {
 struct DisplayConfig {
   bool noinit = true;
   int reserved = 0;
-  int comma_position = 3;
+  // Digits between thousands separators, 0 for none, which lets
+  // DisplayContext::SetCommaPosition() decide.
+  int comma_position = 0;
   DisplayAlignment alignment = DisplayAlignment::NATURAL;
   DisplayPrecision precision = DisplayPrecision::MOST_COMMON;
 };
 
+// What DisplayContext::Build() works out for a DisplayConfig, shared by the
+// formatters built from it. Numbers are padded with spaces on the left to
+// `width`, and their point and fractional digits on the right to
+// `fraction_width`, which lines up the points of a column.
+struct FormatPlan {
+  // The precision of currencies the context has never seen.
+  static constexpr int8 kUnseen = -2;
+
+  DisplayConfig config;
+  int width = 0;
+  int fraction_width = 0;
+  // Fractional digits to round to by CurrencyId, -1 to keep those of the
+  // number.
+  std::vector<int8> precision;
+};
+
 class DisplayFormatter;
 
 //
@@ -162,11 +287,12 @@ class DisplayFormatter;
 // config.alignment = DisplayAlignment::RIGHT;
 // dcontext.Build(config);
 //
+// Build() keeps the plan it made. As long as the config stays the same, the
+// next Build() only redoes the currencies whose context Update() changed
+// since, and hands out the same plan if there are none.
 class DisplayContext {
  public:
-  DisplayContext() { ccontexts_[kDefulatCurrency] = CurrencyContext(); }
-
-  const int kDefaultUninitPrecision = 8;
+  DisplayContext() { Context(DefaultCurrency()); }
 
   const int kDefulatNoComma = 0;
 
@@ -178,66 +304,141 @@ class DisplayContext {
     comma_position_ = comma_position;
   }
 
-  void Update(const Decimal& decimal) {
-    ccontexts_[kDefulatCurrency].Update(decimal);
-  }
+  void Update(const Decimal& decimal) { Update(decimal, DefaultCurrency()); }
 
   void Update(const Amount& amout) {
-    ccontexts_[amout.Currency()].Update(amout.Number());
+    Update(amout.Number(), amout.currency_id());
   }
 
-  // string Quantize(string number, );
+  void Update(const Decimal& number, CurrencyId currency) {
+    if (Context(currency).Update(number)) {
+      Invalidate(currency);
+    }
+  }
+
+  // Folds in the amounts `other` was updated with. Not thread safe, but
+  // threads can each update a context of their own and merge them at the
+  // end. The comma position of this context is kept unless it has none.
+  void Merge(const DisplayContext& other);
+
+  // The fractional digits `precision` picks for `currency`, -1 when no
+  // amount of it was seen.
+  int Fractional(CurrencyId currency, DisplayPrecision precision) const {
+    if (currency >= states_.size() || states_[currency] == kAbsent) {
+      return -1;
+    }
+    return ccontexts_[currency].Fractional(precision);
+  }
+
+  int Fractional(const string& currency, DisplayPrecision precision) const;
 
   DisplayFormatter Build(DisplayConfig config = kDefaultConfig);
 
+  // The id of kDefulatCurrency.
+  static CurrencyId DefaultCurrency();
+
  private:
-  UMAPSS_PTR build_dot(const DisplayConfig& config);
+  enum State : uint8 { kAbsent, kClean, kDirty };
+
+  // The columns the numbers of a currency take under the config of plan_.
+  struct Columns {
+    int sign = 0;
+    int integer = 0;
+    // The point and fractional digits.
+    int fraction = 0;
+  };
+
+  // Returns the context of `currency`, adding it if needed.
+  CurrencyContext& Context(CurrencyId currency) {
+    if (currency >= states_.size()) {
+      states_.resize(currency + 1, kAbsent);
+      ccontexts_.resize(currency + 1);
+    }
+    if (states_[currency] == kAbsent) {
+      states_[currency] = kClean;
+      currencies_.push_back(currency);
+      Invalidate(currency);
+    }
+    return ccontexts_[currency];
+  }
 
-  UMAPSS_PTR build_right(const DisplayConfig& config);
+  void Invalidate(CurrencyId currency) {
+    if (states_[currency] == kClean) {
+      states_[currency] = kDirty;
+      dirty_.push_back(currency);
+    }
+  }
 
-  UMAPSS_PTR build_natural(const DisplayConfig& config);
+  // Brings plan_ up to date with the dirty currencies.
+  void Refresh();
+
+  Columns ColumnsOf(const CurrencyContext& ccontext) const;
 
   int comma_position_ = kDefulatNoComma;
 
-  std::unordered_map<string, CurrencyContext> ccontexts_;
+  // By CurrencyId.
+  std::vector<CurrencyContext> ccontexts_;
+  std::vector<State> states_;
+
+  // The currencies with a context, in first-seen order, and those which
+  // changed since the last Build().
+  std::vector<CurrencyId> currencies_;
+  std::vector<CurrencyId> dirty_;
 
-  std::function<UMAPSS_PTR(const DisplayConfig&)> build_method_;
+  std::shared_ptr<FormatPlan> plan_;
+  // By CurrencyId, and their maxima over the currencies.
+  std::vector<Columns> columns_;
+  Columns max_columns_;
+  int max_total_ = 0;
 };
 
+// Rounds each amount to the fractional digits inferred for its currency by
+// `dcontext`, in place and without going through strings. Amounts of
+// currencies `dcontext` hasn't seen are left as they are.
+void QuantizeAll(
+    absl::Span<Amount> amounts, const DisplayContext& dcontext,
+    DisplayPrecision precision = DisplayPrecision::MOST_COMMON,
+    Rounding::Mode mode = Rounding::Mode::TO_NEAREST_HALF_TO_EVEN);
+
 //
 // -----------------------------------------------------------------------------
 // DisplayFormatter Definition.
 // -----------------------------------------------------------------------------
+// Renders numbers with the precision and widths DisplayContext::Build()
+// worked out, straight into the output buffer. Cheap to copy.
 class DisplayFormatter {
  public:
-  explicit DisplayFormatter(std::unique_ptr<DisplayConfig> display_config,
-                            UMAPSS_PTR fmtstrings) {
-    dconfig_ = std::move(display_config);
-    fmtstrings_ = std::move(fmtstrings);
-  };
+  explicit DisplayFormatter(std::shared_ptr<const FormatPlan> plan)
+      : plan_(std::move(plan)) {}
+
+  string Format(
+      const Decimal& number,
+      const string& currency = DisplayContext::kDefulatCurrency) const {
+    string ret;
+    AppendTo(number, currency, &ret);
+    return ret;
+  }
 
-  template <class T>
-  string Format(const T& number,
-              const string& currency = DisplayContext::kDefulatCurrency) {
-    if (dconfig_->comma_position == 0) {
-      CHECK(fmtstrings_->count(currency)) << "Not find currency: " << currency;
-      ::testing::internal::CaptureStdout();
-      printf(fmtstrings_->find(currency)->second.c_str(), number);
-      return ::testing::internal::GetCapturedStdout();
-    }
-    else {
-      return "TODO";
-    }
+  string Format(const Decimal& number, CurrencyId currency) const {
+    string ret;
+    AppendTo(number, currency, &ret);
+    return ret;
   }
 
+  // Appends what Format() returns to `out`, without temporaries.
+  void AppendTo(const Decimal& number, CurrencyId currency,
+                string* out) const;
+
+  // Like above, looking `currency` up in the currency table first.
+  void AppendTo(const Decimal& number, const string& currency,
+                string* out) const;
+
+  const FormatPlan& plan() const { return *plan_; }
+
  private:
-  std::unique_ptr<DisplayConfig> dconfig_;
-  UMAPSS_PTR fmtstrings_;
+  std::shared_ptr<const FormatPlan> plan_;
 };
 
-template <>
-string DisplayFormatter::Format(const Decimal& number, const string& currency);
-
 }  // namespace beanquick
 
 #endif  // DEANQUICK_DISPLAY_CONTEXT_H_
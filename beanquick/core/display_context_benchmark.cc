@@ -0,0 +1,138 @@
+#include <thread>
+#include <vector>
+
+#include "beanquick/core/benchmark_util.h"
+#include "benchmark/benchmark.h"
+#include "display_context.h"
+
+namespace beanquick {
+namespace {
+
+// Rendering the amounts of a report, with the precision inferred from them.
+void BM_DisplayFormatterFormat(benchmark::State& state) {
+  std::vector<Amount> amounts = BenchmarkAmounts(GetValueMix(&state));
+  DisplayContext dcontext;
+  for (auto& a : amounts) dcontext.Update(a);
+  DisplayConfig config;
+  config.comma_position = 0;
+  DisplayFormatter formatter = dcontext.Build(config);
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    const Amount& a = amounts[i++ % kNumValues];
+    benchmark::DoNotOptimize(formatter.Format(a.Number(), a.currency_id()));
+  }
+}
+BENCHMARK(BM_DisplayFormatterFormat)->Apply(ValueMixes);
+
+// A report of one million amounts rendered into one buffer, which is kept
+// across iterations. Alignment is the benchmark argument.
+void BM_DisplayFormatterMillion(benchmark::State& state) {
+  constexpr int kAmounts = 1000 * 1000;
+  std::vector<Amount> amounts = BenchmarkAmounts(ValueMix::kLedger);
+  DisplayContext dcontext;
+  for (auto& a : amounts) dcontext.Update(a);
+  DisplayConfig config;
+  config.alignment = static_cast<DisplayAlignment>(state.range(0));
+  config.comma_position = static_cast<int>(state.range(1));
+  DisplayFormatter formatter = dcontext.Build(config);
+  string out;
+  int64 allocs = 0;
+  for (auto _ : state) {
+    out.clear();
+    int64 start = AllocationCount();
+    for (int i = 0; i < kAmounts; i++) {
+      const Amount& a = amounts[i % kNumValues];
+      formatter.AppendTo(a.Number(), a.currency_id(), &out);
+      out += '\n';
+    }
+    allocs += AllocationCount() - start;
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kAmounts);
+  state.counters["allocs/amount"] =
+      static_cast<double>(allocs) /
+      (static_cast<double>(state.iterations()) * kAmounts);
+}
+BENCHMARK(BM_DisplayFormatterMillion)
+    ->ArgNames({"align", "comma"})
+    ->ArgsProduct({{static_cast<int>(DisplayAlignment::NATURAL),
+                    static_cast<int>(DisplayAlignment::DOT),
+                    static_cast<int>(DisplayAlignment::RIGHT)},
+                   {0, 3}})
+    ->Unit(benchmark::kMillisecond);
+
+// A live report: a batch of 16 amounts comes in, then the formatter is
+// rebuilt. The number of currencies is the benchmark argument.
+void BM_DisplayContextRebuild(benchmark::State& state) {
+  const int num_currencies = static_cast<int>(state.range(0));
+  std::vector<Amount> amounts = BenchmarkAmounts(ValueMix::kLedger);
+  std::vector<Amount> batches;
+  for (int i = 0; i < kNumValues; i++) {
+    string currency = absl::StrCat("C", i % num_currencies);
+    batches.emplace_back(amounts[i].Number(), currency);
+  }
+  DisplayContext dcontext;
+  for (const auto& a : batches) dcontext.Update(a);
+  DisplayConfig config;
+  config.alignment = DisplayAlignment::DOT;
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    for (int j = 0; j < 16; j++) {
+      dcontext.Update(batches[i++ % kNumValues]);
+    }
+    benchmark::DoNotOptimize(dcontext.Build(config));
+  }
+}
+BENCHMARK(BM_DisplayContextRebuild)->ArgName("currencies")->Arg(10)->Arg(1000);
+
+// Inferring the display precision, one amount at a time.
+void BM_DisplayContextUpdate(benchmark::State& state) {
+  std::vector<Amount> amounts = BenchmarkAmounts(GetValueMix(&state));
+  DisplayContext dcontext;
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    dcontext.Update(amounts[i++ % kNumValues]);
+  }
+  benchmark::DoNotOptimize(&dcontext);
+}
+BENCHMARK(BM_DisplayContextUpdate)->Apply(ValueMixes);
+
+// One million amounts split over as many threads as the benchmark argument,
+// each updating a context of its own, merged once they are done.
+void BM_DisplayContextParallelUpdate(benchmark::State& state) {
+  constexpr int kAmounts = 1000 * 1000;
+  std::vector<Amount> amounts = BenchmarkAmounts(ValueMix::kLedger);
+  const int num_threads = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    std::vector<DisplayContext> contexts(num_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t]() {
+        for (int i = t; i < kAmounts; i += num_threads) {
+          contexts[t].Update(amounts[i % kNumValues]);
+        }
+      });
+    }
+    DisplayContext dcontext;
+    for (int t = 0; t < num_threads; t++) {
+      threads[t].join();
+      dcontext.Merge(contexts[t]);
+    }
+    benchmark::DoNotOptimize(&dcontext);
+  }
+  state.SetItemsProcessed(state.iterations() * kAmounts);
+}
+BENCHMARK(BM_DisplayContextParallelUpdate)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace beanquick
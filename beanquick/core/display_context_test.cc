@@ -1,9 +1,12 @@
 #include "display_context.h"
 
+#include <random>
+
 #include "absl/strings/str_split.h"
 #include "beanquick/core/amount.h"
 #include "beanquick/core/decimal.h"
 #include "absl/types/variant.h"
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
 
@@ -32,6 +35,63 @@ TEST(TestInt, DistributionTest) {
   EXPECT_TRUE(!dist.Empty());
 }
 
+TEST(TestInt, BoundedDistributionTest) {
+  Distribution<int, 14> dist;
+  EXPECT_TRUE(dist.Empty());
+  for (int value : {1, 1, 2, 2, 2, 3, 3, 4}) {
+    dist.Update(value);
+  }
+  EXPECT_EQ(2, dist.Mode());
+  EXPECT_EQ(1, dist.Min());
+  EXPECT_EQ(4, dist.Max());
+  EXPECT_TRUE(!dist.Empty());
+
+  // The largest value wins ties, whatever the order of the updates.
+  dist.Update(0);
+  dist.Update(0);
+  dist.Update(0);
+  EXPECT_EQ(2, dist.Mode());
+  dist.Update(14);
+  dist.Update(14);
+  dist.Update(14);
+  EXPECT_EQ(14, dist.Mode());
+  EXPECT_EQ(14, dist.Max());
+  EXPECT_EQ(0, dist.Min());
+}
+
+TEST(TestInt, DistributionMergeTest) {
+  Distribution<int> dist, other;
+  Distribution<int, 14> bounded, bounded_other;
+  for (int value : {2, 2, 5}) {
+    dist.Update(value);
+    bounded.Update(value);
+  }
+  dist.Merge(Distribution<int>());
+  bounded.Merge(Distribution<int, 14>());
+  EXPECT_EQ(2, dist.Mode());
+  EXPECT_EQ(2, bounded.Mode());
+
+  for (int value : {0, 5, 5, 3}) {
+    other.Update(value);
+    bounded_other.Update(value);
+  }
+  dist.Merge(other);
+  bounded.Merge(bounded_other);
+  // 5 is counted thrice.
+  EXPECT_EQ(5, dist.Mode());
+  EXPECT_EQ(0, dist.Min());
+  EXPECT_EQ(5, dist.Max());
+  EXPECT_EQ(5, bounded.Mode());
+  EXPECT_EQ(0, bounded.Min());
+  EXPECT_EQ(5, bounded.Max());
+
+  // Into an empty one.
+  Distribution<int, 14> empty;
+  empty.Merge(bounded);
+  EXPECT_EQ(5, empty.Mode());
+  EXPECT_EQ(0, empty.Min());
+}
+
 // -----------------------------------------------------------------------------
 // CurrencyContextTest
 // -----------------------------------------------------------------------------
@@ -75,6 +135,130 @@ TEST(TestHasSign, CurrencyContextTest) {
       "sign=1 integer_max=5 frac_common=3 frac_max=6 -00000.000 -00000.000000");
 }
 
+TEST(TestQuantizeAll, DisplayContextTest) {
+  DisplayContext dcontext;
+  dcontext.Update(A(D("1.25"), "USD"));
+  dcontext.Update(A(D("10.50"), "USD"));
+  dcontext.Update(A(D("0.12345678"), "BTC"));
+
+  std::vector<Amount> amounts = {
+      A(D("3.14159"), "USD"), A(D("-2.005"), "USD"), A(D("7"), "USD"),
+      A(D("1.123456789"), "BTC"), A(D("1.23456"), "CAD")};
+  QuantizeAll(absl::MakeSpan(amounts), dcontext);
+  EXPECT_EQ(amounts[0].ToString(), "3.14 USD");
+  EXPECT_EQ(amounts[1].ToString(), "-2.00 USD");
+  EXPECT_EQ(amounts[2].ToString(), "7.00 USD");
+  EXPECT_EQ(amounts[3].ToString(), "1.12345679 BTC");
+  // Never seen, left alone.
+  EXPECT_EQ(amounts[4].ToString(), "1.23456 CAD");
+
+  QuantizeAll(absl::MakeSpan(amounts), dcontext, DisplayPrecision::MAXIMUM,
+              Rounding::Mode::UP);
+  EXPECT_EQ(amounts[0].ToString(), "3.14 USD");
+}
+
+TEST(TestMerge, DisplayContextTest) {
+  std::vector<Amount> amounts = {
+      A(D("1.25"), "USD"),      A(D("-10.5"), "USD"), A(D("1234.567"), "USD"),
+      A(D("0.12345678"), "BTC"), A(D("3"), "BTC"),     A(D("7.00"), "USD"),
+      A(D("15.99"), "USD"),     A(D("2.1"), "CAD")};
+
+  DisplayContext whole;
+  for (const auto& amount : amounts) whole.Update(amount);
+
+  // Split over three contexts, as ingestion threads would.
+  DisplayContext parts[3];
+  for (size_t i = 0; i < amounts.size(); i++) {
+    parts[i % 3].Update(amounts[i]);
+  }
+  parts[2].SetCommaPosition(3);
+  DisplayContext merged;
+  for (const auto& part : parts) merged.Merge(part);
+
+  for (const char* currency : {"USD", "BTC", "CAD", "EUR"}) {
+    for (auto precision :
+         {DisplayPrecision::MOST_COMMON, DisplayPrecision::MAXIMUM}) {
+      EXPECT_EQ(whole.Fractional(currency, precision),
+                merged.Fractional(currency, precision))
+          << currency;
+    }
+  }
+
+  DisplayConfig config;
+  config.alignment = DisplayAlignment::RIGHT;
+  whole.SetCommaPosition(3);
+  DisplayFormatter expected = whole.Build(config);
+  DisplayFormatter actual = merged.Build(config);
+  for (const auto& amount : amounts) {
+    EXPECT_EQ(expected.Format(amount.Number(), amount.Currency()),
+              actual.Format(amount.Number(), amount.Currency()));
+  }
+  EXPECT_EQ("  1,234.57", actual.Format(D("1234.567"), "USD"));
+}
+
+TEST(TestIncrementalBuild, DisplayContextTest) {
+  DisplayContext dcontext;
+  dcontext.Update(A(D("1.25"), "USD"));
+  DisplayConfig config;
+  config.alignment = DisplayAlignment::RIGHT;
+  DisplayFormatter first = dcontext.Build(config);
+  EXPECT_EQ("3.14", first.Format(D("3.14159"), "USD"));
+
+  // Nothing changed, the plan is shared.
+  DisplayFormatter same = dcontext.Build(config);
+  EXPECT_EQ(&first.plan(), &same.plan());
+  dcontext.Update(A(D("2.50"), "USD"));
+  EXPECT_EQ(&first.plan(), &dcontext.Build(config).plan());
+
+  // The formatters built before keep their plan.
+  dcontext.Update(A(D("-100.125"), "USD"));
+  dcontext.Update(A(D("-100.125"), "USD"));
+  DisplayFormatter second = dcontext.Build(config);
+  EXPECT_NE(&first.plan(), &second.plan());
+  EXPECT_EQ("3.14", first.Format(D("3.14159"), "USD"));
+  EXPECT_EQ("   3.142", second.Format(D("3.14159"), "USD"));
+
+  // A currency seen after the first build.
+  dcontext.Update(A(D("0.5"), "CAD"));
+  DisplayFormatter third = dcontext.Build(config);
+  EXPECT_EQ("     0.5", third.Format(D("0.5"), "CAD"));
+}
+
+TEST(TestIncrementalBuildRandom, DisplayContextTest) {
+  const std::vector<string> numbers = {
+      "1",     "-2.5",   "30.25",  "0.125",     "4000.1", "5.00",
+      "-6.75", "70.5",   "0.0001", "123456.78", "9.99",   "10"};
+  const std::vector<string> currencies = {"USD", "CAD", "EUR", "BTC"};
+  std::vector<DisplayConfig> configs(3);
+  configs[1].alignment = DisplayAlignment::RIGHT;
+  configs[2].alignment = DisplayAlignment::DOT;
+  configs[2].comma_position = 3;
+
+  std::mt19937 rng(17);
+  DisplayContext incremental;
+  std::vector<Amount> seen;
+  for (int round = 0; round < 200; round++) {
+    for (int i = rng() % 4; i >= 0; i--) {
+      seen.push_back(A(D(numbers[rng() % numbers.size()]),
+                       currencies[rng() % currencies.size()]));
+      incremental.Update(seen.back());
+    }
+    // Keep to one config for a while, so that the plan gets patched.
+    const DisplayConfig& config = configs[round / 10 % configs.size()];
+    DisplayContext fresh;
+    for (const auto& amount : seen) fresh.Update(amount);
+    DisplayFormatter expected = fresh.Build(config);
+    DisplayFormatter actual = incremental.Build(config);
+    EXPECT_EQ(expected.plan().width, actual.plan().width);
+    EXPECT_EQ(expected.plan().fraction_width, actual.plan().fraction_width);
+    for (const auto& amount : seen) {
+      ASSERT_EQ(expected.Format(amount.Number(), amount.currency_id()),
+                actual.Format(amount.Number(), amount.currency_id()))
+          << round;
+    }
+  }
+}
+
 //
 // -----------------------------------------------------------------------------
 // DisplayContextTest
@@ -127,6 +311,64 @@ TEST_F(DisplayContextTest, TestNaturalUninitialized) {
                       {"1.2345", "764", "-7409.01", "0.00000125"});
 }
 
+TEST_F(DisplayContextTest, TestNaturalMostCommon) {
+  config_.noinit = false;
+  AssertFormatNumbers({"1.2345", "1.23", "234.26", "38.019"},
+                      {"1.23", "1.23", "234.26", "38.02"});
+}
+
+TEST_F(DisplayContextTest, TestNaturalMaximum) {
+  config_.noinit = false;
+  config_.precision = DisplayPrecision::MAXIMUM;
+  AssertFormatNumbers({"1.2345", "1.23", "234.26", "38.019"},
+                      {"1.2345", "1.2300", "234.2600", "38.0190"});
+}
+
+TEST_F(DisplayContextTest, TestDotMaximum) {
+  config_.noinit = false;
+  config_.alignment = DisplayAlignment::DOT;
+  config_.precision = DisplayPrecision::MAXIMUM;
+  AssertFormatNumbers({"7409.01", "0.1", "-12"},
+                      {" 7409.01", "    0.10", "  -12.00"});
+}
+
+TEST_F(DisplayContextTest, TestNaturalCommas) {
+  config_.comma_position = 3;
+  AssertFormatNumbers({"1.2345", "764", "-7409.01", "1234567890.5", "-999"},
+                      {"1.2345", "764", "-7,409.01", "1,234,567,890.5", "-999"});
+}
+
+TEST_F(DisplayContextTest, TestNaturalCommasOtherPosition) {
+  config_.comma_position = 4;
+  AssertFormatNumbers({"1234", "-12345.6", "123456789"},
+                      {"1234", "-1,2345.6", "1,2345,6789"});
+}
+
+TEST_F(DisplayContextTest, TestRightSign) {
+  config_.noinit = false;
+  config_.alignment = DisplayAlignment::RIGHT;
+  config_.precision = DisplayPrecision::MAXIMUM;
+  AssertFormatNumbers({"7409.01", "0.1"}, {"7409.01", "   0.10"});
+}
+
+TEST_F(DisplayContextTest, TestRightCommas) {
+  config_.noinit = false;
+  config_.alignment = DisplayAlignment::RIGHT;
+  config_.precision = DisplayPrecision::MAXIMUM;
+  config_.comma_position = 3;
+  AssertFormatNumbers({"1234567.01", "-0.1"},
+                      {" 1,234,567.01", "        -0.10"});
+}
+
+TEST_F(DisplayContextTest, TestDotCommas) {
+  config_.noinit = false;
+  config_.alignment = DisplayAlignment::DOT;
+  config_.precision = DisplayPrecision::MAXIMUM;
+  config_.comma_position = 3;
+  AssertFormatNumbers({"7409.015", "0.1", "-12"},
+                      {" 7,409.015", "     0.100", "   -12.000"});
+}
+
 // TEST_F(TestNaturalNoClearMode, DisplayContextTest) {
 //   AssertFormatNumbers(
 //       {"1.2345", "764", "-7409.01", "0.00000125"},
@@ -0,0 +1,465 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "beanquick/core/file_reader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && \
+    defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+// IORING_OP_READ is an enum value, so look for this flag, a macro, which
+// came with it in Linux 5.6. Older headers leave io_uring out.
+#ifdef IORING_FEAT_RW_CUR_POS
+#define BEANQUICK_HAVE_IO_URING 1
+#endif
+#endif
+#endif
+
+namespace beanquick {
+
+namespace {
+
+// The most asked of one read call, which Linux caps a little under 2 GiB.
+constexpr size_t kMaxReadSize = 1 << 30;
+
+absl::Status ErrnoError(absl::string_view what, const string &filename,
+                        int error) {
+  string message =
+      absl::StrCat(what, " ", filename, ": ", std::strerror(error));
+  if (error == ENOENT) return absl::NotFoundError(message);
+  return absl::InternalError(message);
+}
+
+// Opens `filename` and sizes its contents. Opening and sizing only take the
+// metadata, the reading of the data is what readers overlap.
+absl::Status OpenFile(const string &filename, int *fd,
+                      std::unique_ptr<FileContents> *contents) {
+  do {
+    *fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  } while (*fd < 0 && errno == EINTR);
+  if (*fd < 0) return ErrnoError("open", filename, errno);
+
+  struct stat st;
+  if (fstat(*fd, &st) != 0) {
+    absl::Status status = ErrnoError("stat", filename, errno);
+    close(*fd);
+    return status;
+  }
+  if (!S_ISREG(st.st_mode)) {
+    close(*fd);
+    return absl::InvalidArgumentError(
+        absl::StrCat(filename, " is not a regular file"));
+  }
+  contents->reset(new FileContents(filename, static_cast<size_t>(st.st_size)));
+  return absl::OkStatus();
+}
+
+// Reads the rest of `contents` from `fd` with blocking calls, from `offset`
+// on, and truncates it when the file turns out shorter.
+absl::Status PreadFrom(int fd, size_t offset, FileContents *contents) {
+  char *data = contents->data();
+  size_t size = contents->text().size();
+  while (offset < size) {
+    ssize_t n = pread(fd, data + offset, std::min(size - offset, kMaxReadSize),
+                      static_cast<off_t>(offset));
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0) return ErrnoError("read", contents->filename(), errno);
+    if (n == 0) {
+      contents->Truncate(offset);
+      break;
+    }
+    offset += static_cast<size_t>(n);
+  }
+  return absl::OkStatus();
+}
+
+// -----------------------------------------------------------------------------
+// PreadReader Implementation.
+// -----------------------------------------------------------------------------
+// Reads each file with blocking calls on a thread of the pool, so as many
+// are read at once as the pool has threads.
+class PreadReader : public FileReader {
+ public:
+  explicit PreadReader(ThreadPool *pool) : pool_(pool) {}
+
+  ~PreadReader() override {
+    // The reads left refer to this reader.
+    while (pending_ > 0) Wait();
+  }
+
+  void Start(int id, const string &filename) override {
+    pending_++;
+    pool_->Schedule([this, id, filename] {
+      Result result = Read(id, filename);
+      absl::MutexLock lock(&mu_);
+      done_.push_back(std::move(result));
+    });
+  }
+
+  std::vector<Result> Wait() override {
+    std::vector<Result> results;
+    if (pending_ == 0) return results;
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(this, &PreadReader::HasDone));
+    results.swap(done_);
+    pending_ -= static_cast<int>(results.size());
+    return results;
+  }
+
+  absl::string_view name() const override { return "pread"; }
+
+ private:
+  static Result Read(int id, const string &filename) {
+    Result result;
+    result.id = id;
+    int fd;
+    result.status = OpenFile(filename, &fd, &result.contents);
+    if (!result.status.ok()) return result;
+    result.status = PreadFrom(fd, 0, result.contents.get());
+    if (!result.status.ok()) result.contents.reset();
+    close(fd);
+    return result;
+  }
+
+  bool HasDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return !done_.empty();
+  }
+
+  ThreadPool *pool_;
+  // Started and not returned by Wait() yet.
+  int pending_ = 0;
+  absl::Mutex mu_;
+  std::vector<Result> done_ ABSL_GUARDED_BY(mu_);
+};
+
+#ifdef BEANQUICK_HAVE_IO_URING
+
+// -----------------------------------------------------------------------------
+// IoUringReader Implementation.
+// -----------------------------------------------------------------------------
+// Queues the reads of all started files in one io_uring, handed to the
+// kernel with one system call per Wait(). The ring is driven through the
+// raw system calls, which is little code for reads only and saves a
+// dependency on liburing.
+//
+// Should the kernel still reject the reads, or the ring fail, the files left
+// are read with pread() instead, blocking in Wait().
+class IoUringReader : public FileReader {
+ public:
+  // Returns nullptr when the kernel denies a ring, or is older than 5.6 and
+  // so can't read through it: rings of 5.1 to 5.5 take the entries, then
+  // fail every one with EINVAL.
+  static std::unique_ptr<IoUringReader> Create(int depth,
+                                               uint8 opcode = IORING_OP_READ) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+    if (fd < 0) return nullptr;
+    std::unique_ptr<IoUringReader> reader(new IoUringReader(fd, opcode));
+    if ((params.features & IORING_FEAT_RW_CUR_POS) == 0) return nullptr;
+    if (!reader->Map(params)) return nullptr;
+    return reader;
+  }
+
+  ~IoUringReader() override {
+    // The kernel may still be writing into buffers of reads in flight.
+    while (!reads_.empty() || !done_.empty()) Wait();
+    if (sqes_ != nullptr) munmap(sqes_, sqes_size_);
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd_);
+  }
+
+  void Start(int id, const string &filename) override {
+    std::unique_ptr<Read> read(new Read);
+    read->result.id = id;
+    read->result.status = OpenFile(filename, &read->fd, &read->result.contents);
+    if (!read->result.status.ok()) {
+      done_.push_back(std::move(read->result));
+      return;
+    }
+    if (read->result.contents->text().empty()) {
+      close(read->fd);
+      done_.push_back(std::move(read->result));
+      return;
+    }
+    queued_.push_back(read.get());
+    reads_.push_back(std::move(read));
+  }
+
+  std::vector<Result> Wait() override {
+    while (done_.empty() && !reads_.empty()) {
+      // Refill the ring from the queue, then wait for one completion, all
+      // in one call. Asking to submit the size of the ring submits all the
+      // entries queued in it, also when a call was interrupted before.
+      while (!queued_.empty() && (fallback_ || in_flight_ < entries_)) {
+        Read *read = queued_.front();
+        queued_.pop_front();
+        if (fallback_) {
+          ReadRest(read);
+        }
+        else {
+          Submit(read);
+        }
+      }
+      if (in_flight_ == 0) continue;
+      int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_,
+                                         entries_, 1, IORING_ENTER_GETEVENTS,
+                                         nullptr, 0));
+      if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        Abandon(errno);
+        continue;
+      }
+      // Also after EAGAIN or EBUSY, short of memory or of room for the
+      // completions, reaping some is what lets the next call through.
+      Reap();
+    }
+    std::vector<Result> results;
+    results.swap(done_);
+    return results;
+  }
+
+  absl::string_view name() const override { return "io_uring"; }
+
+ private:
+  // A file being read, in pieces of at most kMaxReadSize.
+  struct Read {
+    int fd = -1;
+    size_t offset = 0;
+    Result result;
+  };
+
+  IoUringReader(int ring_fd, uint8 opcode)
+      : ring_fd_(ring_fd), opcode_(opcode) {}
+
+  bool Map(const struct io_uring_params &params) {
+    entries_ = static_cast<int>(params.sq_entries);
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = MapRing(sq_ring_size_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == nullptr) return false;
+    cq_ring_ = single_mmap ? sq_ring_ : MapRing(cq_ring_size_,
+                                                IORING_OFF_CQ_RING);
+    if (cq_ring_ == nullptr) return false;
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = static_cast<struct io_uring_sqe *>(
+        MapRing(sqes_size_, IORING_OFF_SQES));
+    if (sqes_ == nullptr) return false;
+
+    char *sq = static_cast<char *>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    char *cq = static_cast<char *>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  void *MapRing(size_t size, off_t offset) {
+    void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+    return addr == MAP_FAILED ? nullptr : addr;
+  }
+
+  // Queues a read of the rest of `read`, taken by the next io_uring_enter.
+  void Submit(Read *read) {
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & sq_mask_;
+    struct io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    size_t size = read->result.contents->text().size();
+    sqe->opcode = opcode_;
+    sqe->fd = read->fd;
+    sqe->off = read->offset;
+    sqe->addr = reinterpret_cast<uint64>(read->result.contents->data() +
+                                         read->offset);
+    sqe->len = static_cast<uint32>(std::min(size - read->offset, kMaxReadSize));
+    sqe->user_data = reinterpret_cast<uint64>(read);
+    sq_array_[index] = index;
+    // The kernel must see the entry before the new tail.
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    in_flight_++;
+  }
+
+  // Handles the completions in the ring. Reads cut short go back in the
+  // queue for the rest.
+  void Reap() {
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+      const struct io_uring_cqe &cqe = cqes_[head & cq_mask_];
+      Read *read = reinterpret_cast<Read *>(cqe.user_data);
+      in_flight_--;
+      FileContents *contents = read->result.contents.get();
+      if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+        queued_.push_back(read);
+        continue;
+      }
+      if (cqe.res == -EINVAL) {
+        // The kernel doesn't take the reads after all, stop asking.
+        fallback_ = true;
+        ReadRest(read);
+        continue;
+      }
+      if (cqe.res < 0) {
+        read->result.status = ErrnoError("read", contents->filename(),
+                                         -cqe.res);
+        read->result.contents.reset();
+      }
+      else if (cqe.res == 0) {
+        contents->Truncate(read->offset);
+      }
+      else {
+        read->offset += static_cast<size_t>(cqe.res);
+        if (read->offset < contents->text().size()) {
+          queued_.push_back(read);
+          continue;
+        }
+      }
+      Finish(read);
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+
+  // Reads the rest of `read` with pread().
+  void ReadRest(Read *read) {
+    read->result.status =
+        PreadFrom(read->fd, read->offset, read->result.contents.get());
+    if (!read->result.status.ok()) read->result.contents.reset();
+    Finish(read);
+  }
+
+  // Gives up on the ring after io_uring_enter failed with `error`. The reads
+  // in flight fail, keeping their buffers, which the kernel may still write
+  // into, until the ring is closed. The queued ones fall back to pread().
+  void Abandon(int error) {
+    fallback_ = true;
+    std::vector<Read *> in_flight;
+    for (const std::unique_ptr<Read> &read : reads_) {
+      if (std::find(queued_.begin(), queued_.end(), read.get()) ==
+          queued_.end()) {
+        in_flight.push_back(read.get());
+      }
+    }
+    for (Read *read : in_flight) {
+      abandoned_.push_back(std::move(read->result.contents));
+      read->result.status = absl::InternalError(
+          absl::StrCat("io_uring_enter: ", std::strerror(error)));
+      Finish(read);
+    }
+    in_flight_ = 0;
+  }
+
+  void Finish(Read *read) {
+    close(read->fd);
+    done_.push_back(std::move(read->result));
+    for (auto it = reads_.begin(); it != reads_.end(); ++it) {
+      if (it->get() == read) {
+        std::swap(*it, reads_.back());
+        reads_.pop_back();
+        break;
+      }
+    }
+  }
+
+  int ring_fd_;
+  uint8 opcode_;
+  int entries_ = 0;
+  void *sq_ring_ = nullptr;
+  void *cq_ring_ = nullptr;
+  struct io_uring_sqe *sqes_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  size_t cq_ring_size_ = 0;
+  size_t sqes_size_ = 0;
+  unsigned *sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned *sq_array_ = nullptr;
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  struct io_uring_cqe *cqes_ = nullptr;
+
+  // All reads not done, some of them queued for a free entry of the ring.
+  std::vector<std::unique_ptr<Read>> reads_;
+  std::deque<Read *> queued_;
+  int in_flight_ = 0;
+  // Set once the kernel rejected a read or the ring failed.
+  bool fallback_ = false;
+  std::vector<std::unique_ptr<FileContents>> abandoned_;
+  std::vector<Result> done_;
+};
+
+#endif  // BEANQUICK_HAVE_IO_URING
+
+}  // namespace
+
+std::unique_ptr<FileReader> FileReader::Create(ThreadPool *pool) {
+  std::unique_ptr<FileReader> reader = CreateIoUring();
+  if (reader == nullptr) reader = CreatePread(pool);
+  return reader;
+}
+
+std::unique_ptr<FileReader> FileReader::CreateIoUring(int depth) {
+#ifdef BEANQUICK_HAVE_IO_URING
+  return IoUringReader::Create(depth);
+#else
+  return nullptr;
+#endif
+}
+
+std::unique_ptr<FileReader> FileReader::CreatePread(ThreadPool *pool) {
+  return std::unique_ptr<FileReader>(new PreadReader(pool));
+}
+
+namespace internal {
+
+std::unique_ptr<FileReader> CreateIoUringWithOpcode(int depth, uint8 opcode) {
+#ifdef BEANQUICK_HAVE_IO_URING
+  return IoUringReader::Create(depth, opcode);
+#else
+  return nullptr;
+#endif
+}
+
+}  // namespace internal
+
+}  // namespace beanquick
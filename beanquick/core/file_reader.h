@@ -0,0 +1,114 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef DEANQUICK_FILE_READER_H_
+#define DEANQUICK_FILE_READER_H_
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "beanquick/core/base.h"
+#include "beanquick/core/thread_pool.h"
+
+namespace beanquick {
+
+// The contents of a file read into memory by a FileReader.
+class FileContents {
+ public:
+  FileContents(const string &filename, size_t size)
+      : filename_(filename), data_(new char[size]), size_(size) {}
+
+  FileContents(const FileContents &) = delete;
+  FileContents &operator=(const FileContents &) = delete;
+
+  absl::string_view text() const {
+    return absl::string_view(data_.get(), size_);
+  }
+
+  char *data() { return data_.get(); }
+
+  // For a file which turned out shorter than when it was sized.
+  void Truncate(size_t size) { size_ = std::min(size, size_); }
+
+  const string &filename() const { return filename_; }
+
+ private:
+  string filename_;
+  std::unique_ptr<char[]> data_;
+  size_t size_;
+};
+
+// -----------------------------------------------------------------------------
+// FileReader Definition.
+// -----------------------------------------------------------------------------
+// Reads many whole files at once, to keep the disk busy rather than wait on
+// one file at a time. Reads are started one by one and their results
+// collected in batches, in whatever order they complete. Not thread safe,
+// the reads are started and waited for from one thread.
+//
+//   std::unique_ptr<FileReader> reader = FileReader::Create(&pool);
+//   for (int i = 0; i < files.size(); i++) reader->Start(i, files[i]);
+//   for (int done = 0; done < files.size();) {
+//     for (FileReader::Result &result : reader->Wait()) ...
+//   }
+class FileReader {
+ public:
+  struct Result {
+    // As given to Start().
+    int id;
+    // NotFound when the file doesn't exist, InvalidArgument when it isn't a
+    // regular file and Internal for other failures, like MappedFile.
+    absl::Status status;
+    std::unique_ptr<FileContents> contents;
+  };
+
+  // Reads through io_uring where the kernel allows it, else with pread()
+  // on the threads of `pool`.
+  static std::unique_ptr<FileReader> Create(ThreadPool *pool);
+
+  // Returns nullptr when io_uring is unavailable, e.g. on kernels before
+  // 5.6 or when a seccomp filter denies it. Up to `depth` reads are in
+  // flight.
+  static std::unique_ptr<FileReader> CreateIoUring(int depth = 64);
+
+  static std::unique_ptr<FileReader> CreatePread(ThreadPool *pool);
+
+  virtual ~FileReader() {}
+
+  // Starts reading `filename`, whose result Wait() returns with `id`.
+  virtual void Start(int id, const string &filename) = 0;
+
+  // Blocks until some of the started reads are done and returns them, or
+  // returns none right away when no read is left.
+  virtual std::vector<Result> Wait() = 0;
+
+  // "io_uring" or "pread".
+  virtual absl::string_view name() const = 0;
+};
+
+namespace internal {
+// CreateIoUring() with the reads sent as `opcode`, for tests of a kernel
+// rejecting them.
+std::unique_ptr<FileReader> CreateIoUringWithOpcode(int depth, uint8 opcode);
+}  // namespace internal
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_FILE_READER_H_
@@ -0,0 +1,115 @@
+#include "file_reader.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <map>
+#include <memory>
+
+#include "absl/strings/str_cat.h"
+#include "beanquick/core/test_util.h"
+#include "gtest/gtest.h"
+
+namespace beanquick {
+namespace {
+
+// Both kinds of readers, io_uring only where the kernel allows it.
+std::vector<std::unique_ptr<FileReader>> Readers(ThreadPool *pool) {
+  std::vector<std::unique_ptr<FileReader>> readers;
+  readers.push_back(FileReader::CreatePread(pool));
+  // A small ring, to have reads wait for room in it.
+  std::unique_ptr<FileReader> uring = FileReader::CreateIoUring(4);
+  if (uring != nullptr) readers.push_back(std::move(uring));
+  return readers;
+}
+
+TEST(TestFileReader, ReadsAll) {
+  std::vector<string> filenames;
+  std::vector<string> contents;
+  for (int i = 0; i < 20; i++) {
+    // Sizes from empty to a few pages.
+    contents.push_back(string(i * i * 37, static_cast<char>('a' + i)));
+    filenames.push_back(WriteTempFile(contents.back()));
+  }
+  ThreadPool pool(3);
+  for (const std::unique_ptr<FileReader> &reader : Readers(&pool)) {
+    SCOPED_TRACE(reader->name());
+    for (size_t i = 0; i < filenames.size(); i++) {
+      reader->Start(i, filenames[i]);
+    }
+    std::map<int, string> results;
+    for (size_t done = 0; done < filenames.size();) {
+      std::vector<FileReader::Result> batch = reader->Wait();
+      ASSERT_FALSE(batch.empty());
+      for (FileReader::Result &result : batch) {
+        ASSERT_TRUE(result.status.ok()) << result.status;
+        EXPECT_EQ(filenames[result.id], result.contents->filename());
+        results[result.id] = string(result.contents->text());
+        done++;
+      }
+    }
+    EXPECT_TRUE(reader->Wait().empty());
+    ASSERT_EQ(filenames.size(), results.size());
+    for (size_t i = 0; i < filenames.size(); i++) {
+      EXPECT_EQ(contents[i], results[i]) << i;
+    }
+  }
+  for (const string &filename : filenames) unlink(filename.c_str());
+}
+
+TEST(TestFileReader, Errors) {
+  ThreadPool pool(2);
+  for (const std::unique_ptr<FileReader> &reader : Readers(&pool)) {
+    SCOPED_TRACE(reader->name());
+    reader->Start(7, "/nonexistent/ledger");
+    reader->Start(8, "/tmp");
+    std::map<int, absl::Status> statuses;
+    while (statuses.size() < 2) {
+      for (FileReader::Result &result : reader->Wait()) {
+        EXPECT_EQ(nullptr, result.contents);
+        statuses[result.id] = result.status;
+      }
+    }
+    EXPECT_EQ(absl::StatusCode::kNotFound, statuses[7].code());
+    EXPECT_EQ(absl::StatusCode::kInvalidArgument, statuses[8].code());
+  }
+}
+
+TEST(TestFileReader, RejectedReads) {
+  // An opcode no kernel knows fails like IORING_OP_READ before Linux 5.6.
+  std::unique_ptr<FileReader> reader =
+      internal::CreateIoUringWithOpcode(4, 0xFF);
+  if (reader == nullptr) return;
+  std::vector<string> filenames;
+  for (int i = 0; i < 10; i++) {
+    filenames.push_back(WriteTempFile(string(i * 1000, 'a' + i)));
+  }
+  for (size_t i = 0; i < filenames.size(); i++) reader->Start(i, filenames[i]);
+  std::map<int, string> results;
+  while (results.size() < filenames.size()) {
+    std::vector<FileReader::Result> batch = reader->Wait();
+    ASSERT_FALSE(batch.empty());
+    for (FileReader::Result &result : batch) {
+      ASSERT_TRUE(result.status.ok()) << result.status;
+      results[result.id] = string(result.contents->text());
+    }
+  }
+  for (size_t i = 0; i < filenames.size(); i++) {
+    EXPECT_EQ(string(i * 1000, 'a' + i), results[i]) << i;
+    unlink(filenames[i].c_str());
+  }
+}
+
+TEST(TestFileReader, DestroyedWhileReading) {
+  string filename = WriteTempFile(string(1 << 20, 'x'));
+  ThreadPool pool(2);
+  for (std::unique_ptr<FileReader> &reader : Readers(&pool)) {
+    for (int i = 0; i < 8; i++) reader->Start(i, filename);
+    // Waits for the reads, which write into buffers it owns.
+    reader.reset();
+  }
+  unlink(filename.c_str());
+}
+
+}  // namespace
+}  // namespace beanquick
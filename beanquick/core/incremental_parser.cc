@@ -0,0 +1,303 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "beanquick/core/incremental_parser.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/match.h"
+#include "beanquick/core/logging.h"
+#include "beanquick/core/mapped_file.h"
+
+namespace beanquick {
+
+namespace {
+
+// Returns where the line after `pos` starts, text.size() if there is none.
+size_t NextLine(absl::string_view text, size_t pos) {
+  const void *eol = memchr(text.data() + pos, '\n', text.size() - pos);
+  if (eol == nullptr) return text.size();
+  return static_cast<const char *>(eol) - text.data() + 1;
+}
+
+// Whether a line starting with `c` starts a block: the lexer takes it for
+// neither an indented, a blank nor a comment line.
+bool StartsBlock(char c) {
+  return c != ' ' && c != '\t' && c != '\r' && c != '\n' && c != ';' &&
+         c != '*';
+}
+
+bool IsPushLine(absl::string_view block) {
+  return block[0] == 'p' &&
+         (absl::StartsWith(block, "push") || absl::StartsWith(block, "pop"));
+}
+
+// Hashes the tags and metadata `parser` has pushed, which are all the
+// context a block is parsed in.
+size_t PushedState(const Parser &parser) {
+  size_t hash = 0;
+  for (absl::string_view tag : parser.pushed_tags()) {
+    hash = absl::HashOf(hash, tag);
+  }
+  for (const MetaEntry &entry : parser.pushed_meta()) {
+    hash = absl::HashOf(hash, entry.key, entry.value);
+  }
+  return hash;
+}
+
+int CountLines(absl::string_view text) {
+  return static_cast<int>(std::count(text.begin(), text.end(), '\n'));
+}
+
+}  // namespace
+
+struct IncrementalParser::Block {
+  // A hash of the text and of the context.
+  size_t key = 0;
+  // PushedState() at the start of the block.
+  size_t context = 0;
+  absl::string_view text;
+  // 1 based, the line the block starts at in the current text.
+  int line = 0;
+  // A pushtag, poptag, pushmeta or popmeta line.
+  bool push_line = false;
+  const Directive *directive = nullptr;
+  // With lines of the block, null when there are none, which is most.
+  std::unique_ptr<std::vector<ParseError>> errors;
+};
+
+// -----------------------------------------------------------------------------
+// IncrementalParser Implementation.
+// -----------------------------------------------------------------------------
+IncrementalParser::IncrementalParser() : ledger_(new Ledger) {}
+
+IncrementalParser::~IncrementalParser() {}
+
+size_t IncrementalParser::Split(absl::string_view text, int line,
+                                const Parser &state,
+                                std::vector<Block> *blocks) {
+  blocks->clear();
+  // The strings pushed point into `text`, so they go to a scratch ledger.
+  Ledger scratch;
+  Parser scratch_state(&scratch);
+  scratch_state.ContinueFrom(state);
+  size_t context = PushedState(state);
+  size_t start = 0;
+  int start_line = line;
+  auto add_block = [&](size_t end) {
+    Block block;
+    block.text = text.substr(start, end - start);
+    block.context = context;
+    block.key = absl::HashOf(context, block.text);
+    block.line = start_line;
+    block.push_line = IsPushLine(block.text);
+    if (block.push_line) {
+      scratch_state.Parse(block.text);
+      context = PushedState(scratch_state);
+    }
+    blocks->push_back(std::move(block));
+  };
+  for (size_t pos = 0; pos < text.size(); pos = NextLine(text, pos), line++) {
+    if (pos > start && StartsBlock(text[pos])) {
+      add_block(pos);
+      start = pos;
+      start_line = line;
+    }
+  }
+  if (start < text.size()) add_block(text.size());
+  return context;
+}
+
+absl::Status IncrementalParser::ReloadFile(const string &filename,
+                                           ReparseDiff *diff) {
+  std::unique_ptr<MappedFile> file;
+  absl::Status status = MappedFile::Open(filename, &file);
+  if (!status.ok()) return status;
+  *diff = Reload(file->text());
+  return absl::OkStatus();
+}
+
+ReparseDiff IncrementalParser::Reload(absl::string_view text) {
+  ReparseDiff diff;
+  old_ledger_.reset();
+  if (dead_bytes_ > live_bytes_) {
+    diff.rebuilt = true;
+    diff.removed = std::move(directives_);
+    old_ledger_ = std::move(ledger_);
+    ledger_.reset(new Ledger);
+    blocks_.clear();
+    push_blocks_.clear();
+    dead_bytes_ = 0;
+  }
+
+  // The blocks the same at the start and at the end are found by comparing
+  // their text with the new one, which is much faster than splitting and
+  // hashing it. Only the text in between is split.
+  size_t num_old = blocks_.size();
+  size_t pos = 0;
+  size_t prefix = 0;
+  while (prefix < num_old) {
+    absl::string_view old = blocks_[prefix].text;
+    size_t end = pos + old.size();
+    if (end > text.size() || memcmp(text.data() + pos, old.data(),
+                                    old.size()) != 0) {
+      break;
+    }
+    // The block must end where it did.
+    if (end < text.size() &&
+        (text[end - 1] != '\n' || !StartsBlock(text[end]))) {
+      break;
+    }
+    pos = end;
+    prefix++;
+  }
+  size_t end = text.size();
+  size_t suffix = 0;
+  while (suffix < num_old - prefix) {
+    absl::string_view old = blocks_[num_old - 1 - suffix].text;
+    if (end - pos < old.size()) break;
+    size_t start = end - old.size();
+    if (memcmp(text.data() + start, old.data(), old.size()) != 0) break;
+    // And start where it did.
+    if (start > 0 && (text[start - 1] != '\n' || !StartsBlock(text[start]))) {
+      break;
+    }
+    end = start;
+    suffix++;
+  }
+
+  // The state the text in between starts with.
+  Parser state(ledger_.get());
+  for (size_t i : push_blocks_) {
+    if (i >= prefix) break;
+    state.Parse(blocks_[i].text);
+  }
+  int line = 1;
+  if (prefix > 0) {
+    line = blocks_[prefix - 1].line + CountLines(blocks_[prefix - 1].text);
+  }
+  std::vector<Block> &blocks = next_blocks_;
+  size_t context = Split(text.substr(pos, end - pos), line, state, &blocks);
+  if (suffix > 0 && context != blocks_[num_old - suffix].context) {
+    // The blocks at the end are pushed other tags or metadata, they are
+    // matched by key like the rest.
+    Split(text.substr(pos), line, state, &blocks);
+    suffix = 0;
+  }
+
+  // The old blocks in between by key, last first for pop_back().
+  size_t old_end = num_old - suffix;
+  absl::flat_hash_map<size_t, std::vector<size_t>> old_blocks;
+  for (size_t i = old_end; i-- > prefix;) {
+    old_blocks[blocks_[i].key].push_back(i);
+  }
+  std::vector<bool> reused(old_end - prefix, false);
+
+  Parser parser(ledger_.get());
+  std::vector<const Directive *> added;
+  for (Block &block : blocks) {
+    auto it = old_blocks.find(block.key);
+    if (it != old_blocks.end() && !it->second.empty() &&
+        blocks_[it->second.back()].text == block.text) {
+      Block &old_block = blocks_[it->second.back()];
+      reused[it->second.back() - prefix] = true;
+      it->second.pop_back();
+      block.text = old_block.text;
+      block.directive = old_block.directive;
+      block.errors = std::move(old_block.errors);
+    }
+    else {
+      block.text = ledger_->CopyString(block.text);
+      size_t num_directives = ledger_->directives().size();
+      size_t num_errors = parser.errors().size();
+      parser.ContinueFrom(state);
+      parser.Parse(block.text);
+      size_t parsed = ledger_->directives().size() - num_directives;
+      CHECK(parsed <= 1) << "a block holds " << parsed << " directives";
+      if (parsed == 1) {
+        block.directive = ledger_->directives().back();
+        added.push_back(block.directive);
+      }
+      if (parser.errors().size() > num_errors) {
+        block.errors.reset(new std::vector<ParseError>(
+            parser.errors().begin() + num_errors, parser.errors().end()));
+      }
+      diff.blocks_parsed++;
+    }
+    if (block.push_line) state.Parse(block.text);
+  }
+
+  std::vector<const Directive *> removed;
+  for (size_t i = prefix; i < old_end; i++) {
+    if (reused[i - prefix]) continue;
+    dead_bytes_ += blocks_[i].text.size();
+    if (blocks_[i].directive != nullptr) {
+      removed.push_back(blocks_[i].directive);
+    }
+  }
+  size_t num_changed = std::min(added.size(), removed.size());
+  for (size_t i = 0; i < num_changed; i++) {
+    diff.changed.emplace_back(removed[i], added[i]);
+  }
+  diff.added.insert(diff.added.end(), added.begin() + num_changed,
+                    added.end());
+  diff.removed.insert(diff.removed.end(), removed.begin() + num_changed,
+                      removed.end());
+
+  // Put the new blocks in place of the old ones in between, and move the
+  // lines of those after.
+  if (suffix > 0) {
+    int new_line = blocks.empty()
+                       ? line
+                       : blocks.back().line + CountLines(blocks.back().text);
+    int shift = new_line - blocks_[old_end].line;
+    if (shift != 0) {
+      for (size_t i = old_end; i < num_old; i++) blocks_[i].line += shift;
+    }
+  }
+  auto middle = blocks_.begin() + prefix;
+  if (blocks.size() == old_end - prefix) {
+    std::move(blocks.begin(), blocks.end(), middle);
+  }
+  else {
+    middle = blocks_.erase(middle, blocks_.begin() + old_end);
+    blocks_.insert(middle, std::make_move_iterator(blocks.begin()),
+                   std::make_move_iterator(blocks.end()));
+  }
+  live_bytes_ = text.size();
+
+  directives_.clear();
+  errors_.clear();
+  push_blocks_.clear();
+  for (size_t i = 0; i < blocks_.size(); i++) {
+    const Block &block = blocks_[i];
+    if (block.directive != nullptr) directives_.push_back(block.directive);
+    if (block.push_line) push_blocks_.push_back(i);
+    if (block.errors == nullptr) continue;
+    for (ParseError error : *block.errors) {
+      error.line += block.line - 1;
+      errors_.push_back(std::move(error));
+    }
+  }
+  return diff;
+}
+
+}  // namespace beanquick
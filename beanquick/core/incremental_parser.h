@@ -0,0 +1,130 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef DEANQUICK_INCREMENTAL_PARSER_H_
+#define DEANQUICK_INCREMENTAL_PARSER_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "beanquick/core/directive.h"
+#include "beanquick/core/parser.h"
+
+namespace beanquick {
+
+// What a reload changed. Removed directives, and the old ones of changed
+// pairs, stay valid until the next reload.
+struct ReparseDiff {
+  std::vector<const Directive *> added;
+  std::vector<const Directive *> removed;
+  // An old directive and the one in its place, paired up in order among
+  // the blocks which changed.
+  std::vector<std::pair<const Directive *, const Directive *>> changed;
+  // All directives were parsed anew into a new ledger, see
+  // IncrementalParser. All old ones are then removed and all new added.
+  bool rebuilt = false;
+  // How many blocks were parsed rather than reused.
+  int blocks_parsed = 0;
+};
+
+// -----------------------------------------------------------------------------
+// IncrementalParser Definition.
+// -----------------------------------------------------------------------------
+// Parses new versions of the same ledger text, reparsing only what changed.
+//
+// The text is split into blocks, one per line which isn't indented, blank or
+// a comment, with the lines which follow it up to the next such line. So
+// each block holds at most one directive. A reload keeps the blocks at the
+// start and at the end whose text is unchanged, found by comparing it, and
+// splits the text in between. Blocks there are keyed by a hash of their
+// text and of the tags and metadata pushed before them, which are all that
+// parsing them depends on; those with the text and context of an old block
+// keep its directive, the rest are parsed. So an edit costs a comparison of
+// the text and the parsing of the blocks it touches. A change to pushed
+// tags or metadata reparses the blocks they are pushed on.
+//
+// The text of parsed blocks is copied into the ledger, which the
+// directives point into, so the text passed in needn't outlive a reload.
+// Replaced directives stay in the ledger until there is more of them than
+// of live ones, then the next reload parses everything into a new ledger.
+// Account ids are stable until then.
+//
+// Like ParallelParser, a line at the start of a block within a multi-line
+// string would be taken for the start of a directive.
+//
+//   IncrementalParser parser;
+//   ReparseDiff diff = parser.Reload(text);
+//   ... edit ...
+//   diff = parser.Reload(text);
+//   for (const Directive *directive : diff.added) ...
+class IncrementalParser {
+ public:
+  IncrementalParser();
+  ~IncrementalParser();
+
+  IncrementalParser(const IncrementalParser &) = delete;
+  IncrementalParser &operator=(const IncrementalParser &) = delete;
+
+  // Parses `text`, the new version of the text.
+  ReparseDiff Reload(absl::string_view text);
+
+  // Reloads the contents of `filename`. Only fails when the file can't be
+  // read, leaving the directives as they were.
+  absl::Status ReloadFile(const string &filename, ReparseDiff *diff);
+
+  // The directives of the text, in order.
+  const std::vector<const Directive *> &directives() const {
+    return directives_;
+  }
+
+  // The ledger the directives are in, for their accounts. Its directives()
+  // include replaced ones, use directives() above instead.
+  const Ledger &ledger() const { return *ledger_; }
+
+  const std::vector<ParseError> &errors() const { return errors_; }
+
+ private:
+  struct Block;
+
+  // Splits `text`, which starts at `line` with the tags and metadata
+  // `state` pushed, into `blocks` pointing into it. Returns the
+  // PushedState() at its end.
+  static size_t Split(absl::string_view text, int line, const Parser &state,
+                      std::vector<Block> *blocks);
+
+  std::unique_ptr<Ledger> ledger_;
+  // The ledger before a rebuild, kept for the removed directives.
+  std::unique_ptr<Ledger> old_ledger_;
+  std::vector<Block> blocks_;
+  // The blocks of the text being reloaded, kept for their memory.
+  std::vector<Block> next_blocks_;
+  // The indexes of the push and pop lines in blocks_.
+  std::vector<size_t> push_blocks_;
+  // The text of the current blocks, and of replaced ones in the ledger.
+  size_t live_bytes_ = 0;
+  size_t dead_bytes_ = 0;
+
+  std::vector<const Directive *> directives_;
+  std::vector<ParseError> errors_;
+};
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_INCREMENTAL_PARSER_H_
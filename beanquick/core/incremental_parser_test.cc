@@ -0,0 +1,209 @@
+#include "incremental_parser.h"
+
+#include <random>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_replace.h"
+#include "directive_proto.h"
+#include "gtest/gtest.h"
+
+namespace beanquick {
+namespace {
+
+string ErrorString(const ParseError &error) {
+  return absl::StrCat(error.line, ":", error.column, ": ",
+                      error.status.message());
+}
+
+string Narration(const Directive *directive) {
+  return string(directive->As<Transaction>()->narration);
+}
+
+std::vector<string> Narrations(const IncrementalParser &parser) {
+  std::vector<string> narrations;
+  for (const Directive *directive : parser.directives()) {
+    if (directive->As<Transaction>() != nullptr) {
+      narrations.push_back(Narration(directive));
+    }
+  }
+  return narrations;
+}
+
+string Txn(int day, absl::string_view narration) {
+  return absl::StrCat("2020-01-", day < 10 ? "0" : "", day, " * \"",
+                      narration, "\"\n  Expenses:Food  1.00 USD\n",
+                      "  Assets:Cash\n\n");
+}
+
+TEST(TestIncrementalParser, ReparsesChangedBlocks) {
+  string text = absl::StrCat("; Household\noption \"title\" \"Home\"\n",
+                             Txn(1, "a"), Txn(2, "b"), Txn(3, "c"));
+  IncrementalParser parser;
+  ReparseDiff diff = parser.Reload(text);
+  EXPECT_FALSE(diff.rebuilt);
+  // The comment at the start makes a block too.
+  EXPECT_EQ(5, diff.blocks_parsed);
+  EXPECT_EQ(3, diff.added.size());
+  EXPECT_TRUE(diff.removed.empty());
+  EXPECT_TRUE(diff.changed.empty());
+  EXPECT_EQ(std::vector<string>({"a", "b", "c"}), Narrations(parser));
+  const Directive *a = parser.directives()[0];
+  const Directive *c = parser.directives()[2];
+
+  // The same text again, nothing to do.
+  diff = parser.Reload(string(text));
+  EXPECT_EQ(0, diff.blocks_parsed);
+  EXPECT_TRUE(diff.added.empty() && diff.removed.empty());
+
+  // An edit.
+  text = absl::StrReplaceAll(text, {{"\"b\"", "\"bb\""}});
+  diff = parser.Reload(text);
+  EXPECT_EQ(1, diff.blocks_parsed);
+  ASSERT_EQ(1, diff.changed.size());
+  EXPECT_EQ("b", Narration(diff.changed[0].first));
+  EXPECT_EQ("bb", Narration(diff.changed[0].second));
+  EXPECT_TRUE(diff.added.empty() && diff.removed.empty());
+  EXPECT_EQ(std::vector<string>({"a", "bb", "c"}), Narrations(parser));
+  EXPECT_EQ(a, parser.directives()[0]);
+  EXPECT_EQ(c, parser.directives()[2]);
+
+  // An insertion, and a removal with blocks moved around.
+  text = absl::StrCat(Txn(1, "a"), Txn(4, "d"), Txn(2, "bb"), Txn(3, "c"));
+  diff = parser.Reload(text);
+  EXPECT_EQ(1, diff.blocks_parsed);
+  ASSERT_EQ(1, diff.added.size());
+  EXPECT_EQ("d", Narration(diff.added[0]));
+  EXPECT_TRUE(diff.removed.empty());
+  text = absl::StrCat(Txn(3, "c"), Txn(1, "a"), Txn(2, "bb"));
+  diff = parser.Reload(text);
+  EXPECT_EQ(0, diff.blocks_parsed);
+  ASSERT_EQ(1, diff.removed.size());
+  EXPECT_EQ("d", Narration(diff.removed[0]));
+  EXPECT_EQ(std::vector<string>({"c", "a", "bb"}), Narrations(parser));
+  EXPECT_EQ(c, parser.directives()[0]);
+}
+
+TEST(TestIncrementalParser, PushedTags) {
+  string text = absl::StrCat(Txn(1, "a"), "pushtag #trip\n", Txn(2, "b"),
+                             "poptag #trip\n", Txn(3, "c"));
+  IncrementalParser parser;
+  parser.Reload(text);
+  ASSERT_EQ(3, parser.directives().size());
+  const Transaction *b = parser.directives()[1]->As<Transaction>();
+  ASSERT_EQ(1, b->tags.size());
+  EXPECT_EQ("trip", b->tags[0]);
+
+  // The blocks between a changed pushtag and its poptag are reparsed.
+  text = absl::StrReplaceAll(text, {{"#trip", "#trip2"}});
+  ReparseDiff diff = parser.Reload(text);
+  EXPECT_EQ(3, diff.blocks_parsed);
+  ASSERT_EQ(1, diff.changed.size());
+  b = diff.changed[0].second->As<Transaction>();
+  ASSERT_EQ(1, b->tags.size());
+  EXPECT_EQ("trip2", b->tags[0]);
+  EXPECT_TRUE(parser.errors().empty());
+}
+
+TEST(TestIncrementalParser, ErrorLines) {
+  string bad = "2020-01-05 open Assets:Bad usd\n";
+  IncrementalParser parser;
+  parser.Reload(absl::StrCat(Txn(1, "a"), bad));
+  ASSERT_EQ(1, parser.errors().size());
+  EXPECT_EQ("5:28: expected end of line, got keyword 'usd'",
+            ErrorString(parser.errors()[0]));
+
+  // Reused, at its new line.
+  ReparseDiff diff = parser.Reload(absl::StrCat(Txn(1, "a"), Txn(2, "b"), bad));
+  EXPECT_EQ(1, diff.blocks_parsed);
+  ASSERT_EQ(1, parser.errors().size());
+  EXPECT_EQ("9:28: expected end of line, got keyword 'usd'",
+            ErrorString(parser.errors()[0]));
+}
+
+TEST(TestIncrementalParser, Rebuilds) {
+  IncrementalParser parser;
+  parser.Reload(absl::StrCat(Txn(1, "a"), Txn(2, "b")));
+  bool rebuilt = false;
+  for (int i = 0; i < 5 && !rebuilt; i++) {
+    ReparseDiff diff =
+        parser.Reload(absl::StrCat(Txn(1, "a"), Txn(2, absl::StrCat(i))));
+    rebuilt = diff.rebuilt;
+    if (rebuilt) {
+      EXPECT_EQ(2, diff.removed.size());
+      EXPECT_EQ(2, diff.added.size());
+      // The removed directives are still there.
+      EXPECT_EQ("a", Narration(diff.removed[0]));
+    }
+  }
+  EXPECT_TRUE(rebuilt);
+  EXPECT_EQ("a", Narration(parser.directives()[0]));
+  EXPECT_EQ(2, parser.ledger().num_accounts());
+}
+
+// Random edits of lines, the directives and errors of each version checked
+// against a Parser's.
+TEST(TestIncrementalParser, SameAsParser) {
+  const std::vector<string> kLines = {
+      "2020-01-01 * \"Shop\" \"a\"\n",
+      "2020-01-02 * \"b\" #tag\n",
+      "  Expenses:Food  1.00 USD\n",
+      "  Assets:Cash\n",
+      "  note: \"meta\"\n",
+      "2020-01-03 open Assets:Bank USD\n",
+      "2020-01-04 open Assets:Bad usd\n",
+      "2020-01-05 balance Assets:Cash  10 USD\n",
+      "pushtag #trip\n",
+      "poptag #trip\n",
+      "pushmeta batch: 1\n",
+      "popmeta batch:\n",
+      "option \"title\" \"Home\"\n",
+      "; comment\n",
+      "\n",
+  };
+  std::mt19937 rng(42);
+  std::vector<string> lines;
+  IncrementalParser incremental;
+  for (int version = 0; version < 300; version++) {
+    int edits = 1 + rng() % 3;
+    for (int i = 0; i < edits; i++) {
+      size_t at = rng() % (lines.size() + 1);
+      const string &line = kLines[rng() % kLines.size()];
+      switch (rng() % 3) {
+        case 0:
+          lines.insert(lines.begin() + at, line);
+          break;
+        case 1:
+          if (at < lines.size()) lines.erase(lines.begin() + at);
+          break;
+        default:
+          if (at < lines.size()) lines[at] = line;
+          break;
+      }
+    }
+    string text = absl::StrJoin(lines, "");
+    incremental.Reload(text);
+
+    Ledger ledger;
+    Parser parser(&ledger);
+    parser.Parse(text);
+    ASSERT_EQ(ledger.directives().size(), incremental.directives().size())
+        << text;
+    for (size_t i = 0; i < ledger.directives().size(); i++) {
+      pb::Directive want, got;
+      DirectiveToProto(ledger, *ledger.directives()[i], &want);
+      DirectiveToProto(incremental.ledger(), *incremental.directives()[i],
+                       &got);
+      ASSERT_EQ(want.DebugString(), got.DebugString()) << text;
+    }
+    ASSERT_EQ(parser.errors().size(), incremental.errors().size()) << text;
+    for (size_t i = 0; i < parser.errors().size(); i++) {
+      ASSERT_EQ(ErrorString(parser.errors()[i]),
+                ErrorString(incremental.errors()[i]))
+          << text;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace beanquick
@@ -0,0 +1,258 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "beanquick/core/inventory.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "absl/hash/hash.h"
+#include "absl/strings/str_cat.h"
+#include "beanquick/core/logging.h"
+
+namespace beanquick {
+
+// -----------------------------------------------------------------------------
+// Cost Implementation.
+// -----------------------------------------------------------------------------
+string Cost::ToString() const {
+  if (empty()) return "{}";
+  string ret = absl::StrCat("{", DecimalAlphaNum(number), " ",
+                            CurrencyName(currency));
+  if (date != kNoDate) absl::StrAppend(&ret, ", day ", date);
+  if (!label.empty()) absl::StrAppend(&ret, ", \"", label, "\"");
+  ret += "}";
+  return ret;
+}
+
+bool operator==(const Cost &lhs, const Cost &rhs) {
+  if (lhs.currency != rhs.currency) return false;
+  if (lhs.empty()) return true;
+  return lhs.date == rhs.date && lhs.number == rhs.number &&
+         lhs.label == rhs.label;
+}
+
+namespace {
+// Orders by currency name, then number, date and label.
+bool CostLess(const Cost &lhs, const Cost &rhs) {
+  if (lhs.currency != rhs.currency) {
+    if (lhs.empty() || rhs.empty()) return lhs.empty();
+    return CurrencyName(lhs.currency) < CurrencyName(rhs.currency);
+  }
+  if (lhs.number != rhs.number) return lhs.number < rhs.number;
+  if (lhs.date != rhs.date) return lhs.date < rhs.date;
+  return lhs.label < rhs.label;
+}
+
+bool PositionLess(const Position &lhs, const Position &rhs) {
+  if (lhs.currency != rhs.currency) {
+    return CurrencyName(lhs.currency) < CurrencyName(rhs.currency);
+  }
+  return CostLess(lhs.cost, rhs.cost);
+}
+}  // namespace
+
+// -----------------------------------------------------------------------------
+// Inventory Implementation.
+// -----------------------------------------------------------------------------
+Inventory::Inventory() : slots_(inline_), capacity_(kInlineSlots), size_(0) {}
+
+Inventory::~Inventory() {}
+
+Inventory::Inventory(const Inventory &from) : Inventory() { *this = from; }
+
+Inventory &Inventory::operator=(const Inventory &from) {
+  if (this == &from) return *this;
+  Clear();
+  if (capacity_ < from.capacity_) {
+    heap_.reset(new Slot[from.capacity_]);
+    slots_ = heap_.get();
+    capacity_ = from.capacity_;
+  }
+  Merge(from);
+  return *this;
+}
+
+size_t Inventory::Hash(CurrencyId currency, const Cost &cost) {
+  if (cost.empty()) return absl::Hash<CurrencyId>{}(currency);
+  return absl::Hash<std::tuple<CurrencyId, const Decimal &, CurrencyId, int32,
+                               absl::string_view>>{}(
+      std::tie(currency, cost.number, cost.currency, cost.date, cost.label));
+}
+
+uint32 Inventory::Probe(size_t hash, CurrencyId currency,
+                        const Cost &cost) const {
+  uint32 mask = capacity_ - 1;
+  uint32 i = hash & mask;
+  while (slots_[i].used) {
+    const Slot &slot = slots_[i];
+    if (slot.hash == hash && slot.position.currency == currency &&
+        slot.position.cost == cost) {
+      break;
+    }
+    i = (i + 1) & mask;
+  }
+  return i;
+}
+
+void Inventory::Update(const Decimal &number, CurrencyId currency,
+                       const Cost &cost, bool subtract) {
+  size_t hash = Hash(currency, cost);
+  uint32 i = Probe(hash, currency, cost);
+  if (!slots_[i].used) {
+    if (number.IsZero()) return;
+    if ((size_ + 1) * 4 > capacity_ * 3) {
+      Grow();
+      i = Probe(hash, currency, cost);
+    }
+    Slot &slot = slots_[i];
+    slot.used = true;
+    slot.hash = hash;
+    slot.position.number = number;
+    if (subtract) slot.position.number.Negate();
+    slot.position.currency = currency;
+    slot.position.cost = cost;
+    size_++;
+    return;
+  }
+  Decimal &held = slots_[i].position.number;
+  if (subtract) {
+    held -= number;
+  }
+  else {
+    held += number;
+  }
+  if (held.IsZero()) Erase(i);
+}
+
+// Backward shift deletion, keeps probe sequences intact without tombstones.
+void Inventory::Erase(uint32 index) {
+  uint32 mask = capacity_ - 1;
+  uint32 hole = index;
+  for (uint32 j = (hole + 1) & mask; slots_[j].used; j = (j + 1) & mask) {
+    uint32 home = slots_[j].hash & mask;
+    // Leave the entry if its home lies cyclically in (hole, j].
+    bool stays = hole <= j ? (hole < home && home <= j)
+                           : (hole < home || home <= j);
+    if (stays) continue;
+    std::swap(slots_[hole], slots_[j]);
+    hole = j;
+  }
+  Slot &slot = slots_[hole];
+  slot.used = false;
+  // Keep the label buffer, but don't hold on to a boxed number.
+  slot.position.number = Decimal();
+  slot.position.cost.number = Decimal();
+  slot.position.cost.label.clear();
+  size_--;
+}
+
+void Inventory::Grow() {
+  uint32 capacity = capacity_ * 2;
+  std::unique_ptr<Slot[]> heap(new Slot[capacity]);
+  uint32 mask = capacity - 1;
+  for (uint32 i = 0; i < capacity_; i++) {
+    if (!slots_[i].used) continue;
+    uint32 j = slots_[i].hash & mask;
+    while (heap[j].used) j = (j + 1) & mask;
+    heap[j] = std::move(slots_[i]);
+    slots_[i].used = false;
+  }
+  heap_ = std::move(heap);
+  slots_ = heap_.get();
+  capacity_ = capacity;
+}
+
+void Inventory::Merge(const Inventory &other) {
+  if (this == &other) {
+    Inventory copy(other);
+    Merge(copy);
+    return;
+  }
+  other.ForEach([this](const Position &position) {
+    Update(position.number, position.currency, position.cost, false);
+  });
+}
+
+void Inventory::Negate() {
+  for (uint32 i = 0; i < capacity_; i++) {
+    if (slots_[i].used) slots_[i].position.number.Negate();
+  }
+}
+
+void Inventory::Clear() {
+  for (uint32 i = 0; i < capacity_; i++) {
+    if (slots_[i].used) {
+      slots_[i].used = false;
+      slots_[i].position.number = Decimal();
+      slots_[i].position.cost.number = Decimal();
+    }
+  }
+  size_ = 0;
+}
+
+const Position *Inventory::Find(CurrencyId currency, const Cost &cost) const {
+  uint32 i = Probe(Hash(currency, cost), currency, cost);
+  return slots_[i].used ? &slots_[i].position : nullptr;
+}
+
+Decimal Inventory::TotalUnits(CurrencyId currency) const {
+  Decimal total;
+  ForEach([&total, currency](const Position &position) {
+    if (position.currency == currency) total += position.number;
+  });
+  return total;
+}
+
+std::vector<Position> Inventory::Positions() const {
+  std::vector<Position> ret;
+  ret.reserve(size_);
+  ForEach([&ret](const Position &position) { ret.push_back(position); });
+  std::sort(ret.begin(), ret.end(), PositionLess);
+  return ret;
+}
+
+string Inventory::ToString() const {
+  string ret = "(";
+  bool first = true;
+  for (const Position &position : Positions()) {
+    if (!first) ret += ", ";
+    first = false;
+    position.Units().AppendTo(&ret);
+    if (!position.cost.empty()) {
+      absl::StrAppend(&ret, " ", position.cost.ToString());
+    }
+  }
+  ret += ")";
+  return ret;
+}
+
+bool operator==(const Inventory &lhs, const Inventory &rhs) {
+  if (lhs.size_ != rhs.size_) return false;
+  for (uint32 i = 0; i < lhs.capacity_; i++) {
+    if (!lhs.slots_[i].used) continue;
+    const Position &position = lhs.slots_[i].position;
+    const Position *other = rhs.Find(position.currency, position.cost);
+    if (other == nullptr || other->number != position.number) return false;
+  }
+  return true;
+}
+
+std::ostream &operator<<(std::ostream &os, const Inventory &inventory) {
+  return os << inventory.ToString();
+}
+
+}  // namespace beanquick
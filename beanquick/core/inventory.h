@@ -0,0 +1,171 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef DEANQUICK_INVENTORY_H_
+#define DEANQUICK_INVENTORY_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "beanquick/core/amount.h"
+#include "beanquick/core/base.h"
+#include "beanquick/core/currency.h"
+#include "beanquick/core/decimal.h"
+
+namespace beanquick {
+
+// The cost basis of a lot, the fields of the Cost message in schema.proto.
+// A default constructed Cost stands for "held at no cost".
+struct Cost {
+  // Marks a Cost without a date.
+  static constexpr int32 kNoDate = -2147483647 - 1;
+
+  Cost() {}
+  Cost(const Decimal &number, absl::string_view currency,
+       int32 date = kNoDate, absl::string_view label = absl::string_view())
+      : number(number),
+        currency(InternCurrency(currency)),
+        date(date),
+        label(label.data(), label.size()) {}
+
+  bool empty() const { return currency == kNoCurrency; }
+
+  string ToString() const;
+
+  // Per unit cost.
+  Decimal number;
+  CurrencyId currency = kNoCurrency;
+  // Days since 1970-01-01.
+  int32 date = kNoDate;
+  string label;
+};
+
+bool operator==(const Cost &lhs, const Cost &rhs);
+inline bool operator!=(const Cost &lhs, const Cost &rhs) {
+  return !(lhs == rhs);
+}
+
+// Units of one currency held at one cost.
+struct Position {
+  Amount Units() const { return Amount(number, currency); }
+
+  Decimal number;
+  CurrencyId currency = kNoCurrency;
+  Cost cost;
+};
+
+// -----------------------------------------------------------------------------
+// Inventory Definition.
+// -----------------------------------------------------------------------------
+// A balance of positions keyed by (currency, cost), e.g. what an account
+// holds. Positions which drop to zero are removed.
+//
+// Backed by a flat open addressing table whose first kInlineSlots slots live
+// inside the Inventory, so the one to three currencies of most accounts never
+// touch the heap. Once the table has grown to its working size, Add(), Sub(),
+// Merge() and Negate() do not allocate, as long as the numbers stay compact
+// and labels fit in the short string buffer.
+class Inventory {
+ public:
+  Inventory();
+  ~Inventory();
+
+  Inventory(const Inventory &from);
+  Inventory &operator=(const Inventory &from);
+
+  // Adds `units` to the position held at `cost`.
+  void Add(const Amount &units, const Cost &cost = Cost()) {
+    Update(units.Number(), units.currency_id(), cost, false);
+  }
+
+  // Subtracts `units` from the position held at `cost`.
+  void Sub(const Amount &units, const Cost &cost = Cost()) {
+    Update(units.Number(), units.currency_id(), cost, true);
+  }
+
+  // Adds every position of `other`.
+  void Merge(const Inventory &other);
+
+  // Negates every position.
+  void Negate();
+
+  // Removes all positions, keeps the table for reuse.
+  void Clear();
+
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // The position of `currency` held at `cost`, nullptr if there is none.
+  const Position *Find(CurrencyId currency, const Cost &cost = Cost()) const;
+
+  // The units of `currency` summed over all costs.
+  Decimal TotalUnits(CurrencyId currency) const;
+
+  // Calls `fn(const Position &)` on each position, in no particular order.
+  template <typename Fn>
+  void ForEach(Fn fn) const {
+    for (uint32 i = 0; i < capacity_; i++) {
+      if (slots_[i].used) fn(slots_[i].position);
+    }
+  }
+
+  // The positions, sorted by currency name, then cost.
+  std::vector<Position> Positions() const;
+
+  // E.g. "(10 HOOL {500.00 USD}, 3.50 USD)".
+  string ToString() const;
+
+  friend bool operator==(const Inventory &lhs, const Inventory &rhs);
+
+ private:
+  // A power of two, holds three positions at the maximum load of 3/4.
+  static constexpr uint32 kInlineSlots = 4;
+
+  struct Slot {
+    bool used = false;
+    size_t hash = 0;
+    Position position;
+  };
+
+  static size_t Hash(CurrencyId currency, const Cost &cost);
+
+  void Update(const Decimal &number, CurrencyId currency, const Cost &cost,
+              bool subtract);
+
+  // Index of the slot holding (currency, cost), or else of the empty slot
+  // where it belongs.
+  uint32 Probe(size_t hash, CurrencyId currency, const Cost &cost) const;
+
+  void Erase(uint32 index);
+  void Grow();
+
+  Slot *slots_;
+  uint32 capacity_;
+  uint32 size_;
+  std::unique_ptr<Slot[]> heap_;
+  Slot inline_[kInlineSlots];
+};
+
+inline bool operator!=(const Inventory &lhs, const Inventory &rhs) {
+  return !(lhs == rhs);
+}
+
+std::ostream &operator<<(std::ostream &os, const Inventory &inventory);
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_INVENTORY_H_
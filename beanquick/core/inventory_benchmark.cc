@@ -0,0 +1,114 @@
+#include <vector>
+
+#include "beanquick/core/benchmark_util.h"
+#include "benchmark/benchmark.h"
+#include "inventory.h"
+
+namespace beanquick {
+namespace {
+
+constexpr int kAccounts = 1000;
+constexpr int64 kPostings = 10 * 1000 * 1000;
+
+// A posting of amounts[amount] to accounts[account], at costs[cost].
+struct BenchmarkPosting {
+  int account;
+  int amount;
+  int cost;
+  // Sells rather than buys, keeps the balances from running away.
+  bool sub;
+};
+
+void Post(const BenchmarkPosting& p, const std::vector<Amount>& amounts,
+          const std::vector<Cost>& costs, bool negate, Inventory* inventory) {
+  if (p.sub != negate) {
+    inventory->Sub(amounts[p.amount], costs[p.cost]);
+  }
+  else {
+    inventory->Add(amounts[p.amount], costs[p.cost]);
+  }
+}
+
+// Lots of the fund, the other currencies are held at no cost.
+std::vector<Cost> BenchmarkCosts() {
+  std::vector<Cost> costs = {Cost()};
+  for (int i = 0; i < 8; i++) {
+    costs.emplace_back(Decimal(std::to_string(300 + i * 7) + ".25"), "USD",
+                       18000 + i * 30);
+  }
+  return costs;
+}
+
+std::vector<BenchmarkPosting> BenchmarkPostings(
+    const std::vector<Amount>& amounts) {
+  CurrencyId fund = InternCurrency("VANGUARD_500");
+  std::vector<BenchmarkPosting> postings;
+  uint32 x = 12345;
+  for (int i = 0; i < kNumValues; i++) {
+    x = x * 1103515245 + 12345;
+    BenchmarkPosting posting;
+    // Some accounts are much busier than others.
+    posting.account = (x >> 8) % 16 == 0 ? (x >> 12) % 16
+                                          : (x >> 12) % kAccounts;
+    posting.amount = i;
+    posting.cost = amounts[i].currency_id() == fund ? 1 + (x >> 4) % 8 : 0;
+    posting.sub = (x >> 20) & 1;
+    postings.push_back(posting);
+  }
+  return postings;
+}
+
+// Adds to one inventory, which cycles through the currencies and lots of a
+// ledger. Every other round undoes the previous one.
+void BM_InventoryAdd(benchmark::State& state) {
+  std::vector<Amount> amounts = BenchmarkAmounts(GetValueMix(&state));
+  std::vector<Cost> costs = BenchmarkCosts();
+  std::vector<BenchmarkPosting> postings = BenchmarkPostings(amounts);
+  Inventory inventory;
+  for (const auto& p : postings) Post(p, amounts, costs, false, &inventory);
+  size_t i = 0;
+  AllocationCounter allocs(&state);
+  for (auto _ : state) {
+    bool negate = (i / kNumValues) % 2 == 0;
+    Post(postings[i++ % kNumValues], amounts, costs, negate, &inventory);
+  }
+  benchmark::DoNotOptimize(inventory.size());
+}
+BENCHMARK(BM_InventoryAdd)->Apply(ValueMixes);
+
+// Folds ten million postings into the inventories of kAccounts accounts, the
+// balances computation of a large ledger.
+void BM_InventoryFoldPostings(benchmark::State& state) {
+  std::vector<Amount> amounts = BenchmarkAmounts(GetValueMix(&state));
+  std::vector<Cost> costs = BenchmarkCosts();
+  std::vector<BenchmarkPosting> postings = BenchmarkPostings(amounts);
+  std::vector<Inventory> inventories(kAccounts);
+  auto fold = [&]() {
+    for (auto& inventory : inventories) inventory.Clear();
+    for (int64 i = 0; i < kPostings; i++) {
+      const BenchmarkPosting& p = postings[i % kNumValues];
+      // Shift the accounts every round, so that they see different postings.
+      int account = (p.account + i / kNumValues) % kAccounts;
+      Post(p, amounts, costs, false, &inventories[account]);
+    }
+  };
+  // Warm up, so that the tables have grown.
+  fold();
+  // Only count what the folds allocate, not the benchmark library.
+  int64 allocs = 0;
+  for (auto _ : state) {
+    int64 start = AllocationCount();
+    fold();
+    allocs += AllocationCount() - start;
+  }
+  state.SetItemsProcessed(state.iterations() * kPostings);
+  state.counters["allocs/posting"] =
+      static_cast<double>(allocs) /
+      (static_cast<double>(state.iterations()) * kPostings);
+}
+BENCHMARK(BM_InventoryFoldPostings)
+    ->Apply(ValueMixes)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace beanquick
@@ -0,0 +1,120 @@
+#include "inventory.h"
+
+#include <map>
+#include <random>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace beanquick {
+#define D Decimal
+
+TEST(TestInventory, AddSub) {
+  Inventory inv;
+  EXPECT_TRUE(inv.empty());
+  inv.Add(Amount(D("10.50"), "USD"));
+  inv.Add(Amount(D("2"), "EUR"));
+  inv.Add(Amount(D("0.5"), "USD"));
+  EXPECT_EQ(2, inv.size());
+  EXPECT_EQ(D("11"), inv.TotalUnits(InternCurrency("USD")));
+  EXPECT_EQ("(2 EUR, 11.00 USD)", inv.ToString());
+
+  // Positions dropping to zero go away.
+  inv.Sub(Amount(D("2.00"), "EUR"));
+  EXPECT_EQ(1, inv.size());
+  EXPECT_EQ(nullptr, inv.Find(InternCurrency("EUR")));
+  inv.Sub(Amount(D("20"), "USD"));
+  EXPECT_EQ("(-9.00 USD)", inv.ToString());
+
+  // Adding zero doesn't create a position.
+  inv.Add(Amount(D("0"), "CAD"));
+  EXPECT_EQ(1, inv.size());
+}
+
+TEST(TestInventory, Cost) {
+  Inventory inv;
+  Cost lot1(D("500.00"), "USD", 18000);
+  Cost lot2(D("520"), "USD", 18000, "ref");
+  inv.Add(Amount(D("10"), "HOOL"), lot1);
+  inv.Add(Amount(D("5"), "HOOL"), lot2);
+  inv.Add(Amount(D("3"), "HOOL"));
+  // Same lot, the cost number only differing in scale.
+  inv.Add(Amount(D("1"), "HOOL"), Cost(D("500"), "USD", 18000));
+  EXPECT_EQ(3, inv.size());
+  EXPECT_EQ(D("11"), inv.Find(InternCurrency("HOOL"), lot1)->number);
+  EXPECT_EQ(D("19"), inv.TotalUnits(InternCurrency("HOOL")));
+  EXPECT_EQ(
+      "(3 HOOL, 11 HOOL {500.00 USD, day 18000}, "
+      "5 HOOL {520 USD, day 18000, \"ref\"})",
+      inv.ToString());
+
+  inv.Sub(Amount(D("11"), "HOOL"), lot1);
+  EXPECT_EQ(2, inv.size());
+  EXPECT_EQ(nullptr, inv.Find(InternCurrency("HOOL"), lot1));
+}
+
+TEST(TestInventory, MergeNegate) {
+  Inventory a, b;
+  a.Add(Amount(D("1"), "USD"));
+  a.Add(Amount(D("2"), "EUR"));
+  b.Add(Amount(D("-1"), "USD"));
+  b.Add(Amount(D("3"), "CAD"));
+  a.Merge(b);
+  EXPECT_EQ("(3 CAD, 2 EUR)", a.ToString());
+
+  a.Merge(a);
+  EXPECT_EQ("(6 CAD, 4 EUR)", a.ToString());
+
+  Inventory c = a;
+  c.Negate();
+  EXPECT_EQ("(-6 CAD, -4 EUR)", c.ToString());
+  c.Merge(a);
+  EXPECT_TRUE(c.empty());
+
+  Inventory d;
+  d = a;
+  EXPECT_EQ(a, d);
+  d.Clear();
+  EXPECT_NE(a, d);
+}
+
+// Random adds and subs over many lots, grows the table past its inline slots
+// and erases from the middle of probe sequences.
+TEST(TestInventory, Random) {
+  std::mt19937 rng(42);
+  const char *currencies[] = {"USD", "EUR", "CAD", "HOOL", "BTC"};
+  Inventory inv;
+  std::map<std::pair<string, int>, int64> expected;
+  for (int i = 0; i < 20000; i++) {
+    string currency = currencies[rng() % 5];
+    int lot = rng() % 12;
+    int64 n = static_cast<int64>(rng() % 7) - 3;
+    Amount units(D(std::to_string(n)), currency);
+    Cost cost = lot == 0 ? Cost() : Cost(D(std::to_string(lot)), "USD");
+    if (rng() % 2) {
+      inv.Add(units, cost);
+      expected[{currency, lot}] += n;
+    }
+    else {
+      inv.Sub(units, cost);
+      expected[{currency, lot}] -= n;
+    }
+  }
+  int size = 0;
+  for (const auto &it : expected) {
+    Cost cost = it.first.second == 0
+                    ? Cost()
+                    : Cost(D(std::to_string(it.first.second)), "USD");
+    const Position *position = inv.Find(InternCurrency(it.first.first), cost);
+    if (it.second == 0) {
+      EXPECT_EQ(nullptr, position);
+      continue;
+    }
+    size++;
+    ASSERT_NE(nullptr, position);
+    EXPECT_EQ(D(std::to_string(it.second)), position->number);
+  }
+  EXPECT_EQ(size, inv.size());
+}
+
+}  // namespace beanquick
@@ -0,0 +1,362 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "beanquick/core/lexer.h"
+
+#include <cstring>
+
+namespace beanquick {
+
+namespace {
+enum CharClass : uint8 {
+  kBlank = 1 << 0,
+  kDigit = 1 << 1,
+  kUpper = 1 << 2,
+  kLower = 1 << 3,
+  // Characters of account and currency words, besides letters and digits.
+  kWord = 1 << 4,
+  // Characters of tags and links, besides letters and digits.
+  kTag = 1 << 5,
+  // Bytes of multibyte UTF-8 sequences, allowed in account names.
+  kNonAscii = 1 << 6,
+  kDash = 1 << 7,
+};
+
+struct CharClasses {
+  constexpr CharClasses() : table() {
+    for (int c = 0; c < 256; c++) {
+      uint8 bits = 0;
+      if (c == ' ' || c == '\t' || c == '\r') bits |= kBlank;
+      if (c >= '0' && c <= '9') bits |= kDigit;
+      if (c >= 'A' && c <= 'Z') bits |= kUpper;
+      if (c >= 'a' && c <= 'z') bits |= kLower;
+      if (c == '-' || c == '_' || c == '.' || c == '\'' || c == ':') {
+        bits |= kWord;
+      }
+      if (c == '-' || c == '_' || c == '.' || c == '/') bits |= kTag;
+      if (c >= 0x80) bits |= kNonAscii;
+      if (c == '-') bits |= kDash;
+      table[c] = bits;
+    }
+  }
+  uint8 table[256];
+};
+
+constexpr CharClasses kClasses;
+
+inline bool Is(char c, uint8 classes) {
+  return (kClasses.table[static_cast<uint8>(c)] & classes) != 0;
+}
+
+constexpr uint8 kAlnum = kDigit | kUpper | kLower;
+
+// Characters of account components.
+constexpr uint8 kAccountChar = kAlnum | kDash | kNonAscii;
+}  // namespace
+
+const char *TokenKindName(TokenKind kind) {
+  switch (kind) {
+    case TokenKind::kEof:
+      return "end of file";
+    case TokenKind::kEol:
+      return "end of line";
+    case TokenKind::kIndent:
+      return "indent";
+    case TokenKind::kDate:
+      return "date";
+    case TokenKind::kNumber:
+      return "number";
+    case TokenKind::kString:
+      return "string";
+    case TokenKind::kAccount:
+      return "account";
+    case TokenKind::kCurrency:
+      return "currency";
+    case TokenKind::kKeyword:
+      return "keyword";
+    case TokenKind::kKey:
+      return "key";
+    case TokenKind::kFlag:
+      return "flag";
+    case TokenKind::kTag:
+      return "tag";
+    case TokenKind::kLink:
+      return "link";
+    case TokenKind::kLeftCurl:
+      return "'{'";
+    case TokenKind::kRightCurl:
+      return "'}'";
+    case TokenKind::kLeftCurlCurl:
+      return "'{{'";
+    case TokenKind::kRightCurlCurl:
+      return "'}}'";
+    case TokenKind::kAt:
+      return "'@'";
+    case TokenKind::kAtAt:
+      return "'@@'";
+    case TokenKind::kComma:
+      return "','";
+    case TokenKind::kTilde:
+      return "'~'";
+    case TokenKind::kError:
+      return "invalid token";
+  }
+  return "unknown";
+}
+
+// -----------------------------------------------------------------------------
+// Lexer Implementation.
+// -----------------------------------------------------------------------------
+bool Lexer::StartLine(Token *token) {
+  at_line_start_ = false;
+  while (p_ < end_) {
+    const char *start = p_;
+    while (p_ < end_ && Is(*p_, kBlank)) p_++;
+    if (p_ == end_) return false;
+    if (*p_ != '\n' && *p_ != ';' && (*p_ != '*' || p_ != start)) {
+      if (p_ == start) return false;
+      *token = Make(TokenKind::kIndent, start);
+      line_has_tokens_ = true;
+      return true;
+    }
+    const void *newline = std::memchr(p_, '\n', end_ - p_);
+    if (newline == nullptr) {
+      p_ = end_;
+      return false;
+    }
+    p_ = static_cast<const char *>(newline) + 1;
+    line_++;
+  }
+  return false;
+}
+
+Token Lexer::Next() {
+  if (at_line_start_) {
+    Token indent;
+    if (StartLine(&indent)) return indent;
+  }
+  while (p_ < end_ && Is(*p_, kBlank)) p_++;
+  if (p_ == end_ || *p_ == '\n' || *p_ == ';') {
+    // StartLine() skipped the lines without tokens, so this one has some
+    // unless the text is over.
+    if (!line_has_tokens_) return Make(TokenKind::kEof, p_);
+    Token token = Make(TokenKind::kEol, p_);
+    const void *newline = p_ < end_ && *p_ == '\n'
+                              ? p_
+                              : std::memchr(p_, '\n', end_ - p_);
+    if (newline == nullptr) {
+      p_ = end_;
+    }
+    else {
+      p_ = static_cast<const char *>(newline) + 1;
+      line_++;
+    }
+    line_has_tokens_ = false;
+    at_line_start_ = true;
+    return token;
+  }
+
+  const char *start = p_;
+  Token token;
+  char c = *p_;
+  char next = p_ + 1 < end_ ? p_[1] : 0;
+  switch (c) {
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+      // YYYY-MM-DD, or YYYY/MM/DD. The parser validates the fields.
+      if (end_ - p_ >= 8 && Is(p_[1], kDigit) && Is(p_[2], kDigit) &&
+          Is(p_[3], kDigit) && (p_[4] == '-' || p_[4] == '/')) {
+        p_ += 5;
+        while (p_ < end_ && (Is(*p_, kDigit) || *p_ == start[4])) p_++;
+        token = Make(TokenKind::kDate, start);
+      }
+      else {
+        LexNumber(&token);
+      }
+      break;
+    case '-':
+    case '+':
+    case '.':
+      if (Is(next, kDigit) || (c != '.' && next == '.')) {
+        LexNumber(&token);
+      }
+      else {
+        p_++;
+        token = Make(TokenKind::kError, start);
+      }
+      break;
+    case '"':
+      LexString(&token);
+      break;
+    case '#':
+    case '^':
+      p_++;
+      while (p_ < end_ && Is(*p_, kAlnum | kTag)) p_++;
+      if (p_ - start > 1) {
+        token = Make(c == '#' ? TokenKind::kTag : TokenKind::kLink, start);
+      }
+      else {
+        // A lone '#' is a flag.
+        token = Make(c == '#' ? TokenKind::kFlag : TokenKind::kError, start);
+      }
+      break;
+    case '*':
+    case '!':
+    case '&':
+    case '?':
+    case '%':
+      p_++;
+      token = Make(TokenKind::kFlag, start);
+      break;
+    case '{':
+    case '}':
+      p_ += next == c ? 2 : 1;
+      if (c == '{') {
+        token = Make(
+            next == c ? TokenKind::kLeftCurlCurl : TokenKind::kLeftCurl,
+            start);
+      }
+      else {
+        token = Make(
+            next == c ? TokenKind::kRightCurlCurl : TokenKind::kRightCurl,
+            start);
+      }
+      break;
+    case '@':
+      p_ += next == c ? 2 : 1;
+      token = Make(next == c ? TokenKind::kAtAt : TokenKind::kAt, start);
+      break;
+    case ',':
+      p_++;
+      token = Make(TokenKind::kComma, start);
+      break;
+    case '~':
+      p_++;
+      token = Make(TokenKind::kTilde, start);
+      break;
+    default:
+      if (Is(c, kUpper | kLower)) {
+        LexWord(&token);
+      }
+      else {
+        // Take the whole UTF-8 sequence.
+        p_++;
+        while (p_ < end_ && (*p_ & 0xc0) == 0x80) p_++;
+        token = Make(TokenKind::kError, start);
+      }
+      break;
+  }
+  line_has_tokens_ = true;
+  return token;
+}
+
+void Lexer::LexNumber(Token *token) {
+  const char *start = p_;
+  if (*p_ == '-' || *p_ == '+') p_++;
+  while (p_ < end_ && (Is(*p_, kDigit) || *p_ == ',')) p_++;
+  if (p_ < end_ && *p_ == '.') {
+    p_++;
+    while (p_ < end_ && Is(*p_, kDigit)) p_++;
+  }
+  *token = Make(TokenKind::kNumber, start);
+}
+
+void Lexer::LexString(Token *token) {
+  const char *start = p_;
+  int line = line_;
+  bool escaped = false;
+  for (p_++; p_ < end_; p_++) {
+    char c = *p_;
+    if (c == '"') {
+      p_++;
+      *token = Make(TokenKind::kString, start);
+      token->line = line;
+      token->escaped = escaped;
+      return;
+    }
+    if (c == '\\') {
+      escaped = true;
+      if (p_ + 1 < end_) {
+        if (p_[1] == '\n') line_++;
+        p_++;
+      }
+    }
+    else if (c == '\n') {
+      line_++;
+    }
+  }
+  // Unterminated, make the rest of the line an error.
+  line_ = line;
+  const void *newline = std::memchr(start, '\n', end_ - start);
+  p_ = newline == nullptr ? end_ : static_cast<const char *>(newline);
+  *token = Make(TokenKind::kError, start);
+}
+
+void Lexer::LexWord(Token *token) {
+  const char *start = p_;
+  if (Is(*start, kLower)) {
+    while (p_ < end_ && (Is(*p_, kAlnum) || *p_ == '-' || *p_ == '_')) p_++;
+    if (p_ < end_ && *p_ == ':') {
+      p_++;
+      *token = Make(TokenKind::kKey, start);
+    }
+    else {
+      *token = Make(TokenKind::kKeyword, start);
+    }
+    return;
+  }
+  // Each component of an account starts with a capital letter, a digit or
+  // a non ASCII letter, and has no punctuation but dashes.
+  while (p_ < end_ && Is(*p_, kAccountChar)) p_++;
+  if (p_ < end_ && *p_ == ':') {
+    bool valid = true;
+    while (p_ < end_ && *p_ == ':') {
+      p_++;
+      valid &= p_ < end_ && Is(*p_, kUpper | kDigit | kNonAscii);
+      while (p_ < end_ && Is(*p_, kAccountChar)) p_++;
+    }
+    if (p_ < end_ && Is(*p_, kWord)) {
+      valid = false;
+      while (p_ < end_ && Is(*p_, kAccountChar | kWord)) p_++;
+    }
+    *token = Make(valid ? TokenKind::kAccount : TokenKind::kError, start);
+    return;
+  }
+  // A currency, which may also have quotes, dots and underscores.
+  bool valid = true;
+  while (p_ < end_ && Is(*p_, kAccountChar | kWord)) {
+    valid &= *p_ != ':';
+    p_++;
+  }
+  *token = Make(valid ? TokenKind::kCurrency : TokenKind::kError, start);
+}
+
+int Lexer::Column(const Token &token) const {
+  const char *p = token.text.data();
+  const char *line_start = p;
+  while (line_start > begin_ && line_start[-1] != '\n') line_start--;
+  return static_cast<int>(p - line_start) + 1;
+}
+
+}  // namespace beanquick
@@ -0,0 +1,126 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef DEANQUICK_LEXER_H_
+#define DEANQUICK_LEXER_H_
+
+#include "absl/strings/string_view.h"
+#include "beanquick/core/base.h"
+
+namespace beanquick {
+
+enum class TokenKind : uint8 {
+  kEof,
+  // The end of a line holding tokens. Blank and comment lines yield none.
+  kEol,
+  // Leading whitespace of a line holding tokens, which continues the
+  // directive above it.
+  kIndent,
+  kDate,
+  kNumber,
+  kString,
+  kAccount,
+  kCurrency,
+  // A lowercase word, e.g. "open" or "txn".
+  kKeyword,
+  // A metadata key, "key:".
+  kKey,
+  kFlag,
+  kTag,
+  kLink,
+  kLeftCurl,
+  kRightCurl,
+  kLeftCurlCurl,
+  kRightCurlCurl,
+  kAt,
+  kAtAt,
+  kComma,
+  kTilde,
+  // Text which starts no token.
+  kError,
+};
+
+// The name of `kind` for error messages, e.g. "account".
+const char *TokenKindName(TokenKind kind);
+
+// A token, which points into the lexed text. `text` is the token as
+// written: strings keep their quotes and escapes, keys their colon.
+struct Token {
+  TokenKind kind = TokenKind::kEof;
+  // A string holding backslash escapes.
+  bool escaped = false;
+  // 1 based line of the start of the token.
+  int line = 0;
+  absl::string_view text;
+};
+
+// -----------------------------------------------------------------------------
+// Lexer Definition.
+// -----------------------------------------------------------------------------
+// Splits ledger text into tokens, without copying it. Comments, blank lines
+// and org-mode headings ("* ..." at the start of a line) are skipped. The
+// text must stay valid while tokens are in use.
+//
+//   Lexer lexer(text);
+//   for (Token token = lexer.Next(); token.kind != TokenKind::kEof;
+//        token = lexer.Next()) {
+//     ...
+//   }
+class Lexer {
+ public:
+  explicit Lexer(absl::string_view text)
+      : begin_(text.data()), p_(text.data()), end_(text.data() + text.size()) {}
+
+  Lexer(const Lexer &) = delete;
+  Lexer &operator=(const Lexer &) = delete;
+
+  // Returns the next token, kEof for ever once the text is over. A line
+  // missing its final newline still ends with kEol.
+  Token Next();
+
+  // The 1 based column, in bytes, of `token`.
+  int Column(const Token &token) const;
+
+ private:
+  // Skips blank, comment and heading lines from the start of a line and
+  // returns the indent of the next one if any.
+  bool StartLine(Token *token);
+
+  void LexNumber(Token *token);
+  void LexString(Token *token);
+  void LexWord(Token *token);
+
+  // Returns a token of `kind` from `start` to the current position.
+  Token Make(TokenKind kind, const char *start) const {
+    Token token;
+    token.kind = kind;
+    token.line = line_;
+    token.text = absl::string_view(start, p_ - start);
+    return token;
+  }
+
+  const char *begin_;
+  const char *p_;
+  const char *end_;
+  int line_ = 1;
+  bool at_line_start_ = true;
+  // Whether the current line yielded a token, and so owes a kEol.
+  bool line_has_tokens_ = false;
+};
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_LEXER_H_
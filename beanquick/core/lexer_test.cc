@@ -0,0 +1,113 @@
+#include "lexer.h"
+
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace beanquick {
+namespace {
+typedef std::vector<std::pair<TokenKind, string>> Tokens;
+
+Tokens Lex(absl::string_view text) {
+  Lexer lexer(text);
+  Tokens tokens;
+  for (Token token = lexer.Next(); token.kind != TokenKind::kEof;
+       token = lexer.Next()) {
+    tokens.emplace_back(token.kind, string(token.text));
+  }
+  return tokens;
+}
+
+TEST(TestLexer, Transaction) {
+  Tokens expected = {
+      {TokenKind::kDate, "2020-01-02"},
+      {TokenKind::kFlag, "*"},
+      {TokenKind::kString, "\"Cafe\""},
+      {TokenKind::kString, "\"Coffee \\\"to go\\\"\""},
+      {TokenKind::kTag, "#trip-2020"},
+      {TokenKind::kLink, "^receipt.1"},
+      {TokenKind::kEol, ""},
+      {TokenKind::kIndent, "  "},
+      {TokenKind::kKey, "source:"},
+      {TokenKind::kString, "\"bank\""},
+      {TokenKind::kEol, ""},
+      {TokenKind::kIndent, "  "},
+      {TokenKind::kFlag, "!"},
+      {TokenKind::kAccount, "Expenses:Food:Café"},
+      {TokenKind::kNumber, "-1,234.50"},
+      {TokenKind::kCurrency, "USD"},
+      {TokenKind::kLeftCurl, "{"},
+      {TokenKind::kNumber, "10"},
+      {TokenKind::kCurrency, "HOOL"},
+      {TokenKind::kComma, ","},
+      {TokenKind::kDate, "2019/5/1"},
+      {TokenKind::kRightCurl, "}"},
+      {TokenKind::kAtAt, "@@"},
+      {TokenKind::kNumber, ".5"},
+      {TokenKind::kCurrency, "VACHR"},
+      {TokenKind::kEol, ""},
+      {TokenKind::kIndent, "\t"},
+      {TokenKind::kAccount, "Assets:Cash"},
+      {TokenKind::kEol, ""},
+  };
+  EXPECT_EQ(expected,
+            Lex("2020-01-02 * \"Cafe\" \"Coffee \\\"to go\\\"\" #trip-2020 "
+                "^receipt.1\n"
+                "  source: \"bank\"\n"
+                "  ! Expenses:Food:Café -1,234.50 USD {10 HOOL, 2019/5/1} "
+                "@@ .5 VACHR\n"
+                "\tAssets:Cash"));
+}
+
+TEST(TestLexer, SkippedLines) {
+  // Blank lines, comments and headings yield nothing, and a line missing its
+  // newline still ends.
+  Tokens expected = {
+      {TokenKind::kKeyword, "option"},   {TokenKind::kString, "\"title\""},
+      {TokenKind::kString, "\"Home\""},  {TokenKind::kEol, ""},
+      {TokenKind::kDate, "2020-01-01"},  {TokenKind::kKeyword, "open"},
+      {TokenKind::kAccount, "Assets:A"}, {TokenKind::kCurrency, "USD"},
+      {TokenKind::kComma, ","},          {TokenKind::kCurrency, "EUR"},
+      {TokenKind::kEol, ""},             {TokenKind::kIndent, "    "},
+      {TokenKind::kKey, "x-y_z:"},       {TokenKind::kTilde, "~"},
+      {TokenKind::kEol, ""},
+  };
+  EXPECT_EQ(expected, Lex("; Comment\n"
+                          "* Heading\n"
+                          "\n"
+                          "   \r\n"
+                          "option \"title\" \"Home\" ; Trailing\n"
+                          "  ; Indented comment\n"
+                          "2020-01-01 open Assets:A USD,EUR\r\n"
+                          "    x-y_z: ~"));
+  EXPECT_EQ(Tokens(), Lex(""));
+  EXPECT_EQ(Tokens(), Lex("\n\n; Only comments"));
+}
+
+TEST(TestLexer, Errors) {
+  Tokens expected = {
+      {TokenKind::kError, "Assets::Cash"}, {TokenKind::kError, "Assets:cash"},
+      {TokenKind::kError, "$"},            {TokenKind::kError, "€"},
+      {TokenKind::kError, "-"},            {TokenKind::kEol, ""},
+      {TokenKind::kError, "\"open"},       {TokenKind::kEol, ""},
+      {TokenKind::kNumber, "1"},           {TokenKind::kEol, ""},
+  };
+  EXPECT_EQ(expected, Lex("Assets::Cash Assets:cash $ € -\n\"open\n1"));
+}
+
+TEST(TestLexer, Positions) {
+  Lexer lexer("2020-01-01 note Assets:A \"multi\nline\"\n  key: 12\n");
+  std::vector<std::pair<int, int>> positions;
+  for (Token token = lexer.Next(); token.kind != TokenKind::kEof;
+       token = lexer.Next()) {
+    if (token.kind == TokenKind::kEol) continue;
+    positions.emplace_back(token.line, lexer.Column(token));
+  }
+  std::vector<std::pair<int, int>> expected = {
+      {1, 1}, {1, 12}, {1, 17}, {1, 26}, {3, 1}, {3, 3}, {3, 8}};
+  EXPECT_EQ(expected, positions);
+}
+
+}  // namespace
+}  // namespace beanquick
@@ -0,0 +1,241 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "beanquick/core/loader.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "beanquick/core/logging.h"
+
+namespace beanquick {
+
+namespace {
+
+// Returns the real path of `name`, relative to `dir` unless absolute.
+absl::Status RealPath(absl::string_view dir, absl::string_view name,
+                      string *path) {
+  string joined = dir.empty() || absl::StartsWith(name, "/")
+                      ? string(name)
+                      : absl::StrCat(dir, "/", name);
+  char *real = realpath(joined.c_str(), nullptr);
+  if (real == nullptr) {
+    string message = absl::StrCat(joined, ": ", std::strerror(errno));
+    if (errno == ENOENT) return absl::NotFoundError(message);
+    return absl::InternalError(message);
+  }
+  path->assign(real);
+  free(real);
+  return absl::OkStatus();
+}
+
+absl::string_view Dirname(absl::string_view path) {
+  return path.substr(0, path.rfind('/'));
+}
+
+enum VisitState : char { kUnvisited, kVisiting, kVisited };
+
+}  // namespace
+
+// A file and what parsing it gives, to be merged.
+struct Loader::File {
+  struct ResolvedInclude {
+    int line;
+    // The real path, empty when it can't be resolved.
+    string path;
+    absl::Status status;
+    int file = -1;
+  };
+
+  explicit File(const string &path) : path(path) {}
+
+  string path;
+  absl::Status status;
+  // The first file goes to the target ledger and display context, the
+  // rest to their own.
+  std::unique_ptr<Ledger> ledger;
+  DisplayContext dcontext;
+  std::vector<ParseError> errors;
+  std::vector<Option> options;
+  std::vector<Option> plugins;
+  std::vector<ResolvedInclude> includes;
+  std::vector<AccountId> account_ids;
+};
+
+// -----------------------------------------------------------------------------
+// Loader Implementation.
+// -----------------------------------------------------------------------------
+Loader::Loader(Ledger *ledger, DisplayContext *dcontext, ThreadPool *pool)
+    : ledger_(ledger), dcontext_(dcontext), pool_(pool) {}
+
+Loader::~Loader() {}
+
+int Loader::AddFile(const string &path) {
+  int id = static_cast<int>(all_files_.size());
+  all_files_.emplace_back(new File(path));
+  if (id > 0) all_files_.back()->ledger.reset(new Ledger);
+  file_ids_[path] = id;
+  reader_->Start(id, path);
+  return id;
+}
+
+absl::Status Loader::Load(const string &filename) {
+  CHECK(all_files_.empty()) << "Load() called twice";
+  if (reader_ == nullptr) reader_ = FileReader::Create(pool_);
+  string path;
+  absl::Status status = RealPath("", filename, &path);
+  if (!status.ok()) return status;
+  AddFile(path);
+
+  // Reads are waited for while there are any, they are likely what holds
+  // everything up. Files parsed meanwhile have their includes read next.
+  int reading = 1;
+  int parsing = 0;
+  while (reading > 0 || parsing > 0) {
+    if (reading > 0) {
+      for (FileReader::Result &result : reader_->Wait()) {
+        reading--;
+        File *file = all_files_[result.id].get();
+        file->status = result.status;
+        if (!result.status.ok()) continue;
+        parsing++;
+        // std::function must be copyable, so the contents go as a pointer.
+        FileContents *contents = result.contents.release();
+        pool_->Schedule([this, file, contents] {
+          ParseContents(file, std::unique_ptr<FileContents>(contents));
+        });
+      }
+    }
+    std::vector<File *> parsed;
+    {
+      absl::MutexLock lock(&mu_);
+      if (reading == 0) mu_.Await(absl::Condition(this, &Loader::HasParsed));
+      parsed.swap(parsed_);
+    }
+    for (File *file : parsed) {
+      parsing--;
+      for (File::ResolvedInclude &include : file->includes) {
+        if (!include.status.ok()) continue;
+        auto it = file_ids_.find(include.path);
+        if (it != file_ids_.end()) {
+          include.file = it->second;
+        }
+        else {
+          include.file = AddFile(include.path);
+          reading++;
+        }
+      }
+    }
+  }
+  if (!all_files_[0]->status.ok()) return all_files_[0]->status;
+
+  std::vector<char> states(all_files_.size(), kUnvisited);
+  Visit(0, &states);
+  Merge();
+  return absl::OkStatus();
+}
+
+void Loader::ParseContents(File *file, std::unique_ptr<FileContents> contents) {
+  Ledger *ledger = file->ledger != nullptr ? file->ledger.get() : ledger_;
+  DisplayContext *dcontext =
+      file->ledger != nullptr ? &file->dcontext : dcontext_;
+  Parser parser(ledger, dcontext);
+  parser.Parse(ledger->Adopt(std::move(contents))->text());
+  file->errors = parser.errors();
+  file->options = parser.options();
+  file->plugins = parser.plugins();
+  absl::string_view dir = Dirname(file->path);
+  for (const Include &include : parser.includes()) {
+    File::ResolvedInclude resolved;
+    resolved.line = include.line;
+    resolved.status = RealPath(dir, include.filename, &resolved.path);
+    file->includes.push_back(std::move(resolved));
+  }
+  absl::MutexLock lock(&mu_);
+  parsed_.push_back(file);
+}
+
+void Loader::Visit(int id, std::vector<char> *states) {
+  (*states)[id] = kVisiting;
+  order_.push_back(id);
+  File *file = all_files_[id].get();
+  for (const File::ResolvedInclude &include : file->includes) {
+    absl::Status status = include.status;
+    if (status.ok()) {
+      const File *target = all_files_[include.file].get();
+      if (!target->status.ok()) {
+        status = target->status;
+      }
+      else if ((*states)[include.file] == kVisiting) {
+        status = absl::InvalidArgumentError(absl::StrCat(
+            "include of ", target->path, " makes a cycle"));
+      }
+      else if ((*states)[include.file] == kVisited) {
+        status = absl::AlreadyExistsError(
+            absl::StrCat(target->path, " is already included"));
+      }
+      else {
+        Visit(include.file, states);
+        continue;
+      }
+    }
+    file->errors.push_back({include.line, 1, status});
+  }
+  (*states)[id] = kVisited;
+}
+
+void Loader::Merge() {
+  // Like ParallelParser, accounts are interned in the order of the files.
+  for (size_t i = 1; i < order_.size(); i++) {
+    File *file = all_files_[order_[i]].get();
+    file->account_ids = ledger_->InternAccounts(*file->ledger);
+  }
+  pool_->ForEach(static_cast<int>(order_.size()) - 1, [this](int i) {
+    File *file = all_files_[order_[i + 1]].get();
+    file->ledger->RemapAccounts(file->account_ids);
+  });
+
+  for (int id : order_) {
+    File *file = all_files_[id].get();
+    if (file->ledger != nullptr) {
+      ledger_->Splice(std::move(file->ledger));
+      if (dcontext_ != nullptr) dcontext_->Merge(file->dcontext);
+    }
+    files_.push_back(file->path);
+    // Include errors were appended after the parse errors.
+    std::stable_sort(file->errors.begin(), file->errors.end(),
+                     [](const ParseError &a, const ParseError &b) {
+                       return a.line < b.line ||
+                              (a.line == b.line && a.column < b.column);
+                     });
+    for (const ParseError &error : file->errors) {
+      errors_.push_back({file->path, error.line, error.column, error.status});
+    }
+    options_.insert(options_.end(), file->options.begin(),
+                    file->options.end());
+    plugins_.insert(plugins_.end(), file->plugins.begin(),
+                    file->plugins.end());
+  }
+}
+
+}  // namespace beanquick
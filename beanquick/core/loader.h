@@ -0,0 +1,132 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef DEANQUICK_LOADER_H_
+#define DEANQUICK_LOADER_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "beanquick/core/directive.h"
+#include "beanquick/core/display_context.h"
+#include "beanquick/core/file_reader.h"
+#include "beanquick/core/parser.h"
+#include "beanquick/core/thread_pool.h"
+
+namespace beanquick {
+
+// An error in a file the Loader loaded: a parse error, or an include which
+// can't be read, makes a cycle or includes a file a second time.
+struct LoadError {
+  // The file the error is in, resolved like in Loader::files().
+  string filename;
+  int line;
+  int column;
+  absl::Status status;
+};
+
+// -----------------------------------------------------------------------------
+// Loader Definition.
+// -----------------------------------------------------------------------------
+// Loads a ledger file and all it includes, directly or not, into a Ledger.
+//
+// Files are read through a FileReader, as many at once as there are known,
+// and each is parsed on the pool as soon as it has been read, into a ledger
+// of its own; the includes it has are read next. So the time to load many
+// files from a cold cache goes to the disk, not to waiting on one file
+// after the other. Once all are parsed, their ledgers are merged into the
+// target one in a fixed order, whatever order the reads completed in: each
+// file, then what it includes in order, depth first.
+//
+// Includes are relative to the file they are in. An include of a file
+// which includes it, directly or not, or of a file already included, is an
+// error, and the file isn't included again.
+//
+//   ThreadPool pool;
+//   Loader loader(&ledger, &dcontext, &pool);
+//   absl::Status status = loader.Load("main.beancount");
+//   for (const LoadError &error : loader.errors()) ...
+class Loader {
+ public:
+  Loader(Ledger *ledger, DisplayContext *dcontext, ThreadPool *pool);
+  ~Loader();
+
+  Loader(const Loader &) = delete;
+  Loader &operator=(const Loader &) = delete;
+
+  // Reads files with `reader` rather than FileReader::Create().
+  void set_file_reader(std::unique_ptr<FileReader> reader) {
+    reader_ = std::move(reader);
+  }
+
+  // Loads `filename` and its includes, once per Loader. Fails only when
+  // `filename` can't be read, like Parser::ParseFile(); the rest goes to
+  // errors().
+  absl::Status Load(const string &filename);
+
+  // The real paths of the files loaded, in the order their directives are
+  // in the ledger.
+  const std::vector<string> &files() const { return files_; }
+
+  // In the order of files(), then of lines.
+  const std::vector<LoadError> &errors() const { return errors_; }
+
+  // Of all files, in the order of files().
+  const std::vector<Option> &options() const { return options_; }
+  const std::vector<Option> &plugins() const { return plugins_; }
+
+ private:
+  struct File;
+
+  // Adds the file at `path`, a real path, and starts reading it.
+  int AddFile(const string &path);
+  // Parses `file` on the pool, then queues it on parsed_.
+  void ParseContents(File *file, std::unique_ptr<FileContents> contents);
+  // Appends the files reached from `id` to order_, checking their includes.
+  void Visit(int id, std::vector<char> *states);
+  void Merge();
+
+  bool HasParsed() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return !parsed_.empty();
+  }
+
+  Ledger *ledger_;
+  DisplayContext *dcontext_;
+  ThreadPool *pool_;
+  std::unique_ptr<FileReader> reader_;
+
+  // All files seen, by id, the first being the one loaded.
+  std::vector<std::unique_ptr<File>> all_files_;
+  absl::flat_hash_map<string, int> file_ids_;
+  // Ids of the files loaded, in order.
+  std::vector<int> order_;
+
+  absl::Mutex mu_;
+  std::vector<File *> parsed_ ABSL_GUARDED_BY(mu_);
+
+  std::vector<string> files_;
+  std::vector<LoadError> errors_;
+  std::vector<Option> options_;
+  std::vector<Option> plugins_;
+};
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_LOADER_H_
@@ -0,0 +1,125 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <memory>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "beanquick/core/benchmark_util.h"
+#include "benchmark/benchmark.h"
+#include "loader.h"
+
+namespace beanquick {
+namespace {
+
+constexpr int kFiles = 128;
+constexpr size_t kFileSize = 2 << 20;
+
+// A main file including kFiles generated ones, made once.
+class IncludeTree {
+ public:
+  IncludeTree() {
+    string text;
+    for (int i = 0; i < kFiles; i++) {
+      files_.emplace_back(new BenchmarkLedger(kFileSize));
+      absl::StrAppend(&text, "include \"", files_.back()->filename(), "\"\n");
+      size_ += files_.back()->size();
+    }
+    main_ = absl::StrCat(files_[0]->filename(), ".main");
+    FILE *file = fopen(main_.c_str(), "w");
+    fwrite(text.data(), 1, text.size(), file);
+    fclose(file);
+  }
+
+  ~IncludeTree() { unlink(main_.c_str()); }
+
+  // Drops the files from the page cache, so that they are read from disk.
+  void DropCache() const {
+    for (const auto &ledger : files_) {
+      int fd = open(ledger->filename().c_str(), O_RDONLY);
+      fdatasync(fd);
+      posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+      close(fd);
+    }
+  }
+
+  const string &main() const { return main_; }
+  size_t size() const { return size_; }
+
+ private:
+  std::vector<std::unique_ptr<BenchmarkLedger>> files_;
+  string main_;
+  size_t size_ = 0;
+};
+
+const IncludeTree &Tree() {
+  static const IncludeTree *tree = new IncludeTree;
+  return *tree;
+}
+
+enum Reader { kSequential, kPread, kIoUring };
+
+// Args: the reader, the threads of the pool, and whether the cache is cold.
+void LoaderArgs(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"reader", "threads", "cold"});
+  for (int cold : {0, 1}) {
+    b->Args({kSequential, 1, cold});
+    for (int reader : {kPread, kIoUring}) {
+      for (int threads : {1, 4}) b->Args({reader, threads, cold});
+    }
+  }
+}
+
+// Loading kFiles files of kFileSize. The sequential reader is a Parser
+// taking one file after the other, for reference.
+void BM_Load(benchmark::State &state) {
+  const IncludeTree &tree = Tree();
+  ThreadPool pool(static_cast<int>(state.range(1)));
+  bool cold = state.range(2) != 0;
+  for (auto _ : state) {
+    if (cold) {
+      state.PauseTiming();
+      tree.DropCache();
+      state.ResumeTiming();
+    }
+    Ledger ledger;
+    DisplayContext dcontext;
+    if (state.range(0) == kSequential) {
+      Parser parser(&ledger, &dcontext);
+      if (!parser.ParseFile(tree.main()).ok()) {
+        state.SkipWithError("load failed");
+        break;
+      }
+      for (const Include &include : parser.includes()) {
+        Parser included(&ledger, &dcontext);
+        if (!included.ParseFile(string(include.filename)).ok()) {
+          state.SkipWithError("load failed");
+          break;
+        }
+      }
+      continue;
+    }
+    std::unique_ptr<FileReader> reader =
+        state.range(0) == kIoUring ? FileReader::CreateIoUring()
+                                   : FileReader::CreatePread(&pool);
+    if (reader == nullptr) {
+      state.SkipWithError("no io_uring");
+      break;
+    }
+    Loader loader(&ledger, &dcontext, &pool);
+    loader.set_file_reader(std::move(reader));
+    if (!loader.Load(tree.main()).ok() || !loader.errors().empty()) {
+      state.SkipWithError("load failed");
+      break;
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * tree.size());
+}
+BENCHMARK(BM_Load)
+    ->Apply(LoaderArgs)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace beanquick
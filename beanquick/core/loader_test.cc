@@ -0,0 +1,175 @@
+#include "loader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace beanquick {
+namespace {
+
+// A temporary directory of ledger files, removed with the object.
+class LedgerDir {
+ public:
+  LedgerDir() {
+    char dir[] = "/tmp/loader_test.XXXXXX";
+    EXPECT_NE(nullptr, mkdtemp(dir));
+    dir_ = dir;
+  }
+
+  ~LedgerDir() {
+    for (const string &path : paths_) unlink(path.c_str());
+    for (auto it = dirs_.rbegin(); it != dirs_.rend(); ++it) {
+      rmdir(it->c_str());
+    }
+    rmdir(dir_.c_str());
+  }
+
+  // Writes `name`, which may be in a subdirectory, and returns its path.
+  string Write(const string &name, absl::string_view text) {
+    string path = Path(name);
+    size_t slash = name.find('/');
+    if (slash != string::npos) {
+      string dir = Path(name.substr(0, slash));
+      if (mkdir(dir.c_str(), 0755) == 0) dirs_.push_back(dir);
+    }
+    FILE *file = fopen(path.c_str(), "w");
+    EXPECT_NE(nullptr, file);
+    fwrite(text.data(), 1, text.size(), file);
+    fclose(file);
+    paths_.push_back(path);
+    return path;
+  }
+
+  string Path(const string &name) const {
+    return absl::StrCat(dir_, "/", name);
+  }
+
+ private:
+  string dir_;
+  std::vector<string> dirs_;
+  std::vector<string> paths_;
+};
+
+std::vector<string> Narrations(const Ledger &ledger) {
+  std::vector<string> narrations;
+  for (const Directive *directive : ledger.directives()) {
+    const Note *note = directive->As<Note>();
+    if (note != nullptr) narrations.push_back(string(note->comment));
+  }
+  return narrations;
+}
+
+string ErrorString(const LoadError &error, const LedgerDir &dir) {
+  string filename = error.filename;
+  char *real = realpath(dir.Path("").c_str(), nullptr);
+  filename = filename.substr(strlen(real) + 1);
+  free(real);
+  return absl::StrCat(filename, ":", error.line, ":", error.column, ": ",
+                      error.status.message());
+}
+
+TEST(TestLoader, IncludesInOrder) {
+  LedgerDir dir;
+  string main = dir.Write("main.beancount",
+                          "option \"title\" \"Home\"\n"
+                          "2020-01-01 note Assets:Cash \"main\"\n"
+                          "include \"bank.beancount\"\n"
+                          "include \"years/2020.beancount\"\n"
+                          "2020-01-02 note Assets:Cash \"main end\"\n");
+  dir.Write("bank.beancount",
+            "2020-01-01 note Assets:Bank \"bank\"\n"
+            "2020-01-01 open Assets:Bank usd\n");
+  dir.Write("years/2020.beancount",
+            "include \"q1.beancount\"\n"
+            "2020-03-01 note Expenses:Food \"2020\"\n");
+  dir.Write("years/q1.beancount", "2020-01-05 note Assets:Cash \"q1\"\n");
+
+  ThreadPool pool(2);
+  Ledger ledger;
+  DisplayContext dcontext;
+  Loader loader(&ledger, &dcontext, &pool);
+  ASSERT_TRUE(loader.Load(main).ok());
+
+  // Each file, then what it includes, depth first; directives by file.
+  std::vector<string> narrations = {"main", "main end", "bank", "2020", "q1"};
+  EXPECT_EQ(narrations, Narrations(ledger));
+  ASSERT_EQ(4, loader.files().size());
+  EXPECT_TRUE(absl::EndsWith(loader.files()[2], "/years/2020.beancount"));
+  EXPECT_TRUE(absl::EndsWith(loader.files()[3], "/years/q1.beancount"));
+  // Accounts in that order too.
+  ASSERT_EQ(3, ledger.num_accounts());
+  EXPECT_EQ("Assets:Cash", ledger.AccountName(0));
+  EXPECT_EQ("Assets:Bank", ledger.AccountName(1));
+  EXPECT_EQ("Expenses:Food", ledger.AccountName(2));
+
+  ASSERT_EQ(1, loader.errors().size());
+  EXPECT_EQ("bank.beancount:2:29: expected end of line, got keyword 'usd'",
+            ErrorString(loader.errors()[0], dir));
+  ASSERT_EQ(1, loader.options().size());
+  EXPECT_EQ("title", loader.options()[0].name);
+}
+
+TEST(TestLoader, CyclesAndDuplicates) {
+  LedgerDir dir;
+  string main = dir.Write("main.beancount",
+                          "include \"a.beancount\"\n"
+                          "include \"b.beancount\"\n"
+                          "include \"./a.beancount\"\n"
+                          "include \"missing.beancount\"\n");
+  dir.Write("a.beancount",
+            "2020-01-01 note Assets:Cash \"a\"\n"
+            "include \"b.beancount\"\n");
+  dir.Write("b.beancount",
+            "2020-01-01 note Assets:Cash \"b\"\n"
+            "include \"main.beancount\"\n");
+
+  // The same outcome whatever the reader and how many threads.
+  for (int threads : {1, 4}) {
+    for (bool uring : {false, true}) {
+      ThreadPool pool(threads);
+      std::unique_ptr<FileReader> reader =
+          uring ? FileReader::CreateIoUring() : FileReader::CreatePread(&pool);
+      if (reader == nullptr) continue;
+      SCOPED_TRACE(absl::StrCat(reader->name(), " ", threads));
+      Ledger ledger;
+      Loader loader(&ledger, nullptr, &pool);
+      loader.set_file_reader(std::move(reader));
+      ASSERT_TRUE(loader.Load(main).ok());
+
+      std::vector<string> narrations = {"a", "b"};
+      EXPECT_EQ(narrations, Narrations(ledger));
+      ASSERT_EQ(3, loader.files().size());
+      std::vector<string> errors;
+      for (const LoadError &error : loader.errors()) {
+        errors.push_back(ErrorString(error, dir));
+      }
+      ASSERT_EQ(4, errors.size());
+      // By file, then by line.
+      EXPECT_TRUE(absl::StartsWith(errors[0], "main.beancount:2:1: "));
+      EXPECT_TRUE(absl::EndsWith(errors[0], "b.beancount is already included"));
+      EXPECT_TRUE(absl::StartsWith(errors[1], "main.beancount:3:1: "));
+      EXPECT_TRUE(absl::EndsWith(errors[1], "a.beancount is already included"));
+      EXPECT_TRUE(absl::StartsWith(errors[2], "main.beancount:4:1: "));
+      EXPECT_TRUE(absl::EndsWith(errors[2], "No such file or directory"));
+      EXPECT_TRUE(absl::StartsWith(errors[3], "b.beancount:2:1: include of "));
+      EXPECT_TRUE(absl::EndsWith(errors[3], "main.beancount makes a cycle"));
+    }
+  }
+}
+
+TEST(TestLoader, MissingFile) {
+  ThreadPool pool(1);
+  Ledger ledger;
+  Loader loader(&ledger, nullptr, &pool);
+  EXPECT_EQ(absl::StatusCode::kNotFound,
+            loader.Load("/nonexistent/ledger").code());
+}
+
+}  // namespace
+}  // namespace beanquick
@@ -0,0 +1,82 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "beanquick/core/mapped_file.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "absl/strings/str_cat.h"
+
+namespace beanquick {
+
+namespace {
+absl::Status ErrnoError(absl::string_view what, const string &filename) {
+  string message =
+      absl::StrCat(what, " ", filename, ": ", std::strerror(errno));
+  if (errno == ENOENT) return absl::NotFoundError(message);
+  return absl::InternalError(message);
+}
+}  // namespace
+
+absl::Status MappedFile::Open(const string &filename,
+                              std::unique_ptr<MappedFile> *out) {
+  int fd;
+  do {
+    fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  } while (fd < 0 && errno == EINTR);
+  if (fd < 0) return ErrnoError("open", filename);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    absl::Status status = ErrnoError("stat", filename);
+    close(fd);
+    return status;
+  }
+  if (!S_ISREG(st.st_mode)) {
+    close(fd);
+    return absl::InvalidArgumentError(
+        absl::StrCat(filename, " is not a regular file"));
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  const char *data = nullptr;
+  if (size > 0) {
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+      absl::Status status = ErrnoError("mmap", filename);
+      close(fd);
+      return status;
+    }
+    // Ledgers are read front to back, let the kernel read ahead further.
+    madvise(addr, size, MADV_SEQUENTIAL);
+    data = static_cast<const char *>(addr);
+  }
+  // The mapping holds its own reference to the file.
+  close(fd);
+  out->reset(new MappedFile(filename, data, size));
+  return absl::OkStatus();
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) munmap(const_cast<char *>(data_), size_);
+}
+
+}  // namespace beanquick
@@ -0,0 +1,63 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef DEANQUICK_MAPPED_FILE_H_
+#define DEANQUICK_MAPPED_FILE_H_
+
+#include <memory>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "beanquick/core/base.h"
+
+namespace beanquick {
+
+// -----------------------------------------------------------------------------
+// MappedFile Definition.
+// -----------------------------------------------------------------------------
+// The contents of a file mapped read only into memory, so that it can be
+// tokenized in place. The text stays valid until the MappedFile is
+// destroyed. Note it is not NUL terminated.
+class MappedFile {
+ public:
+  // Maps `filename` into `out`. Returns NotFound when it doesn't exist,
+  // InvalidArgument when it isn't a regular file and Internal for other
+  // failures.
+  static absl::Status Open(const string &filename,
+                           std::unique_ptr<MappedFile> *out);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  absl::string_view text() const { return absl::string_view(data_, size_); }
+
+  const string &filename() const { return filename_; }
+
+ private:
+  MappedFile(const string &filename, const char *data, size_t size)
+      : filename_(filename), data_(data), size_(size) {}
+
+  string filename_;
+  // Null for an empty file, which can't be mapped.
+  const char *data_;
+  size_t size_;
+};
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_MAPPED_FILE_H_
@@ -0,0 +1,44 @@
+#include "mapped_file.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <memory>
+
+#include "beanquick/core/test_util.h"
+#include "gtest/gtest.h"
+
+namespace beanquick {
+namespace {
+
+TEST(TestMappedFile, Open) {
+  string filename = WriteTempFile("2020-01-01 open Assets:Cash\n");
+  std::unique_ptr<MappedFile> file;
+  ASSERT_TRUE(MappedFile::Open(filename, &file).ok());
+  EXPECT_EQ("2020-01-01 open Assets:Cash\n", file->text());
+  EXPECT_EQ(filename, file->filename());
+  unlink(filename.c_str());
+
+  // Still readable once unlinked.
+  EXPECT_EQ("2020-01-01 open Assets:Cash\n", file->text());
+}
+
+TEST(TestMappedFile, Empty) {
+  string filename = WriteTempFile("");
+  std::unique_ptr<MappedFile> file;
+  ASSERT_TRUE(MappedFile::Open(filename, &file).ok());
+  EXPECT_TRUE(file->text().empty());
+  unlink(filename.c_str());
+}
+
+TEST(TestMappedFile, Errors) {
+  std::unique_ptr<MappedFile> file;
+  absl::Status status = MappedFile::Open("/nonexistent/ledger", &file);
+  EXPECT_EQ(absl::StatusCode::kNotFound, status.code());
+  EXPECT_EQ(nullptr, file);
+  status = MappedFile::Open("/tmp", &file);
+  EXPECT_EQ(absl::StatusCode::kInvalidArgument, status.code());
+}
+
+}  // namespace
+}  // namespace beanquick
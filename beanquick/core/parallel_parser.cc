@@ -0,0 +1,178 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#include "beanquick/core/parallel_parser.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/match.h"
+#include "beanquick/core/mapped_file.h"
+
+namespace beanquick {
+
+constexpr size_t ParallelParser::kMinChunkSize;
+
+namespace {
+
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Whether the line at `pos` starts with a date, YYYY-MM-DD or YYYY/MM/DD.
+bool IsDatedLine(absl::string_view text, size_t pos) {
+  if (text.size() - pos < 5) return false;
+  const char *p = text.data() + pos;
+  return IsDigit(p[0]) && IsDigit(p[1]) && IsDigit(p[2]) && IsDigit(p[3]) &&
+         (p[4] == '-' || p[4] == '/');
+}
+
+// Returns where the line after `pos` starts, text.size() if there is none.
+size_t NextLine(absl::string_view text, size_t pos) {
+  const void *eol = memchr(text.data() + pos, '\n', text.size() - pos);
+  if (eol == nullptr) return text.size();
+  return static_cast<const char *>(eol) - text.data() + 1;
+}
+
+}  // namespace
+
+// The text of a chunk and what parsing it gives.
+struct ParallelParser::Chunk {
+  absl::string_view text;
+  int num_lines = 0;
+  // The pushtag, poptag, pushmeta and popmeta lines, in order.
+  std::vector<absl::string_view> push_lines;
+
+  // All but the first chunk go to a ledger and display context of their own.
+  std::unique_ptr<Ledger> ledger;
+  DisplayContext dcontext;
+  std::unique_ptr<Parser> parser;
+  std::vector<AccountId> account_ids;
+};
+
+// -----------------------------------------------------------------------------
+// ParallelParser Implementation.
+// -----------------------------------------------------------------------------
+ParallelParser::ParallelParser(Ledger *ledger, DisplayContext *dcontext,
+                               ThreadPool *pool)
+    : ledger_(ledger), dcontext_(dcontext), pool_(pool), state_(ledger) {}
+
+absl::Status ParallelParser::ParseFile(const string &filename) {
+  std::unique_ptr<MappedFile> file;
+  absl::Status status = MappedFile::Open(filename, &file);
+  if (!status.ok()) return status;
+  Parse(ledger_->Adopt(std::move(file))->text());
+  return absl::OkStatus();
+}
+
+std::vector<size_t> ParallelParser::SplitPoints(absl::string_view text) const {
+  size_t count = std::max<size_t>(text.size() / min_chunk_size_, 1);
+  count = std::min<size_t>(count, std::max(pool_->num_threads(), 1) * 4);
+  std::vector<size_t> starts = {0};
+  for (size_t i = 1; i < count; i++) {
+    // The first dated line from the target size on.
+    size_t pos = std::max(text.size() / count * i, starts.back() + 1);
+    if (pos < text.size() && text[pos - 1] != '\n') pos = NextLine(text, pos);
+    while (pos < text.size() && !IsDatedLine(text, pos)) {
+      pos = NextLine(text, pos);
+    }
+    if (pos >= text.size()) break;
+    starts.push_back(pos);
+  }
+  return starts;
+}
+
+void ParallelParser::Parse(absl::string_view text) {
+  std::vector<size_t> starts = SplitPoints(text);
+  num_chunks_ = static_cast<int>(starts.size());
+  std::vector<Chunk> chunks(starts.size());
+  for (size_t i = 0; i < chunks.size(); i++) {
+    size_t end = i + 1 < starts.size() ? starts[i + 1] : text.size();
+    chunks[i].text = text.substr(starts[i], end - starts[i]);
+  }
+
+  // Lines are numbered from the start of the text, so each chunk needs the
+  // count of those before it. The lines that push or pop state are rare,
+  // found on the way.
+  pool_->ForEach(num_chunks_, [&chunks](int i) {
+    Chunk &chunk = chunks[i];
+    absl::string_view text = chunk.text;
+    for (size_t pos = 0; pos < text.size();) {
+      size_t next = NextLine(text, pos);
+      if (text[pos] == 'p' && (absl::StartsWith(text.substr(pos), "push") ||
+                               absl::StartsWith(text.substr(pos), "pop"))) {
+        chunk.push_lines.push_back(text.substr(pos, next - pos));
+      }
+      chunk.num_lines++;
+      pos = next;
+    }
+  });
+
+  // Replay them to start each parser with the state of the text before it.
+  for (Chunk &chunk : chunks) {
+    if (&chunk == &chunks[0]) {
+      chunk.parser.reset(new Parser(ledger_, dcontext_));
+    }
+    else {
+      chunk.ledger.reset(new Ledger);
+      chunk.parser.reset(new Parser(chunk.ledger.get(), &chunk.dcontext));
+    }
+    chunk.parser->ContinueFrom(state_);
+    for (absl::string_view line : chunk.push_lines) state_.Parse(line);
+  }
+
+  pool_->ForEach(num_chunks_,
+                 [&chunks](int i) { chunks[i].parser->Parse(chunks[i].text); });
+
+  // Accounts are interned in the same order as a single parser would, then
+  // the directives of each chunk are moved over to the ids of the ledger.
+  for (size_t i = 1; i < chunks.size(); i++) {
+    chunks[i].account_ids = ledger_->InternAccounts(*chunks[i].ledger);
+  }
+  pool_->ForEach(num_chunks_, [&chunks](int i) {
+    if (i > 0) chunks[i].ledger->RemapAccounts(chunks[i].account_ids);
+  });
+
+  int lines_before = 0;
+  for (size_t i = 0; i < chunks.size(); i++) {
+    Chunk &chunk = chunks[i];
+    if (i > 0) {
+      ledger_->Splice(std::move(chunk.ledger));
+      if (dcontext_ != nullptr) dcontext_->Merge(chunk.dcontext);
+    }
+    for (ParseError error : chunk.parser->errors()) {
+      error.line += lines_before;
+      errors_.push_back(std::move(error));
+    }
+    for (Include include : chunk.parser->includes()) {
+      include.line += lines_before;
+      includes_.push_back(include);
+    }
+    for (Option option : chunk.parser->options()) {
+      option.line += lines_before;
+      options_.push_back(option);
+    }
+    for (Option plugin : chunk.parser->plugins()) {
+      plugin.line += lines_before;
+      plugins_.push_back(plugin);
+    }
+    lines_before += chunk.num_lines;
+  }
+}
+
+}  // namespace beanquick
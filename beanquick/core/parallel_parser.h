@@ -0,0 +1,98 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef DEANQUICK_PARALLEL_PARSER_H_
+#define DEANQUICK_PARALLEL_PARSER_H_
+
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "beanquick/core/directive.h"
+#include "beanquick/core/display_context.h"
+#include "beanquick/core/parser.h"
+#include "beanquick/core/thread_pool.h"
+
+namespace beanquick {
+
+// -----------------------------------------------------------------------------
+// ParallelParser Definition.
+// -----------------------------------------------------------------------------
+// Parses large ledger text on the threads of a ThreadPool, with the same
+// outcome as a Parser: the same directives in the same order, the same
+// account ids, errors, includes and options with the same line numbers.
+//
+// The text is split into chunks at lines starting with a date, which only
+// directives do. Each chunk is parsed by its own Parser into a ledger of its
+// own, starting from the tags and metadata the chunks before it push, and
+// the ledgers are spliced into the target one in order. A dated line inside
+// a multi-line string would be taken for the start of a directive, so such
+// text must go to a Parser instead.
+//
+//   ThreadPool pool;
+//   ParallelParser parser(&ledger, &dcontext, &pool);
+//   absl::Status status = parser.ParseFile("main.beancount");
+class ParallelParser {
+ public:
+  // Chunks smaller than this don't pay for their setup and merging.
+  static constexpr size_t kMinChunkSize = 1 << 20;
+
+  ParallelParser(Ledger *ledger, DisplayContext *dcontext, ThreadPool *pool);
+
+  ParallelParser(const ParallelParser &) = delete;
+  ParallelParser &operator=(const ParallelParser &) = delete;
+
+  // Same as Parser::Parse() and Parser::ParseFile().
+  void Parse(absl::string_view text);
+  absl::Status ParseFile(const string &filename);
+
+  const std::vector<ParseError> &errors() const { return errors_; }
+  const std::vector<Include> &includes() const { return includes_; }
+  const std::vector<Option> &options() const { return options_; }
+  const std::vector<Option> &plugins() const { return plugins_; }
+
+  // For tests, to split small text.
+  void set_min_chunk_size(size_t size) { min_chunk_size_ = size; }
+
+  // How many chunks the last Parse() split the text into.
+  int num_chunks() const { return num_chunks_; }
+
+ private:
+  struct Chunk;
+
+  // Returns where the chunks of `text` start, the first at 0.
+  std::vector<size_t> SplitPoints(absl::string_view text) const;
+
+  Ledger *ledger_;
+  DisplayContext *dcontext_;
+  ThreadPool *pool_;
+  size_t min_chunk_size_ = kMinChunkSize;
+  int num_chunks_ = 0;
+
+  // Parses only the pushtag, poptag, pushmeta and popmeta lines, to know
+  // what each chunk starts with.
+  Parser state_;
+
+  std::vector<ParseError> errors_;
+  std::vector<Include> includes_;
+  std::vector<Option> options_;
+  std::vector<Option> plugins_;
+};
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_PARALLEL_PARSER_H_
@@ -0,0 +1,129 @@
+#include "parallel_parser.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "directive_proto.h"
+#include "gtest/gtest.h"
+
+namespace beanquick {
+namespace {
+
+string ErrorString(const ParseError &error) {
+  return absl::StrCat(error.line, ":", error.column, ": ",
+                      error.status.message());
+}
+
+// A ledger of `days` days, with tags and metadata pushed across days, some
+// errors and options, and accounts showing up along the way.
+string TestLedger(int days) {
+  string text = "option \"title\" \"Test\"\n2020-01-01 open Assets:Cash\n";
+  for (int i = 0; i < days; i++) {
+    string date =
+        absl::StrFormat("2020-%02d-%02d", 1 + i / 28 % 12, 1 + i % 28);
+    if (i % 10 == 0) absl::StrAppend(&text, "pushtag #week", i / 10, "\n");
+    if (i % 10 == 9) absl::StrAppend(&text, "poptag #week", i / 10, "\n");
+    if (i % 25 == 0) absl::StrAppend(&text, "pushmeta batch: ", i, "\n");
+    if (i % 25 == 24) absl::StrAppend(&text, "popmeta batch:\n");
+    absl::StrAppend(&text, date, " * \"Shop\" \"Day ", i, "\"\n",
+                    "  Expenses:Shop", i % 13, "  ", i, ".", i % 7,
+                    " USD\n  Assets:Cash\n\n");
+    if (i % 17 == 0) absl::StrAppend(&text, date, " open Assets:Bad usd\n");
+    if (i % 31 == 0) {
+      absl::StrAppend(&text, "include \"day", i, ".beancount\"\n");
+    }
+  }
+  return text;
+}
+
+TEST(TestParallelParser, SameAsParser) {
+  const string text = TestLedger(400);
+
+  Ledger expected;
+  DisplayContext expected_dcontext;
+  Parser parser(&expected, &expected_dcontext);
+  parser.Parse(text);
+
+  ThreadPool pool(3);
+  Ledger ledger;
+  DisplayContext dcontext;
+  ParallelParser parallel(&ledger, &dcontext, &pool);
+  parallel.set_min_chunk_size(1000);
+  parallel.Parse(text);
+  EXPECT_EQ(12, parallel.num_chunks());
+
+  ASSERT_EQ(expected.directives().size(), ledger.directives().size());
+  ASSERT_EQ(expected.num_accounts(), ledger.num_accounts());
+  for (int i = 0; i < ledger.num_accounts(); i++) {
+    EXPECT_EQ(expected.AccountName(i), ledger.AccountName(i));
+  }
+  for (size_t i = 0; i < ledger.directives().size(); i++) {
+    pb::Directive want, got;
+    DirectiveToProto(expected, *expected.directives()[i], &want);
+    DirectiveToProto(ledger, *ledger.directives()[i], &got);
+    EXPECT_EQ(want.DebugString(), got.DebugString()) << "directive " << i;
+  }
+
+  ASSERT_FALSE(parser.errors().empty());
+  ASSERT_EQ(parser.errors().size(), parallel.errors().size());
+  for (size_t i = 0; i < parser.errors().size(); i++) {
+    EXPECT_EQ(ErrorString(parser.errors()[i]),
+              ErrorString(parallel.errors()[i]));
+  }
+  ASSERT_EQ(parser.includes().size(), parallel.includes().size());
+  for (size_t i = 0; i < parser.includes().size(); i++) {
+    EXPECT_EQ(parser.includes()[i].line, parallel.includes()[i].line);
+    EXPECT_EQ(parser.includes()[i].filename, parallel.includes()[i].filename);
+  }
+  ASSERT_EQ(1, parallel.options().size());
+  EXPECT_EQ("title", parallel.options()[0].name);
+
+  CurrencyId usd = InternCurrency("USD");
+  for (DisplayPrecision precision :
+       {DisplayPrecision::MOST_COMMON, DisplayPrecision::MAXIMUM}) {
+    EXPECT_EQ(expected_dcontext.Fractional(usd, precision),
+              dcontext.Fractional(usd, precision));
+  }
+}
+
+TEST(TestParallelParser, SplitsAtDatedLines) {
+  ThreadPool pool(2);
+  Ledger ledger;
+  ParallelParser parser(&ledger, nullptr, &pool);
+  parser.set_min_chunk_size(10);
+  // Nowhere to split but before the second transaction.
+  parser.Parse(
+      "2020-01-01 * \"One\"\n"
+      "  Assets:Cash  1 USD\n"
+      "  Income:Job\n"
+      "2020-01-02 * \"Two\"\n"
+      "  Assets:Cash  2 USD\n"
+      "  Income:Job\n");
+  EXPECT_EQ(2, parser.num_chunks());
+  EXPECT_TRUE(parser.errors().empty());
+  ASSERT_EQ(2, ledger.directives().size());
+  const Transaction *txn = ledger.directives()[1]->As<Transaction>();
+  ASSERT_NE(nullptr, txn);
+  EXPECT_EQ("Two", txn->narration);
+  EXPECT_EQ("Income:Job", ledger.AccountName(txn->postings[1].account));
+  EXPECT_EQ(2, ledger.num_accounts());
+}
+
+TEST(TestParallelParser, PushedStateLastsAcrossCalls) {
+  ThreadPool pool(2);
+  Ledger ledger;
+  ParallelParser parser(&ledger, nullptr, &pool);
+  parser.Parse("pushtag #trip\n");
+  parser.Parse("2020-01-01 note Assets:Cash \"Hi\"\n"
+               "2020-01-02 * \"Taxi\"\n"
+               "  Expenses:Taxi  5 USD\n"
+               "  Assets:Cash\n");
+  EXPECT_TRUE(parser.errors().empty());
+  ASSERT_EQ(2, ledger.directives().size());
+  const Transaction *txn = ledger.directives()[1]->As<Transaction>();
+  ASSERT_NE(nullptr, txn);
+  ASSERT_EQ(1, txn->tags.size());
+  EXPECT_EQ("trip", txn->tags[0]);
+}
+
+}  // namespace
+}  // namespace beanquick
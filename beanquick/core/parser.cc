@@ -0,0 +1,793 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "beanquick/core/parser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "beanquick/core/mapped_file.h"
+
+namespace beanquick {
+
+namespace {
+enum class Keyword {
+  kUnknown,
+  kOpen,
+  kClose,
+  kCommodity,
+  kPad,
+  kBalance,
+  kNote,
+  kEvent,
+  kQuery,
+  kPrice,
+  kDocument,
+  kCustom,
+};
+
+Keyword ToKeyword(absl::string_view text) {
+  static const std::pair<const char *, Keyword> kKeywords[] = {
+      {"open", Keyword::kOpen},       {"close", Keyword::kClose},
+      {"commodity", Keyword::kCommodity}, {"pad", Keyword::kPad},
+      {"balance", Keyword::kBalance}, {"note", Keyword::kNote},
+      {"event", Keyword::kEvent},     {"query", Keyword::kQuery},
+      {"price", Keyword::kPrice},     {"document", Keyword::kDocument},
+      {"custom", Keyword::kCustom},
+  };
+  for (const auto &it : kKeywords) {
+    if (text == it.first) return it.second;
+  }
+  return Keyword::kUnknown;
+}
+
+bool ToBooking(absl::string_view text, Booking *booking) {
+  static const std::pair<const char *, Booking> kBookings[] = {
+      {"STRICT", Booking::kStrict}, {"NONE", Booking::kNone},
+      {"AVERAGE", Booking::kAverage}, {"FIFO", Booking::kFifo},
+      {"LIFO", Booking::kLifo},
+  };
+  for (const auto &it : kBookings) {
+    if (text == it.first) {
+      *booking = it.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Parses the 1 or 2 digits of a month or a day.
+bool ParseField(absl::string_view text, int *value) {
+  if (text.empty() || text.size() > 2) return false;
+  *value = 0;
+  for (char c : text) {
+    if (c < '0' || c > '9') return false;
+    *value = *value * 10 + (c - '0');
+  }
+  return true;
+}
+
+inline bool IsEnd(const Token &token) {
+  return token.kind == TokenKind::kEol || token.kind == TokenKind::kEof;
+}
+}  // namespace
+
+// -----------------------------------------------------------------------------
+// Parser Implementation.
+// -----------------------------------------------------------------------------
+constexpr int Parser::kAccountCacheBits;
+
+Parser::Parser(Ledger *ledger, DisplayContext *dcontext)
+    : ledger_(ledger),
+      dcontext_(dcontext),
+      account_cache_(1 << kAccountCacheBits) {}
+
+absl::Status Parser::ParseFile(const string &filename) {
+  std::unique_ptr<MappedFile> file;
+  absl::Status status = MappedFile::Open(filename, &file);
+  if (!status.ok()) return status;
+  Parse(ledger_->Adopt(std::move(file))->text());
+  return absl::OkStatus();
+}
+
+void Parser::Parse(absl::string_view text) {
+  Lexer lexer(text);
+  lexer_ = &lexer;
+  Advance();
+  while (token_.kind != TokenKind::kEof) {
+    directive_token_ = token_;
+    absl::Status status = ParseEntry();
+    if (!status.ok()) {
+      AddError(status);
+      SkipDirective();
+    }
+  }
+  lexer_ = nullptr;
+  // The cached symbol points into `text`.
+  last_symbol_ = absl::string_view();
+  last_id_ = kNoCurrency;
+}
+
+void Parser::AddError(const absl::Status &status) {
+  // Past the end of the text, blame the directive.
+  const Token &token =
+      token_.kind == TokenKind::kEof ? directive_token_ : token_;
+  ParseError error;
+  error.line = token.line;
+  error.column = lexer_->Column(token);
+  error.status = status;
+  errors_.push_back(std::move(error));
+}
+
+void Parser::SkipDirective() {
+  do {
+    while (!IsEnd(token_)) Advance();
+    if (token_.kind == TokenKind::kEol) Advance();
+  } while (token_.kind == TokenKind::kIndent);
+}
+
+absl::Status Parser::Unexpected(absl::string_view expected) {
+  if (IsEnd(token_) || token_.kind == TokenKind::kIndent) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "expected ", expected, ", got ", TokenKindName(token_.kind)));
+  }
+  return absl::InvalidArgumentError(
+      absl::StrCat("expected ", expected, ", got ",
+                   TokenKindName(token_.kind), " '", token_.text, "'"));
+}
+
+absl::Status Parser::Expect(TokenKind kind) {
+  if (token_.kind != kind) return Unexpected(TokenKindName(kind));
+  Advance();
+  return absl::OkStatus();
+}
+
+absl::Status Parser::ExpectEol() {
+  if (token_.kind == TokenKind::kEol) {
+    Advance();
+    return absl::OkStatus();
+  }
+  if (token_.kind == TokenKind::kEof) return absl::OkStatus();
+  return Unexpected("end of line");
+}
+
+absl::Status Parser::ParseEntry() {
+  switch (token_.kind) {
+    case TokenKind::kDate:
+      return ParseDated();
+    case TokenKind::kKeyword:
+      return ParseUndated();
+    case TokenKind::kIndent:
+      Advance();
+      return absl::InvalidArgumentError("indented line outside a directive");
+    default:
+      return Unexpected("a date or a keyword");
+  }
+}
+
+absl::Status Parser::ParseDated() {
+  Date date;
+  absl::Status status = ParseDate(&date);
+  if (!status.ok()) return status;
+  if (token_.kind == TokenKind::kFlag ||
+      (token_.kind == TokenKind::kKeyword && token_.text == "txn")) {
+    return ParseTransaction(date);
+  }
+  if (token_.kind != TokenKind::kKeyword) {
+    return Unexpected("a flag or a directive");
+  }
+  Keyword keyword = ToKeyword(token_.text);
+  if (keyword == Keyword::kUnknown) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("unknown directive '", token_.text, "'"));
+  }
+  Advance();
+
+  switch (keyword) {
+    case Keyword::kOpen:
+      return ParseOpen(date);
+    case Keyword::kBalance:
+      return ParseBalance(date);
+    case Keyword::kCustom:
+      return ParseCustom(date);
+    case Keyword::kClose: {
+      Close *close = ledger_->New<Close>(date);
+      status = ParseAccount(&close->account);
+      if (!status.ok()) return status;
+      status = ExpectEol();
+      if (!status.ok()) return status;
+      return FinishDirective(close);
+    }
+    case Keyword::kCommodity: {
+      Commodity *commodity = ledger_->New<Commodity>(date);
+      status = ParseCurrency(&commodity->currency);
+      if (!status.ok()) return status;
+      status = ExpectEol();
+      if (!status.ok()) return status;
+      return FinishDirective(commodity);
+    }
+    case Keyword::kPad: {
+      Pad *pad = ledger_->New<Pad>(date);
+      status = ParseAccount(&pad->account);
+      if (!status.ok()) return status;
+      status = ParseAccount(&pad->source_account);
+      if (!status.ok()) return status;
+      status = ExpectEol();
+      if (!status.ok()) return status;
+      return FinishDirective(pad);
+    }
+    case Keyword::kNote: {
+      Note *note = ledger_->New<Note>(date);
+      status = ParseAccount(&note->account);
+      if (!status.ok()) return status;
+      status = ParseString(&note->comment);
+      if (!status.ok()) return status;
+      status = ExpectEol();
+      if (!status.ok()) return status;
+      return FinishDirective(note);
+    }
+    case Keyword::kEvent: {
+      Event *event = ledger_->New<Event>(date);
+      status = ParseString(&event->event_type);
+      if (!status.ok()) return status;
+      status = ParseString(&event->description);
+      if (!status.ok()) return status;
+      status = ExpectEol();
+      if (!status.ok()) return status;
+      return FinishDirective(event);
+    }
+    case Keyword::kQuery: {
+      Query *query = ledger_->New<Query>(date);
+      status = ParseString(&query->name);
+      if (!status.ok()) return status;
+      status = ParseString(&query->query_string);
+      if (!status.ok()) return status;
+      status = ExpectEol();
+      if (!status.ok()) return status;
+      return FinishDirective(query);
+    }
+    case Keyword::kPrice: {
+      Price *price = ledger_->New<Price>(date);
+      status = ParseCurrency(&price->currency);
+      if (!status.ok()) return status;
+      Amount amount(Decimal(), kNoCurrency);
+      status = ParseAmount(&amount);
+      if (!status.ok()) return status;
+      ledger_->SetAmount(&price->amount, amount);
+      status = ExpectEol();
+      if (!status.ok()) return status;
+      return FinishDirective(price);
+    }
+    case Keyword::kDocument: {
+      Document *document = ledger_->New<Document>(date);
+      status = ParseAccount(&document->account);
+      if (!status.ok()) return status;
+      status = ParseString(&document->filename);
+      if (!status.ok()) return status;
+      tags_.clear();
+      links_.clear();
+      status = ParseTagsAndLinks();
+      if (!status.ok()) return status;
+      status = ExpectEol();
+      if (!status.ok()) return status;
+      document->tags = ledger_->CopyArray<absl::string_view>(tags_);
+      document->links = ledger_->CopyArray<absl::string_view>(links_);
+      return FinishDirective(document);
+    }
+    default:
+      break;
+  }
+  return absl::InternalError("unhandled directive");
+}
+
+absl::Status Parser::ParseUndated() {
+  absl::string_view keyword = token_.text;
+  int line = token_.line;
+  absl::Status status;
+  if (keyword == "option" || keyword == "plugin") {
+    Advance();
+    Option option;
+    option.line = line;
+    status = ParseString(&option.name);
+    if (!status.ok()) return status;
+    if (keyword == "option" || token_.kind == TokenKind::kString) {
+      status = ParseString(&option.value);
+      if (!status.ok()) return status;
+    }
+    (keyword == "option" ? options_ : plugins_).push_back(option);
+  }
+  else if (keyword == "include") {
+    Advance();
+    Include include;
+    include.line = line;
+    status = ParseString(&include.filename);
+    if (!status.ok()) return status;
+    includes_.push_back(include);
+  }
+  else if (keyword == "pushtag" || keyword == "poptag") {
+    Advance();
+    if (token_.kind != TokenKind::kTag) return Unexpected("a tag");
+    absl::string_view tag = token_.text.substr(1);
+    if (keyword == "pushtag") {
+      pushed_tags_.push_back(tag);
+    }
+    else {
+      auto it = std::find(pushed_tags_.rbegin(), pushed_tags_.rend(), tag);
+      if (it == pushed_tags_.rend()) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("tag '", tag, "' was never pushed"));
+      }
+      pushed_tags_.erase(std::next(it).base());
+    }
+    Advance();
+  }
+  else if (keyword == "pushmeta") {
+    Advance();
+    // Consumes the end of the line.
+    return ParseMetaEntry(&pushed_meta_);
+  }
+  else if (keyword == "popmeta") {
+    Advance();
+    if (token_.kind != TokenKind::kKey) return Unexpected("a metadata key");
+    absl::string_view key = token_.text.substr(0, token_.text.size() - 1);
+    auto it = std::find_if(
+        pushed_meta_.rbegin(), pushed_meta_.rend(),
+        [key](const MetaEntry &entry) { return entry.key == key; });
+    if (it == pushed_meta_.rend()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("metadata '", key, "' was never pushed"));
+    }
+    pushed_meta_.erase(std::next(it).base());
+    Advance();
+  }
+  else {
+    return absl::InvalidArgumentError(
+        absl::StrCat("unknown keyword '", keyword, "'"));
+  }
+  return ExpectEol();
+}
+
+absl::Status Parser::ParseTransaction(Date date) {
+  Transaction *txn = ledger_->New<Transaction>(date);
+  txn->flag = token_.kind == TokenKind::kFlag ? token_.text[0] : '*';
+  Advance();
+  absl::Status status;
+  if (token_.kind == TokenKind::kString) {
+    status = ParseString(&txn->narration);
+    if (!status.ok()) return status;
+    if (token_.kind == TokenKind::kString) {
+      txn->payee = txn->narration;
+      status = ParseString(&txn->narration);
+      if (!status.ok()) return status;
+    }
+  }
+  tags_.assign(pushed_tags_.begin(), pushed_tags_.end());
+  links_.clear();
+  status = ParseTagsAndLinks();
+  if (!status.ok()) return status;
+  status = ExpectEol();
+  if (!status.ok()) return status;
+
+  // Postings, and metadata of the transaction up to the first of them, then
+  // of the posting above.
+  postings_.clear();
+  meta_.clear();
+  posting_meta_.clear();
+  while (token_.kind == TokenKind::kIndent) {
+    Advance();
+    if (token_.kind == TokenKind::kKey) {
+      status = ParseMetaEntry(postings_.empty() ? &meta_ : &posting_meta_);
+    }
+    else {
+      if (!postings_.empty()) {
+        postings_.back().meta = CopyMeta(&posting_meta_);
+      }
+      postings_.emplace_back();
+      status = ParsePosting(&postings_.back());
+    }
+    if (!status.ok()) return status;
+  }
+  if (!postings_.empty()) postings_.back().meta = CopyMeta(&posting_meta_);
+
+  absl::Span<Posting> postings = ledger_->NewArray<Posting>(postings_.size());
+  for (size_t i = 0; i < postings.size(); i++) {
+    const Posting &from = postings_[i];
+    Posting &to = postings[i];
+    to.meta = from.meta;
+    to.flag = from.flag;
+    to.account = from.account;
+    ledger_->SetAmount(&to.units, from.units);
+    ledger_->SetNumber(&to.cost.number, from.cost.number);
+    to.cost.currency = from.cost.currency;
+    to.cost.date = from.cost.date;
+    to.cost.label = from.cost.label;
+    ledger_->SetAmount(&to.price, from.price);
+  }
+  txn->postings = postings;
+  txn->tags = ledger_->CopyArray<absl::string_view>(tags_);
+  txn->links = ledger_->CopyArray<absl::string_view>(links_);
+  meta_.insert(meta_.begin(), pushed_meta_.begin(), pushed_meta_.end());
+  txn->meta = CopyMeta(&meta_);
+  ledger_->Append(txn);
+  return absl::OkStatus();
+}
+
+absl::Status Parser::ParsePosting(Posting *posting) {
+  if (token_.kind == TokenKind::kFlag) {
+    posting->flag = token_.text[0];
+    Advance();
+  }
+  absl::Status status = ParseAccount(&posting->account);
+  if (!status.ok()) return status;
+  if (token_.kind == TokenKind::kNumber) {
+    status = ParseAmount(&posting->units);
+    if (!status.ok()) return status;
+  }
+  if (token_.kind == TokenKind::kLeftCurl ||
+      token_.kind == TokenKind::kLeftCurlCurl) {
+    status = ParseCost(posting);
+    if (!status.ok()) return status;
+  }
+  if (token_.kind == TokenKind::kAt || token_.kind == TokenKind::kAtAt) {
+    bool total = token_.kind == TokenKind::kAtAt;
+    Advance();
+    status = ParseAmount(&posting->price);
+    if (!status.ok()) return status;
+    if (total) {
+      // Stored per unit.
+      if (!posting->has_units() || posting->units.Number().IsZero()) {
+        return absl::InvalidArgumentError(
+            "a total price needs a non-zero number of units");
+      }
+      Decimal units = posting->units.Number();
+      if (units.IsNegative()) units.Negate();
+      status = posting->price.CheckedDiv(units);
+      if (!status.ok()) return status;
+    }
+  }
+  return ExpectEol();
+}
+
+absl::Status Parser::ParseCost(Posting *posting) {
+  bool total = token_.kind == TokenKind::kLeftCurlCurl;
+  TokenKind end = total ? TokenKind::kRightCurlCurl : TokenKind::kRightCurl;
+  Advance();
+  PostingCost &cost = posting->cost;
+  absl::Status status;
+  bool first = true;
+  while (token_.kind != end) {
+    if (!first) {
+      status = Expect(TokenKind::kComma);
+      if (!status.ok()) return status;
+      // Allows a trailing comma.
+      if (token_.kind == end) break;
+    }
+    first = false;
+    switch (token_.kind) {
+      case TokenKind::kNumber:
+        status = ParseNumber(&cost.number);
+        if (!status.ok()) return status;
+        status = ParseCurrency(&cost.currency);
+        if (!status.ok()) return status;
+        if (dcontext_ != nullptr) dcontext_->Update(cost.number, cost.currency);
+        break;
+      case TokenKind::kDate: {
+        Date date;
+        status = ParseDate(&date);
+        cost.date = date.days();
+        break;
+      }
+      case TokenKind::kString:
+        status = ParseString(&cost.label);
+        break;
+      default:
+        return Unexpected("a cost, a date or a label");
+    }
+    if (!status.ok()) return status;
+  }
+  if (total && !cost.empty()) {
+    // Stored per unit, like total prices.
+    if (!posting->has_units() || posting->units.Number().IsZero()) {
+      return absl::InvalidArgumentError(
+          "a total cost needs a non-zero number of units");
+    }
+    Decimal units = posting->units.Number();
+    if (units.IsNegative()) units.Negate();
+    status = cost.number.CheckedDiv(units);
+    if (!status.ok()) return status;
+  }
+  Advance();
+  return absl::OkStatus();
+}
+
+absl::Status Parser::ParseOpen(Date date) {
+  Open *open = ledger_->New<Open>(date);
+  absl::Status status = ParseAccount(&open->account);
+  if (!status.ok()) return status;
+  currencies_.clear();
+  while (token_.kind == TokenKind::kCurrency) {
+    CurrencyId currency;
+    status = ParseCurrency(&currency);
+    if (!status.ok()) return status;
+    currencies_.push_back(currency);
+    if (token_.kind != TokenKind::kComma) break;
+    Advance();
+    if (token_.kind != TokenKind::kCurrency) return Unexpected("a currency");
+  }
+  if (token_.kind == TokenKind::kString) {
+    if (!ToBooking(StringValue(token_), &open->booking)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("unknown booking method ", token_.text));
+    }
+    Advance();
+  }
+  status = ExpectEol();
+  if (!status.ok()) return status;
+  open->currencies = ledger_->CopyArray<CurrencyId>(currencies_);
+  return FinishDirective(open);
+}
+
+absl::Status Parser::ParseBalance(Date date) {
+  Balance *balance = ledger_->New<Balance>(date);
+  absl::Status status = ParseAccount(&balance->account);
+  if (!status.ok()) return status;
+  Decimal number;
+  status = ParseNumber(&number);
+  if (!status.ok()) return status;
+  if (token_.kind == TokenKind::kTilde) {
+    Advance();
+    Decimal tolerance;
+    status = ParseNumber(&tolerance);
+    if (!status.ok()) return status;
+    ledger_->SetNumber(&balance->tolerance, tolerance);
+    balance->has_tolerance = true;
+  }
+  CurrencyId currency;
+  status = ParseCurrency(&currency);
+  if (!status.ok()) return status;
+  if (dcontext_ != nullptr) dcontext_->Update(number, currency);
+  ledger_->SetAmount(&balance->amount, Amount(std::move(number), currency));
+  status = ExpectEol();
+  if (!status.ok()) return status;
+  return FinishDirective(balance);
+}
+
+absl::Status Parser::ParseCustom(Date date) {
+  Custom *custom = ledger_->New<Custom>(date);
+  absl::Status status = ParseString(&custom->custom_type);
+  if (!status.ok()) return status;
+  // The values have no place in the model yet, only check they lex.
+  while (!IsEnd(token_)) {
+    if (token_.kind == TokenKind::kError) return Unexpected("a value");
+    Advance();
+  }
+  status = ExpectEol();
+  if (!status.ok()) return status;
+  return FinishDirective(custom);
+}
+
+absl::Status Parser::FinishDirective(Directive *directive) {
+  meta_.clear();
+  absl::Status status = ParseMetaLines(&meta_);
+  if (!status.ok()) return status;
+  meta_.insert(meta_.begin(), pushed_meta_.begin(), pushed_meta_.end());
+  directive->meta = CopyMeta(&meta_);
+  ledger_->Append(directive);
+  return absl::OkStatus();
+}
+
+absl::Status Parser::ParseMetaLines(std::vector<MetaEntry> *entries) {
+  while (token_.kind == TokenKind::kIndent) {
+    Advance();
+    absl::Status status = ParseMetaEntry(entries);
+    if (!status.ok()) return status;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Parser::ParseMetaEntry(std::vector<MetaEntry> *entries) {
+  if (token_.kind != TokenKind::kKey) return Unexpected("a metadata key");
+  MetaEntry entry;
+  entry.key = token_.text.substr(0, token_.text.size() - 1);
+  Advance();
+  switch (token_.kind) {
+    case TokenKind::kEol:
+    case TokenKind::kEof:
+      break;
+    case TokenKind::kString:
+      entry.value = StringValue(token_);
+      Advance();
+      break;
+    case TokenKind::kNumber: {
+      // Possibly an amount, kept as written.
+      Token number = token_;
+      Advance();
+      entry.value = number.text;
+      if (token_.kind == TokenKind::kCurrency) {
+        entry.value = absl::string_view(
+            number.text.data(),
+            token_.text.data() + token_.text.size() - number.text.data());
+        Advance();
+      }
+      break;
+    }
+    case TokenKind::kDate:
+    case TokenKind::kAccount:
+    case TokenKind::kCurrency:
+    case TokenKind::kKeyword:
+    case TokenKind::kTag:
+    case TokenKind::kLink:
+      entry.value = token_.text;
+      Advance();
+      break;
+    default:
+      return Unexpected("a metadata value");
+  }
+  absl::Status status = ExpectEol();
+  if (!status.ok()) return status;
+  entries->push_back(entry);
+  return absl::OkStatus();
+}
+
+Meta Parser::CopyMeta(std::vector<MetaEntry> *entries) {
+  Meta meta = ledger_->CopyArray<MetaEntry>(*entries);
+  entries->clear();
+  return meta;
+}
+
+absl::Status Parser::ParseTagsAndLinks() {
+  while (!IsEnd(token_)) {
+    if (token_.kind == TokenKind::kTag) {
+      tags_.push_back(token_.text.substr(1));
+    }
+    else if (token_.kind == TokenKind::kLink) {
+      links_.push_back(token_.text.substr(1));
+    }
+    else {
+      return Unexpected("a tag, a link or the end of line");
+    }
+    Advance();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Parser::ParseDate(Date *date) {
+  if (token_.kind != TokenKind::kDate) return Unexpected("a date");
+  absl::string_view text = token_.text;
+  if (!Date::Parse(text, date)) {
+    // Months and days of a single digit, or an invalid date. The lexer
+    // checked the four digits of the year and the separator.
+    int year = (text[0] - '0') * 1000 + (text[1] - '0') * 100 +
+               (text[2] - '0') * 10 + (text[3] - '0');
+    size_t second = text.find(text[4], 5);
+    int month, day;
+    if (second == absl::string_view::npos ||
+        !ParseField(text.substr(5, second - 5), &month) ||
+        !ParseField(text.substr(second + 1), &day) || year < 1 ||
+        !Date::IsValid(year, month, day)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("invalid date '", text, "'"));
+    }
+    *date = Date::FromCivil(year, month, day);
+  }
+  Advance();
+  return absl::OkStatus();
+}
+
+absl::Status Parser::ParseAccount(AccountId *account) {
+  if (token_.kind != TokenKind::kAccount) return Unexpected("an account");
+  *account = LookupAccount(token_.text);
+  Advance();
+  return absl::OkStatus();
+}
+
+absl::Status Parser::ParseCurrency(CurrencyId *currency) {
+  if (token_.kind != TokenKind::kCurrency) return Unexpected("a currency");
+  absl::Status status = LookupCurrency(token_.text, currency);
+  if (!status.ok()) return status;
+  Advance();
+  return absl::OkStatus();
+}
+
+absl::Status Parser::ParseNumber(Decimal *number) {
+  if (token_.kind != TokenKind::kNumber) return Unexpected("a number");
+  absl::Status status = Decimal::Parse(token_.text, number);
+  if (!status.ok()) return status;
+  Advance();
+  return absl::OkStatus();
+}
+
+absl::Status Parser::ParseAmount(Amount *amount) {
+  Decimal number;
+  absl::Status status = ParseNumber(&number);
+  if (!status.ok()) return status;
+  CurrencyId currency;
+  status = ParseCurrency(&currency);
+  if (!status.ok()) return status;
+  if (dcontext_ != nullptr) dcontext_->Update(number, currency);
+  *amount = Amount(std::move(number), currency);
+  return absl::OkStatus();
+}
+
+absl::Status Parser::ParseString(absl::string_view *str) {
+  if (token_.kind != TokenKind::kString) return Unexpected("a string");
+  *str = StringValue(token_);
+  Advance();
+  return absl::OkStatus();
+}
+
+absl::string_view Parser::StringValue(const Token &token) {
+  absl::string_view text = token.text.substr(1, token.text.size() - 2);
+  if (!token.escaped) return text;
+  string unescaped;
+  unescaped.reserve(text.size());
+  for (size_t i = 0; i < text.size(); i++) {
+    char c = text[i];
+    if (c == '\\' && i + 1 < text.size()) {
+      c = text[++i];
+      if (c == 'n') {
+        c = '\n';
+      }
+      else if (c == 't') {
+        c = '\t';
+      }
+    }
+    unescaped.push_back(c);
+  }
+  return ledger_->CopyString(unescaped);
+}
+
+AccountId Parser::LookupAccount(absl::string_view account) {
+  // Accounts have at least three characters, "A:B".
+  uint64 tail = 0;
+  size_t n = std::min<size_t>(account.size(), sizeof(tail));
+  std::memcpy(&tail, account.data() + account.size() - n, n);
+  size_t index = ((tail ^ account.size()) * 0x9e3779b97f4a7c15ULL) >>
+                 (64 - kAccountCacheBits);
+  AccountSlot &slot = account_cache_[index];
+  if (slot.name != account) {
+    slot.id = ledger_->InternAccount(account);
+    slot.name = ledger_->AccountName(slot.id);
+  }
+  return slot.id;
+}
+
+absl::Status Parser::LookupCurrency(absl::string_view symbol,
+                                    CurrencyId *id) {
+  if (last_id_ != kNoCurrency && symbol == last_symbol_) {
+    *id = last_id_;
+    return absl::OkStatus();
+  }
+  auto it = currency_ids_.find(symbol);
+  if (it != currency_ids_.end()) {
+    *id = it->second;
+  }
+  else {
+    if (!CurrencyTable::Global().Intern(symbol, id)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("invalid currency '", symbol, "'"));
+    }
+    currency_ids_.emplace(string(symbol), *id);
+  }
+  last_symbol_ = symbol;
+  last_id_ = *id;
+  return absl::OkStatus();
+}
+
+}  // namespace beanquick
@@ -0,0 +1,191 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef DEANQUICK_PARSER_H_
+#define DEANQUICK_PARSER_H_
+
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "beanquick/core/directive.h"
+#include "beanquick/core/display_context.h"
+#include "beanquick/core/lexer.h"
+
+namespace beanquick {
+
+// A directive the Parser couldn't parse, which it skipped.
+struct ParseError {
+  // 1 based, the column in bytes.
+  int line;
+  int column;
+  absl::Status status;
+};
+
+// An "include" of the parsed text.
+struct Include {
+  int line;
+  absl::string_view filename;
+};
+
+// An "option" or a "plugin" of the parsed text. Plugins have an empty value
+// when they are given no configuration.
+struct Option {
+  int line;
+  absl::string_view name;
+  absl::string_view value;
+};
+
+// -----------------------------------------------------------------------------
+// Parser Definition.
+// -----------------------------------------------------------------------------
+// Parses ledger text into the directives of a Ledger. Strings, metadata and
+// other text of the directives point into the parsed text rather than copies
+// of it, except for strings with escapes, which are unescaped into the
+// ledger. So the text must live as long as the ledger, which ParseFile()
+// takes care of.
+//
+// A directive with an error is skipped, up to the next line which isn't
+// indented, and recorded in errors(); parsing goes on after it. The numbers
+// of postings, prices and balances are fed to the DisplayContext if one is
+// given. Not thread safe, use one parser per thread and ledger.
+//
+//   Ledger ledger;
+//   DisplayContext dcontext;
+//   Parser parser(&ledger, &dcontext);
+//   absl::Status status = parser.ParseFile("main.beancount");
+//   for (const ParseError &error : parser.errors()) ...
+class Parser {
+ public:
+  explicit Parser(Ledger *ledger, DisplayContext *dcontext = nullptr);
+
+  Parser(const Parser &) = delete;
+  Parser &operator=(const Parser &) = delete;
+
+  // Parses `text`, appending its directives to the ledger in order.
+  void Parse(absl::string_view text);
+
+  // Starts with the tags and metadata pushed by what `other` parsed, to
+  // parse the text following it.
+  void ContinueFrom(const Parser &other) {
+    pushed_tags_ = other.pushed_tags_;
+    pushed_meta_ = other.pushed_meta_;
+  }
+
+  // The tags and metadata pushed so far, which the next directives get.
+  const std::vector<absl::string_view> &pushed_tags() const {
+    return pushed_tags_;
+  }
+  const std::vector<MetaEntry> &pushed_meta() const { return pushed_meta_; }
+
+  // Maps `filename`, hands the mapping to the ledger and parses it. Only
+  // fails when the file can't be read; parse errors go to errors().
+  absl::Status ParseFile(const string &filename);
+
+  const std::vector<ParseError> &errors() const { return errors_; }
+  const std::vector<Include> &includes() const { return includes_; }
+  const std::vector<Option> &options() const { return options_; }
+  const std::vector<Option> &plugins() const { return plugins_; }
+
+ private:
+  void Advance() { token_ = lexer_->Next(); }
+
+  // Parses the directive, or the line, at the current token.
+  absl::Status ParseEntry();
+  absl::Status ParseDated();
+  absl::Status ParseUndated();
+  absl::Status ParseTransaction(Date date);
+  absl::Status ParsePosting(Posting *posting);
+  absl::Status ParseCost(Posting *posting);
+  absl::Status ParseOpen(Date date);
+  absl::Status ParseBalance(Date date);
+  absl::Status ParseCustom(Date date);
+
+  // Parses the indented metadata lines after a directive, and the directive
+  // level of them into `meta`, then appends `directive`.
+  absl::Status FinishDirective(Directive *directive);
+  absl::Status ParseMetaLines(std::vector<MetaEntry> *entries);
+  absl::Status ParseMetaEntry(std::vector<MetaEntry> *entries);
+  Meta CopyMeta(std::vector<MetaEntry> *entries);
+
+  // Parses the token as a date, account, etc. and advances past it.
+  absl::Status ParseDate(Date *date);
+  absl::Status ParseAccount(AccountId *account);
+  absl::Status ParseCurrency(CurrencyId *currency);
+  absl::Status ParseNumber(Decimal *number);
+  absl::Status ParseAmount(Amount *amount);
+  absl::Status ParseString(absl::string_view *str);
+  // Parses tags and links until the end of the line.
+  absl::Status ParseTagsAndLinks();
+  absl::Status ExpectEol();
+  absl::Status Expect(TokenKind kind);
+
+  // Returns the text of a string token, without quotes and escapes.
+  absl::string_view StringValue(const Token &token);
+  absl::Status LookupCurrency(absl::string_view symbol, CurrencyId *id);
+  AccountId LookupAccount(absl::string_view account);
+
+  // An error at the current token.
+  absl::Status Unexpected(absl::string_view expected);
+  void AddError(const absl::Status &status);
+  // Skips the rest of the directive the current token belongs to.
+  void SkipDirective();
+
+  Ledger *ledger_;
+  DisplayContext *dcontext_;
+  Lexer *lexer_ = nullptr;
+  Token token_;
+  // Where the directive being parsed starts, errors fall back to it.
+  Token directive_token_;
+
+  std::vector<ParseError> errors_;
+  std::vector<Include> includes_;
+  std::vector<Option> options_;
+  std::vector<Option> plugins_;
+
+  // State of pushtag and pushmeta, which lasts across Parse() calls.
+  std::vector<absl::string_view> pushed_tags_;
+  std::vector<MetaEntry> pushed_meta_;
+
+  // Scratch space for the directive being parsed, reused to save
+  // allocations.
+  std::vector<Posting> postings_;
+  std::vector<MetaEntry> meta_;
+  std::vector<MetaEntry> posting_meta_;
+  std::vector<absl::string_view> tags_;
+  std::vector<absl::string_view> links_;
+  std::vector<CurrencyId> currencies_;
+
+  // A direct mapped cache in front of Ledger::InternAccount(), indexed by
+  // the length and the last bytes of names, which tell most accounts apart
+  // for much less than hashing them whole. Names point into the ledger.
+  struct AccountSlot {
+    absl::string_view name;
+    AccountId id = 0;
+  };
+  static constexpr int kAccountCacheBits = 10;
+  std::vector<AccountSlot> account_cache_;
+
+  // The last currency seen and a cache of the rest, like AmountParser.
+  absl::string_view last_symbol_;
+  CurrencyId last_id_ = kNoCurrency;
+  absl::flat_hash_map<string, CurrencyId> currency_ids_;
+};
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_PARSER_H_
@@ -0,0 +1,133 @@
+#include <map>
+#include <memory>
+
+#include "beanquick/core/benchmark_util.h"
+#include "beanquick/core/mapped_file.h"
+#include "benchmark/benchmark.h"
+#include "incremental_parser.h"
+#include "parallel_parser.h"
+#include "parser.h"
+
+namespace beanquick {
+namespace {
+
+// Generated once per size, they take a while.
+const BenchmarkLedger &LedgerFile(size_t bytes) {
+  static auto *ledgers = new std::map<size_t, std::unique_ptr<BenchmarkLedger>>;
+  std::unique_ptr<BenchmarkLedger> &ledger = (*ledgers)[bytes];
+  if (ledger == nullptr) ledger.reset(new BenchmarkLedger(bytes));
+  return *ledger;
+}
+
+void LedgerSizes(benchmark::internal::Benchmark *b) {
+  b->ArgName("MiB")->Arg(64)->Arg(1024);
+}
+
+// Tokenizing alone.
+void BM_Lex(benchmark::State &state) {
+  const BenchmarkLedger &file = LedgerFile(state.range(0) << 20);
+  std::unique_ptr<MappedFile> mapped;
+  if (!MappedFile::Open(file.filename(), &mapped).ok()) {
+    state.SkipWithError("open failed");
+    return;
+  }
+  int64 tokens = 0;
+  for (auto _ : state) {
+    Lexer lexer(mapped->text());
+    for (Token token = lexer.Next(); token.kind != TokenKind::kEof;
+         token = lexer.Next()) {
+      tokens++;
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * file.size());
+  state.counters["tokens"] = benchmark::Counter(
+      static_cast<double>(tokens), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Lex)->Apply(LedgerSizes)->Unit(benchmark::kMillisecond);
+
+// Mapping and parsing the file into a fresh ledger, with a display context,
+// then dropping the ledger.
+void BM_ParseFile(benchmark::State &state) {
+  const BenchmarkLedger &file = LedgerFile(state.range(0) << 20);
+  size_t directives = 0;
+  for (auto _ : state) {
+    Ledger ledger;
+    DisplayContext dcontext;
+    Parser parser(&ledger, &dcontext);
+    if (!parser.ParseFile(file.filename()).ok() ||
+        !parser.errors().empty()) {
+      state.SkipWithError("parse failed");
+      break;
+    }
+    directives = ledger.directives().size();
+  }
+  state.SetBytesProcessed(state.iterations() * file.size());
+  state.counters["directives"] = static_cast<double>(directives);
+}
+BENCHMARK(BM_ParseFile)->Apply(LedgerSizes)->Unit(benchmark::kMillisecond);
+
+void ParallelArgs(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"MiB", "threads"});
+  for (int mib : {64, 1024}) {
+    for (int threads : {1, 4, 8}) b->Args({mib, threads});
+  }
+}
+
+// The same with a ParallelParser. The pool is kept across iterations, as a
+// program would.
+void BM_ParallelParseFile(benchmark::State &state) {
+  const BenchmarkLedger &file = LedgerFile(state.range(0) << 20);
+  ThreadPool pool(static_cast<int>(state.range(1)));
+  size_t directives = 0;
+  for (auto _ : state) {
+    Ledger ledger;
+    DisplayContext dcontext;
+    ParallelParser parser(&ledger, &dcontext, &pool);
+    if (!parser.ParseFile(file.filename()).ok() ||
+        !parser.errors().empty()) {
+      state.SkipWithError("parse failed");
+      break;
+    }
+    directives = ledger.directives().size();
+  }
+  state.SetBytesProcessed(state.iterations() * file.size());
+  state.counters["directives"] = static_cast<double>(directives);
+}
+BENCHMARK(BM_ParallelParseFile)
+    ->Apply(ParallelArgs)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Reloading the text after an edit of one transaction in its middle, the
+// latency from an edit to its directives.
+void BM_IncrementalReload(benchmark::State &state) {
+  const BenchmarkLedger &file = LedgerFile(state.range(0) << 20);
+  std::unique_ptr<MappedFile> mapped;
+  if (!MappedFile::Open(file.filename(), &mapped).ok()) {
+    state.SkipWithError("open failed");
+    return;
+  }
+  string text(mapped->text());
+  IncrementalParser parser;
+  parser.Reload(text);
+  // A digit of the first amount from the middle on.
+  size_t digit = text.find(" USD\n", text.size() / 2) - 1;
+  int blocks_parsed = 0;
+  for (auto _ : state) {
+    text[digit] = text[digit] == '1' ? '2' : '1';
+    ReparseDiff diff = parser.Reload(text);
+    blocks_parsed += diff.blocks_parsed;
+  }
+  state.SetBytesProcessed(state.iterations() * file.size());
+  state.counters["blocks_parsed"] = benchmark::Counter(
+      blocks_parsed, benchmark::Counter::kAvgIterations);
+  state.counters["directives"] = parser.directives().size();
+}
+BENCHMARK(BM_IncrementalReload)
+    ->ArgName("MiB")
+    ->Arg(64)
+    ->Arg(256)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace beanquick
@@ -0,0 +1,281 @@
+#include "parser.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "beanquick/core/test_util.h"
+#include "gtest/gtest.h"
+
+namespace beanquick {
+namespace {
+#define D Decimal
+#define A Amount
+
+Date Day(int year, int month, int day) {
+  return Date::FromCivil(year, month, day);
+}
+
+string ErrorString(const ParseError &error) {
+  return absl::StrCat(error.line, ":", error.column, ": ",
+                      error.status.message());
+}
+
+TEST(TestParser, Transaction) {
+  Ledger ledger;
+  DisplayContext dcontext;
+  Parser parser(&ledger, &dcontext);
+  parser.Parse(
+      "2020-03-01 * \"Cafe\" \"Coffee \\\"to go\\\"\" #food ^r1\n"
+      "  receipt: \"r1.pdf\"\n"
+      "  Expenses:Food     3.50 USD\n"
+      "    category: food\n"
+      "  ! Assets:Cash\n"
+      "\n"
+      "2020-03-02 txn \"Buy\"\n"
+      "  Assets:Broker  10 HOOL {500.00 USD, 2020-03-02, \"lot\"} @@ 5,010 "
+      "USD\n"
+      "  Assets:Cash  -5,000.00 USD\n");
+  EXPECT_TRUE(parser.errors().empty());
+  ASSERT_EQ(2, ledger.directives().size());
+
+  const Transaction *txn = ledger.directives()[0]->As<Transaction>();
+  ASSERT_NE(nullptr, txn);
+  EXPECT_EQ(Day(2020, 3, 1), txn->date);
+  EXPECT_EQ('*', txn->flag);
+  EXPECT_EQ("Cafe", txn->payee);
+  EXPECT_EQ("Coffee \"to go\"", txn->narration);
+  ASSERT_EQ(1, txn->tags.size());
+  EXPECT_EQ("food", txn->tags[0]);
+  ASSERT_EQ(1, txn->links.size());
+  EXPECT_EQ("r1", txn->links[0]);
+  ASSERT_EQ(1, txn->meta.size());
+  EXPECT_EQ("receipt", txn->meta[0].key);
+  EXPECT_EQ("r1.pdf", txn->meta[0].value);
+  ASSERT_EQ(2, txn->postings.size());
+  const Posting &food = txn->postings[0];
+  EXPECT_EQ("Expenses:Food", ledger.AccountName(food.account));
+  EXPECT_EQ(A(D("3.50"), "USD"), food.units);
+  EXPECT_EQ(0, food.flag);
+  EXPECT_TRUE(food.cost.empty());
+  EXPECT_FALSE(food.has_price());
+  ASSERT_EQ(1, food.meta.size());
+  EXPECT_EQ("category", food.meta[0].key);
+  EXPECT_EQ("food", food.meta[0].value);
+  const Posting &cash = txn->postings[1];
+  EXPECT_EQ('!', cash.flag);
+  EXPECT_EQ("Assets:Cash", ledger.AccountName(cash.account));
+  EXPECT_FALSE(cash.has_units());
+  EXPECT_TRUE(cash.meta.empty());
+
+  txn = ledger.directives()[1]->As<Transaction>();
+  ASSERT_NE(nullptr, txn);
+  EXPECT_EQ('*', txn->flag);
+  EXPECT_EQ("", txn->payee);
+  EXPECT_EQ("Buy", txn->narration);
+  ASSERT_EQ(2, txn->postings.size());
+  const Posting &hool = txn->postings[0];
+  EXPECT_EQ(A(D("10"), "HOOL"), hool.units);
+  EXPECT_EQ(D("500.00"), hool.cost.number);
+  EXPECT_EQ(InternCurrency("USD"), hool.cost.currency);
+  EXPECT_EQ(Day(2020, 3, 2).days(), hool.cost.date);
+  EXPECT_EQ("lot", hool.cost.label);
+  // Total prices are stored per unit.
+  EXPECT_EQ(A(D("501"), "USD"), hool.price);
+  EXPECT_EQ(A(D("-5000.00"), "USD"), txn->postings[1].units);
+
+  // The numbers went to the display context.
+  EXPECT_EQ(2, dcontext.Fractional(InternCurrency("USD"),
+                                   DisplayPrecision::MOST_COMMON));
+  EXPECT_EQ(0, dcontext.Fractional(InternCurrency("HOOL"),
+                                   DisplayPrecision::MAXIMUM));
+}
+
+TEST(TestParser, TotalCost) {
+  Ledger ledger;
+  Parser parser(&ledger);
+  parser.Parse(
+      "2020-03-02 * \"Buy\"\n"
+      "  Assets:Broker  -4 HOOL {{2,002.00 USD, 2020-03-01}}\n"
+      "  Assets:Cash\n"
+      "2020-03-03 * \"Empty\"\n"
+      "  Assets:Broker  4 HOOL {{}}\n"
+      "2020-03-04 * \"No units\"\n"
+      "  Assets:Broker  {{10 USD}}\n");
+  std::vector<string> errors;
+  for (const ParseError &error : parser.errors()) {
+    errors.push_back(ErrorString(error));
+  }
+  EXPECT_EQ(std::vector<string>{
+                "7:26: a total cost needs a non-zero number of units"},
+            errors);
+  ASSERT_EQ(2, ledger.directives().size());
+  const Posting &hool =
+      ledger.directives()[0]->As<Transaction>()->postings[0];
+  // Stored per unit.
+  EXPECT_EQ(D("500.50"), hool.cost.number);
+  EXPECT_EQ(InternCurrency("USD"), hool.cost.currency);
+  EXPECT_EQ(Day(2020, 3, 1).days(), hool.cost.date);
+  EXPECT_TRUE(
+      ledger.directives()[1]->As<Transaction>()->postings[0].cost.empty());
+}
+
+TEST(TestParser, Directives) {
+  Ledger ledger;
+  Parser parser(&ledger);
+  parser.Parse(
+      "option \"title\" \"Home\"\n"
+      "plugin \"beancount.plugins.auto\"\n"
+      "include \"prices.beancount\"\n"
+      "2020-01-01 open Assets:Bank USD,EUR \"FIFO\"\n"
+      "  institution: \"Bank\"\n"
+      "2020-01-01 commodity HOOL\n"
+      "2020-01-02 pad Assets:Bank Equity:Opening\n"
+      "2020-01-03 balance Assets:Bank 100.00 ~ 0.01 USD\n"
+      "2020-01-04 note Assets:Bank \"Called\"\n"
+      "2020-01-05 event \"location\" \"Paris\"\n"
+      "2020-01-06 query \"cash\" \"SELECT account\"\n"
+      "2020-01-07 price HOOL 520.50 USD\n"
+      "2020-01-08 document Assets:Bank \"statement.pdf\" #bank\n"
+      "2020-01-09 custom \"budget\" Expenses:Food \"monthly\" 400.00 USD\n"
+      "2020-12-31 close Assets:Bank\n");
+  for (const ParseError &error : parser.errors()) {
+    ADD_FAILURE() << ErrorString(error);
+  }
+  ASSERT_EQ(11, ledger.directives().size());
+
+  ASSERT_EQ(1, parser.options().size());
+  EXPECT_EQ("title", parser.options()[0].name);
+  EXPECT_EQ("Home", parser.options()[0].value);
+  ASSERT_EQ(1, parser.plugins().size());
+  EXPECT_EQ("beancount.plugins.auto", parser.plugins()[0].name);
+  EXPECT_EQ("", parser.plugins()[0].value);
+  ASSERT_EQ(1, parser.includes().size());
+  EXPECT_EQ(3, parser.includes()[0].line);
+  EXPECT_EQ("prices.beancount", parser.includes()[0].filename);
+
+  auto directives = ledger.directives();
+  const Open *open = directives[0]->As<Open>();
+  ASSERT_NE(nullptr, open);
+  EXPECT_EQ(Day(2020, 1, 1), open->date);
+  EXPECT_EQ("Assets:Bank", ledger.AccountName(open->account));
+  ASSERT_EQ(2, open->currencies.size());
+  EXPECT_EQ(InternCurrency("EUR"), open->currencies[1]);
+  EXPECT_EQ(Booking::kFifo, open->booking);
+  ASSERT_EQ(1, open->meta.size());
+  EXPECT_EQ("Bank", open->meta[0].value);
+
+  EXPECT_EQ(InternCurrency("HOOL"),
+            directives[1]->As<Commodity>()->currency);
+  const Pad *pad = directives[2]->As<Pad>();
+  EXPECT_EQ("Equity:Opening", ledger.AccountName(pad->source_account));
+  const Balance *balance = directives[3]->As<Balance>();
+  EXPECT_EQ(A(D("100.00"), "USD"), balance->amount);
+  EXPECT_TRUE(balance->has_tolerance);
+  EXPECT_EQ(D("0.01"), balance->tolerance);
+  EXPECT_EQ("Called", directives[4]->As<Note>()->comment);
+  EXPECT_EQ("location", directives[5]->As<Event>()->event_type);
+  EXPECT_EQ("Paris", directives[5]->As<Event>()->description);
+  EXPECT_EQ("SELECT account", directives[6]->As<Query>()->query_string);
+  const Price *price = directives[7]->As<Price>();
+  EXPECT_EQ(InternCurrency("HOOL"), price->currency);
+  EXPECT_EQ(A(D("520.50"), "USD"), price->amount);
+  const Document *document = directives[8]->As<Document>();
+  EXPECT_EQ("statement.pdf", document->filename);
+  ASSERT_EQ(1, document->tags.size());
+  EXPECT_EQ("budget", directives[9]->As<Custom>()->custom_type);
+  EXPECT_EQ(Day(2020, 12, 31), directives[10]->As<Close>()->date);
+}
+
+TEST(TestParser, PushTagAndMeta) {
+  Ledger ledger;
+  Parser parser(&ledger);
+  parser.Parse(
+      "pushtag #trip\n"
+      "pushmeta location: \"Paris\"\n"
+      "2020-01-01 * \"Dinner\" #food\n"
+      "  Expenses:Food  40 EUR\n"
+      "  Assets:Cash\n"
+      "poptag #trip\n"
+      "popmeta location:\n"
+      "2020-01-02 * \"Home\"\n"
+      "poptag #trip\n");
+  ASSERT_EQ(1, parser.errors().size());
+  EXPECT_EQ("9:8: tag 'trip' was never pushed",
+            ErrorString(parser.errors()[0]));
+  ASSERT_EQ(2, ledger.directives().size());
+  const Transaction *txn = ledger.directives()[0]->As<Transaction>();
+  ASSERT_EQ(2, txn->tags.size());
+  EXPECT_EQ("trip", txn->tags[0]);
+  EXPECT_EQ("food", txn->tags[1]);
+  ASSERT_EQ(1, txn->meta.size());
+  EXPECT_EQ("location", txn->meta[0].key);
+  txn = ledger.directives()[1]->As<Transaction>();
+  EXPECT_TRUE(txn->tags.empty());
+  EXPECT_TRUE(txn->meta.empty());
+}
+
+TEST(TestParser, Errors) {
+  Ledger ledger;
+  Parser parser(&ledger);
+  parser.Parse(
+      "2020-01-01 open Assets:Cash\n"
+      "2020-02-30 open Assets:Bank\n"
+      "2020-01-02 * \"Bad posting\"\n"
+      "  Expenses:Food  1.5.0 USD\n"
+      "  Assets:Cash\n"
+      "2020-01-03 * \"Skipped up to here\"\n"
+      "  Expenses:Food  2 usd\n"
+      "2020-01-04 balance Assets:Cash 1 USD extra\n"
+      "  Assets:Cash\n"
+      "2020-01-05 frobnicate\n"
+      "Assets:Cash\n"
+      "  2020-01-06 close Assets:Cash ; Skipped with the line above\n"
+      "2020-01-07 price HOOL 10 USD\n"
+      "2020-01-08 * \"Total price\"\n"
+      "  Assets:Cash  @@ 10 USD\n"
+      "2020-01-09 close");
+  std::vector<string> errors;
+  for (const ParseError &error : parser.errors()) {
+    errors.push_back(ErrorString(error));
+  }
+  std::vector<string> expected = {
+      "2:1: invalid date '2020-02-30'",
+      "4:21: expected a currency, got number '.0'",
+      "7:20: expected a currency, got keyword 'usd'",
+      "8:38: expected end of line, got keyword 'extra'",
+      "10:12: unknown directive 'frobnicate'",
+      "11:1: expected a date or a keyword, got account 'Assets:Cash'",
+      "15:25: a total price needs a non-zero number of units",
+      "16:17: expected an account, got end of line",
+  };
+  EXPECT_EQ(expected, errors);
+  // The good ones are kept.
+  ASSERT_EQ(2, ledger.directives().size());
+  EXPECT_NE(nullptr, ledger.directives()[0]->As<Open>());
+  EXPECT_NE(nullptr, ledger.directives()[1]->As<Price>());
+
+  Parser indented(&ledger);
+  indented.Parse("  Assets:Cash 1 USD\n");
+  ASSERT_EQ(1, indented.errors().size());
+  EXPECT_EQ("1:3: indented line outside a directive",
+            ErrorString(indented.errors()[0]));
+}
+
+TEST(TestParser, ParseFile) {
+  string filename =
+      WriteTempFile("2020-01-01 note Assets:Cash \"Mapped\"\n");
+
+  Ledger ledger;
+  Parser parser(&ledger);
+  ASSERT_TRUE(parser.ParseFile(filename).ok());
+  unlink(filename.c_str());
+  ASSERT_EQ(1, ledger.directives().size());
+  // Points into the mapping, which the ledger keeps.
+  EXPECT_EQ("Mapped", ledger.directives()[0]->As<Note>()->comment);
+
+  EXPECT_EQ(absl::StatusCode::kNotFound,
+            parser.ParseFile("/nonexistent/ledger").code());
+}
+
+}  // namespace
+}  // namespace beanquick
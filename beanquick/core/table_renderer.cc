@@ -0,0 +1,165 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "beanquick/core/table_renderer.h"
+
+#include <errno.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "absl/strings/str_cat.h"
+
+namespace beanquick {
+
+namespace {
+// Characters, not bytes, so that accounts with non-ASCII names line up.
+int Utf8Width(absl::string_view text) {
+  int width = 0;
+  for (char c : text) {
+    width += (static_cast<unsigned char>(c) & 0xc0) != 0x80;
+  }
+  return width;
+}
+
+char *Pad(char *out, int count) {
+  if (count <= 0) return out;
+  std::memset(out, ' ', count);
+  return out + count;
+}
+
+char *Copy(char *out, const char *data, size_t size) {
+  std::memcpy(out, data, size);
+  return out + size;
+}
+}  // namespace
+
+constexpr int TableRenderer::kColumnGap;
+
+TableRenderer::Text TableRenderer::Append(absl::string_view text) {
+  Text ret = {static_cast<uint32>(text_.size()),
+              static_cast<uint32>(text.size())};
+  text_.append(text.data(), text.size());
+  return ret;
+}
+
+void TableRenderer::AddRow(absl::string_view account,
+                           absl::Span<const Amount> amounts) {
+  Row row;
+  row.account = Append(account);
+  row.width = Utf8Width(account);
+  row.first_cell = static_cast<uint32>(cells_.size());
+  row.num_cells = static_cast<uint32>(amounts.size());
+  rows_.push_back(row);
+  account_width_ = std::max(account_width_, row.width);
+
+  if (widths_.size() < amounts.size()) {
+    widths_.resize(amounts.size());
+  }
+  for (size_t i = 0; i < amounts.size(); i++) {
+    const Amount &amount = amounts[i];
+    uint32 offset = static_cast<uint32>(text_.size());
+    formatter_.AppendTo(amount.Number(), amount.currency_id(), &text_);
+    Cell cell;
+    cell.number = {offset, static_cast<uint32>(text_.size() - offset)};
+    cell.currency = amount.currency_id();
+    cells_.push_back(cell);
+
+    ColumnWidth &width = widths_[i];
+    width.number = std::max(width.number, static_cast<int>(cell.number.size));
+    width.currency = std::max(
+        width.currency, static_cast<int>(CurrencyName(cell.currency).size()));
+  }
+}
+
+void TableRenderer::Clear() {
+  text_.clear();
+  cells_.clear();
+  rows_.clear();
+  account_width_ = 0;
+  widths_.clear();
+}
+
+char *TableRenderer::RenderRow(const Row &row, char *out) const {
+  out = Copy(out, text_.data() + row.account.offset, row.account.size);
+  if (row.num_cells > 0) {
+    out = Pad(out, account_width_ - row.width);
+  }
+  const Cell *cells = cells_.data() + row.first_cell;
+  for (uint32 i = 0; i < row.num_cells; i++) {
+    const Cell &cell = cells[i];
+    const ColumnWidth &width = widths_[i];
+    // Right align the number, left align the currency.
+    out = Pad(out, kColumnGap + width.number -
+                       static_cast<int>(cell.number.size));
+    out = Copy(out, text_.data() + cell.number.offset, cell.number.size);
+    *out++ = ' ';
+    const string &currency = CurrencyName(cell.currency);
+    out = Copy(out, currency.data(), currency.size());
+    if (i + 1 < row.num_cells) {
+      out = Pad(out, width.currency - static_cast<int>(currency.size()));
+    }
+  }
+  *out++ = '\n';
+  return out;
+}
+
+void TableRenderer::RenderTo(string *out) const {
+  // Room for the widest line with as many cells as each row, so that the
+  // rows are written without checking for space.
+  std::vector<size_t> line_size(widths_.size() + 1);
+  line_size[0] = account_width_ + 1;
+  for (size_t i = 0; i < widths_.size(); i++) {
+    line_size[i + 1] =
+        line_size[i] + kColumnGap + widths_[i].number + 1 + widths_[i].currency;
+  }
+  size_t size = 0;
+  for (const Row &row : rows_) {
+    // Non-ASCII accounts take more bytes than characters.
+    size += line_size[row.num_cells] + row.account.size - row.width;
+  }
+
+  size_t start = out->size();
+  out->resize(start + size);
+  char *begin = &(*out)[0];
+  char *end = begin + start;
+  for (const Row &row : rows_) {
+    end = RenderRow(row, end);
+  }
+  out->resize(end - begin);
+}
+
+absl::Status TableRenderer::WriteTo(int fd) {
+  buffer_.clear();
+  RenderTo(&buffer_);
+  struct iovec iov;
+  iov.iov_base = &buffer_[0];
+  iov.iov_len = buffer_.size();
+  while (iov.iov_len > 0) {
+    ssize_t written = ::writev(fd, &iov, 1);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return absl::InternalError(
+          absl::StrCat("writev failed: ", std::strerror(errno)));
+    }
+    iov.iov_base = static_cast<char *>(iov.iov_base) + written;
+    iov.iov_len -= written;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace beanquick
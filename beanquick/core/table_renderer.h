@@ -0,0 +1,130 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef DEANQUICK_TABLE_RENDERER_H_
+#define DEANQUICK_TABLE_RENDERER_H_
+
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "beanquick/core/amount.h"
+#include "beanquick/core/base.h"
+#include "beanquick/core/currency.h"
+#include "beanquick/core/display_context.h"
+
+namespace beanquick {
+
+// -----------------------------------------------------------------------------
+// TableRenderer Definition.
+// -----------------------------------------------------------------------------
+// Lays out rows of an account followed by amounts, the way a balance sheet
+// shows them:
+//
+//   Assets:Bank:Checking     1,234.50 USD   10.000 HOOL
+//   Assets:Cash                 20.00 USD
+//
+// The account column is left aligned. Amount columns line up their numbers
+// through the DisplayFormatter, then their currencies. Numbers are rendered
+// once, when a row is added, into a buffer shared by all the cells, and the
+// column widths are kept up to date as they are, so rendering the table is a
+// single pass which doesn't allocate per cell.
+//
+//   DisplayConfig config;
+//   config.alignment = DisplayAlignment::DOT;
+//   TableRenderer table(dcontext.Build(config));
+//   for (...) table.AddRow(account, balances);
+//   absl::Status status = table.WriteTo(STDOUT_FILENO);
+//
+class TableRenderer {
+ public:
+  explicit TableRenderer(DisplayFormatter formatter)
+      : formatter_(std::move(formatter)) {}
+
+  TableRenderer(const TableRenderer &) = delete;
+  TableRenderer &operator=(const TableRenderer &) = delete;
+
+  void AddRow(absl::string_view account, absl::Span<const Amount> amounts);
+
+  int num_rows() const { return static_cast<int>(rows_.size()); }
+
+  // Drops the rows, keeping the buffers for the next table.
+  void Clear();
+
+  // Appends the table to `out`, one line per row.
+  void RenderTo(string *out) const;
+
+  string Render() const {
+    string ret;
+    RenderTo(&ret);
+    return ret;
+  }
+
+  // Renders the table into a buffer of its own and writes it to `fd` with
+  // writev(), retrying on short writes.
+  absl::Status WriteTo(int fd);
+
+ private:
+  // Between the account and the first amount, and between amounts.
+  static constexpr int kColumnGap = 2;
+
+  // An account or a rendered number, in text_.
+  struct Text {
+    uint32 offset;
+    uint32 size;
+  };
+
+  struct Cell {
+    Text number;
+    CurrencyId currency;
+  };
+
+  struct Row {
+    Text account;
+    // Of the account, in characters.
+    int width;
+    // The cells of the row are cells_[first_cell, first_cell + num_cells).
+    uint32 first_cell;
+    uint32 num_cells;
+  };
+
+  struct ColumnWidth {
+    int number = 0;
+    int currency = 0;
+  };
+
+  // Renders `row` at `out` and returns past it.
+  char *RenderRow(const Row &row, char *out) const;
+
+  Text Append(absl::string_view text);
+
+  DisplayFormatter formatter_;
+
+  string text_;
+  std::vector<Cell> cells_;
+  std::vector<Row> rows_;
+
+  int account_width_ = 0;
+  std::vector<ColumnWidth> widths_;
+
+  // What WriteTo() renders into.
+  string buffer_;
+};
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_TABLE_RENDERER_H_
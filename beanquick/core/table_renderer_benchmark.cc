@@ -0,0 +1,113 @@
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "beanquick/core/benchmark_util.h"
+#include "benchmark/benchmark.h"
+#include "table_renderer.h"
+
+namespace beanquick {
+namespace {
+
+constexpr int kRows = 500 * 1000;
+
+// A balance sheet of kRows accounts, with two amounts each.
+struct BalanceSheet {
+  std::vector<string> accounts;
+  std::vector<Amount> amounts;
+  DisplayContext dcontext;
+
+  BalanceSheet() : amounts(BenchmarkAmounts(ValueMix::kLedger)) {
+    for (int i = 0; i < 1000; i++) {
+      accounts.push_back(absl::StrCat("Assets:Bank:Account", i));
+    }
+    for (const auto& a : amounts) dcontext.Update(a);
+  }
+
+  absl::Span<const Amount> Row(int i) const {
+    return absl::Span<const Amount>(amounts).subspan(i * 2 % (kNumValues - 1),
+                                                     2);
+  }
+
+  const string& Account(int i) const { return accounts[i % accounts.size()]; }
+};
+
+DisplayConfig DotConfig() {
+  DisplayConfig config;
+  config.alignment = DisplayAlignment::DOT;
+  config.comma_position = 3;
+  return config;
+}
+
+// Adding the rows and rendering the table, the renderer being reused as a
+// report refreshing would.
+void BM_TableRendererRender(benchmark::State& state) {
+  BalanceSheet sheet;
+  TableRenderer table(sheet.dcontext.Build(DotConfig()));
+  string out;
+  int64 allocs = 0;
+  for (auto _ : state) {
+    int64 start = AllocationCount();
+    table.Clear();
+    out.clear();
+    for (int i = 0; i < kRows; i++) {
+      table.AddRow(sheet.Account(i), sheet.Row(i));
+    }
+    table.RenderTo(&out);
+    allocs += AllocationCount() - start;
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+  state.counters["allocs/row"] =
+      static_cast<double>(allocs) /
+      (static_cast<double>(state.iterations()) * kRows);
+}
+BENCHMARK(BM_TableRendererRender)->Unit(benchmark::kMillisecond);
+
+// Only rendering the rows, which were added once.
+void BM_TableRendererRenderOnly(benchmark::State& state) {
+  BalanceSheet sheet;
+  TableRenderer table(sheet.dcontext.Build(DotConfig()));
+  for (int i = 0; i < kRows; i++) {
+    table.AddRow(sheet.Account(i), sheet.Row(i));
+  }
+  string out;
+  for (auto _ : state) {
+    out.clear();
+    table.RenderTo(&out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+  state.SetBytesProcessed(state.iterations() * out.size());
+}
+BENCHMARK(BM_TableRendererRenderOnly)->Unit(benchmark::kMillisecond);
+
+// The same table, formatting each cell on its own and concatenating the
+// strings, for reference.
+void BM_TableConcatenateCells(benchmark::State& state) {
+  BalanceSheet sheet;
+  DisplayFormatter formatter = sheet.dcontext.Build(DotConfig());
+  string out;
+  int64 allocs = 0;
+  for (auto _ : state) {
+    int64 start = AllocationCount();
+    out.clear();
+    for (int i = 0; i < kRows; i++) {
+      string line = sheet.Account(i);
+      for (const Amount& a : sheet.Row(i)) {
+        line += "  " + formatter.Format(a.Number(), a.currency_id()) + " " +
+                a.Currency();
+      }
+      out += line + "\n";
+    }
+    allocs += AllocationCount() - start;
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kRows);
+  state.counters["allocs/row"] =
+      static_cast<double>(allocs) /
+      (static_cast<double>(state.iterations()) * kRows);
+}
+BENCHMARK(BM_TableConcatenateCells)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace beanquick
@@ -0,0 +1,91 @@
+#include "table_renderer.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace beanquick {
+namespace {
+#define D Decimal
+#define A Amount
+
+DisplayFormatter DotFormatter(const std::vector<Amount> &amounts) {
+  DisplayContext dcontext;
+  for (const auto &amount : amounts) dcontext.Update(amount);
+  DisplayConfig config;
+  config.alignment = DisplayAlignment::DOT;
+  config.comma_position = 3;
+  return dcontext.Build(config);
+}
+
+TEST(TestTableRenderer, Render) {
+  std::vector<Amount> checking = {A(D("1234.5"), "USD"), A(D("10"), "HOOL")};
+  std::vector<Amount> cash = {A(D("20"), "USD")};
+  std::vector<Amount> card = {A(D("-7.25"), "USD"), A(D("-3"), "CAD")};
+  std::vector<Amount> all;
+  for (auto *amounts : {&checking, &cash, &card}) {
+    all.insert(all.end(), amounts->begin(), amounts->end());
+  }
+  TableRenderer table(DotFormatter(all));
+  table.AddRow("Assets:Bank:Checking", checking);
+  table.AddRow("Assets:Cash", cash);
+  table.AddRow("Equity", {});
+  table.AddRow("Liabilities:Card", card);
+  EXPECT_EQ(4, table.num_rows());
+  EXPECT_EQ(
+      "Assets:Bank:Checking   1,234.50 USD      10    HOOL\n"
+      "Assets:Cash               20.00 USD\n"
+      "Equity\n"
+      "Liabilities:Card          -7.25 USD      -3    CAD\n",
+      table.Render());
+
+  // Appends.
+  string out = "Balances\n";
+  table.RenderTo(&out);
+  EXPECT_EQ("Balances\n" + table.Render(), out);
+
+  table.Clear();
+  EXPECT_EQ(0, table.num_rows());
+  EXPECT_EQ("", table.Render());
+  table.AddRow("Assets:Cash", cash);
+  // The numbers keep the width of the formatter.
+  EXPECT_EQ("Assets:Cash      20.00 USD\n", table.Render());
+}
+
+TEST(TestTableRenderer, NonAsciiAccounts) {
+  std::vector<Amount> amounts = {A(D("1"), "EUR")};
+  TableRenderer table(DotFormatter(amounts));
+  table.AddRow("Assets:Café", amounts);
+  table.AddRow("Assets:Bank", amounts);
+  EXPECT_EQ(
+      "Assets:Café  1 EUR\n"
+      "Assets:Bank  1 EUR\n",
+      table.Render());
+}
+
+TEST(TestTableRenderer, WriteTo) {
+  std::vector<Amount> amounts = {A(D("1.5"), "USD")};
+  TableRenderer table(DotFormatter(amounts));
+  for (int i = 0; i < 10000; i++) {
+    table.AddRow("Assets:Cash", amounts);
+  }
+  FILE *file = tmpfile();
+  ASSERT_NE(nullptr, file);
+  ASSERT_TRUE(table.WriteTo(fileno(file)).ok());
+
+  string expected = table.Render();
+  string written(expected.size() + 1, '\0');
+  ASSERT_EQ(0, fseek(file, 0, SEEK_SET));
+  written.resize(fread(&written[0], 1, written.size(), file));
+  fclose(file);
+  EXPECT_EQ(expected, written);
+
+  absl::Status status = table.WriteTo(-1);
+  EXPECT_EQ(absl::StatusCode::kInternal, status.code());
+}
+
+}  // namespace
+}  // namespace beanquick
@@ -0,0 +1,24 @@
+#include "beanquick/core/test_util.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "absl/strings/str_cat.h"
+#include "beanquick/core/logging.h"
+
+namespace beanquick {
+
+string WriteTempFile(absl::string_view contents) {
+  const char* tmpdir = getenv("TMPDIR");
+  string filename = absl::StrCat(tmpdir != nullptr ? tmpdir : "/tmp",
+                                 "/beanquick_test.XXXXXX");
+  int fd = mkstemp(&filename[0]);
+  CHECK(fd >= 0) << "mkstemp " << filename;
+  CHECK(write(fd, contents.data(), contents.size()) ==
+        static_cast<ssize_t>(contents.size()))
+      << "write " << filename;
+  close(fd);
+  return filename;
+}
+
+}  // namespace beanquick
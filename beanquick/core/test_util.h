@@ -0,0 +1,16 @@
+#ifndef BEANQUICK_TEST_UTIL_H_
+#define BEANQUICK_TEST_UTIL_H_
+
+#include "absl/strings/string_view.h"
+#include "beanquick/core/base.h"
+
+// Shared by the *_test.cc binaries.
+namespace beanquick {
+
+// Writes `contents` to a new file under $TMPDIR, /tmp by default, and returns
+// its name. Removing it is left to the caller.
+string WriteTempFile(absl::string_view contents);
+
+}  // namespace beanquick
+
+#endif  // BEANQUICK_TEST_UTIL_H_
@@ -0,0 +1,70 @@
+//
+// Copyright 2020 The Beanquick Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef DEANQUICK_THREAD_POOL_H_
+#define DEANQUICK_THREAD_POOL_H_
+
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+
+namespace beanquick {
+
+// -----------------------------------------------------------------------------
+// ThreadPool Definition.
+// -----------------------------------------------------------------------------
+// A fixed set of threads running closures in the order they were scheduled.
+// Destroying the pool runs whatever is still queued, then joins the threads.
+//
+//   ThreadPool pool(4);
+//   pool.ForEach(chunks.size(), [&](int i) { Parse(&chunks[i]); });
+class ThreadPool {
+ public:
+  // `num_threads` <= 0 means one per hardware thread.
+  explicit ThreadPool(int num_threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void Schedule(std::function<void()> fn);
+
+  // Runs `fn(0)` to `fn(count - 1)` on the pool and waits for all of them.
+  // Must not be called from a thread of the pool, which could deadlock.
+  void ForEach(int count, const std::function<void(int)> &fn);
+
+  int num_threads() const { return static_cast<int>(threads_.size()); }
+
+ private:
+  void WorkLoop();
+
+  // Whether a thread should wake up, to run something or to exit.
+  bool HasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return stopping_ || !queue_.empty();
+  }
+
+  absl::Mutex mu_;
+  std::deque<std::function<void()>> queue_ ABSL_GUARDED_BY(mu_);
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace beanquick
+
+#endif  // DEANQUICK_THREAD_POOL_H_
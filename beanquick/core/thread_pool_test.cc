@@ -0,0 +1,45 @@
+#include "thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include "absl/synchronization/blocking_counter.h"
+#include "gtest/gtest.h"
+
+namespace beanquick {
+namespace {
+
+TEST(TestThreadPool, Schedule) {
+  std::atomic<int> sum{0};
+  {
+    ThreadPool pool(3);
+    EXPECT_EQ(3, pool.num_threads());
+    absl::BlockingCounter done(100);
+    for (int i = 1; i <= 100; i++) {
+      pool.Schedule([&sum, &done, i] {
+        sum += i;
+        done.DecrementCount();
+      });
+    }
+    done.Wait();
+    EXPECT_EQ(5050, sum.load());
+
+    // What is queued when the pool goes away still runs.
+    for (int i = 0; i < 10; i++) pool.Schedule([&sum] { sum++; });
+  }
+  EXPECT_EQ(5060, sum.load());
+}
+
+TEST(TestThreadPool, ForEach) {
+  ThreadPool pool(4);
+  std::vector<int> squares(1000);
+  pool.ForEach(squares.size(), [&squares](int i) { squares[i] = i * i; });
+  for (int i = 0; i < 1000; i++) EXPECT_EQ(i * i, squares[i]);
+  pool.ForEach(0, [](int) { FAIL(); });
+
+  ThreadPool hardware;
+  EXPECT_GE(hardware.num_threads(), 1);
+}
+
+}  // namespace
+}  // namespace beanquick
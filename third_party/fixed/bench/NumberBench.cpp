@@ -0,0 +1,146 @@
+//
+// The MIT License (MIT)
+//
+//
+// Copyright (c) 2013 OANDA Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+//
+// Micro-benchmarks for the Number arithmetic hot paths.  Each case is a
+// pair of operands chosen to hit a given code path, run in a loop and
+// reported in nanoseconds per operation.
+//
+//   make bench
+//
+
+#include "Number.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fixed {
+namespace bench {
+
+struct Case {
+    std::string name;
+    Number lhs;
+    Number rhs;
+    std::function<Number (const Number&, const Number&)> op;
+};
+
+//
+// Keeps the compiler from optimizing the operations away.
+//
+static volatile int64_t sink;
+
+static double runCase (const Case& c, unsigned int iterations)
+{
+    auto start = std::chrono::steady_clock::now ();
+
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        sink = c.op (c.lhs, c.rhs).integerValue ();
+    }
+
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now () - start;
+
+    return elapsed.count () / iterations;
+}
+
+static Number mult (const Number& lhs, const Number& rhs)
+{
+    return lhs * rhs;
+}
+
+static Number div (const Number& lhs, const Number& rhs)
+{
+    return lhs / rhs;
+}
+
+} // namespace bench
+} // namespace fixed
+
+int main (int argc, char** argv)
+{
+    using fixed::Number;
+    using fixed::bench::Case;
+
+    unsigned int iterations = argc > 1 ? std::stoul (argv[1]) : 1000000;
+
+    std::vector<Case> cases = {
+        { "mult64", Number ("123.45"), Number ("6.789"), fixed::bench::mult },
+        {
+            "mult128",
+            Number ("12345678901.123"),
+            Number ("98765432.12345"),
+            fixed::bench::mult
+        },
+        {
+            "mult128 reduce precision",
+            Number ("1234567.12345678901234"),
+            Number ("7654321.12345678901234"),
+            fixed::bench::mult
+        },
+        { "div64", Number ("100.5"), Number ("3"), fixed::bench::div },
+        {
+            "div128",
+            Number ("1234567890.12345"),
+            Number ("3.3"),
+            fixed::bench::div
+        },
+        {
+            "div128 shift divisor",
+            Number ("9223372036.12345678901234"),
+            Number ("0.12345678901234"),
+            fixed::bench::div
+        },
+        { "div unit price", Number ("1523.47"), Number ("37"), fixed::bench::div },
+        {
+            "div average cost",
+            Number ("98234.12345678"),
+            Number ("12.5"),
+            fixed::bench::div
+        },
+        {
+            "div 128 bit dividend",
+            Number ("92233720368547758.12"),
+            Number ("7"),
+            fixed::bench::div
+        }
+    };
+
+    for (const auto& c: cases)
+    {
+        std::cout << std::left << std::setw (28) << c.name
+                  << std::right << std::setw (10) << std::fixed
+                  << std::setprecision (1)
+                  << fixed::bench::runCase (c, iterations) << " ns/op"
+                  << std::endl;
+    }
+
+    return 0;
+}
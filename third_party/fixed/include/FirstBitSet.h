@@ -40,18 +40,22 @@ namespace fixed {
 //   the 1st (lowest) bit, with 64 and 128 representing the max bit (highest)
 //   respectively.
 //
+//   All of these are constexpr, so they can also be used to build tables at
+//   compile time.
+//
 class FirstBitSet {
   public:
-    unsigned int operator() (const int32_t val) const noexcept;
-    unsigned int operator() (const uint32_t val) const noexcept;
-    unsigned int operator() (const int64_t val) const noexcept;
-    unsigned int operator() (const uint64_t val) const noexcept;
-    unsigned int operator() (const __int128_t val) const noexcept;
-    unsigned int operator() (const __uint128_t val) const noexcept;
+    constexpr unsigned int operator() (const int32_t val) const noexcept;
+    constexpr unsigned int operator() (const uint32_t val) const noexcept;
+    constexpr unsigned int operator() (const int64_t val) const noexcept;
+    constexpr unsigned int operator() (const uint64_t val) const noexcept;
+    constexpr unsigned int operator() (const __int128_t val) const noexcept;
+    constexpr unsigned int operator() (const __uint128_t val) const noexcept;
 
     //
-    // These two are provided for compile time support, they should not be used
-    // by runtime code, will be much slower!!
+    // These two predate the constexpr operators above and are kept for
+    // compatibility, they should not be used by runtime code, will be much
+    // slower!!
     //
     static constexpr unsigned int findConstExpr (int64_t val) noexcept;
 
@@ -70,19 +74,9 @@ class FirstBitSet {
 
   private:
 
-    static unsigned int bsr (const uint32_t val) noexcept;
-    static unsigned int bsr (const uint64_t val) noexcept;
-    static unsigned int bsr (const __uint128_t val) noexcept;
-
-    static constexpr uint32_t ONES_32 = 0xFFFFFFFF;
-
-    static constexpr uint64_t UPPER32_MASK_64 =
-        static_cast<uint64_t> (ONES_32) << 32;
-
-    static constexpr uint64_t ONES_64 = UPPER32_MASK_64 | ONES_32;
-
-    static constexpr __uint128_t UPPER64_MASK_128 =
-        static_cast<__uint128_t> (ONES_64) << 64;
+    static constexpr unsigned int bsr (const uint32_t val) noexcept;
+    static constexpr unsigned int bsr (const uint64_t val) noexcept;
+    static constexpr unsigned int bsr (const __uint128_t val) noexcept;
 };
 
 template <typename T>
@@ -100,96 +94,71 @@ inline constexpr unsigned int FirstBitSet::maxBitPos () noexcept
     );
 }
 
-inline unsigned int FirstBitSet::operator() (const int32_t val) const noexcept
+inline constexpr unsigned int
+FirstBitSet::operator() (const int32_t val) const noexcept
 {
     return bsr (absoluteValue<uint32_t> (val));
 }
 
-inline unsigned int FirstBitSet::operator() (const uint32_t val) const noexcept
+inline constexpr unsigned int
+FirstBitSet::operator() (const uint32_t val) const noexcept
 {
     return bsr (val);
 }
 
-inline unsigned int FirstBitSet::operator() (const int64_t val) const noexcept
+inline constexpr unsigned int
+FirstBitSet::operator() (const int64_t val) const noexcept
 {
     return bsr (absoluteValue<uint64_t> (val));
 }
 
-inline unsigned int FirstBitSet::operator() (const uint64_t val) const noexcept
+inline constexpr unsigned int
+FirstBitSet::operator() (const uint64_t val) const noexcept
 {
     return bsr (val);
 }
 
-inline unsigned int
+inline constexpr unsigned int
 FirstBitSet::operator() (const __int128_t val) const noexcept
 {
     return bsr (absoluteValue<__uint128_t> (val));
 }
 
-inline unsigned int
+inline constexpr unsigned int
 FirstBitSet::operator() (const __uint128_t val) const noexcept
 {
     return bsr (val);
 }
 
 //
-// Note, the asm call 'bsr' means 'Bit Scan Reverse'.  It will find the first
-// bit set in the integer.  Or written a different way, it will find the
-// position of the most significant bit set.
+// 'bsr' stands for 'Bit Scan Reverse', the x86 instruction that finds the
+// position of the most significant bit set.  The compiler builtins used here
+// turn into that instruction, or its equivalent on other architectures, and
+// unlike inline asm they can be evaluated at compile time.
 //
 // Returns a value from 0-32.
 //   A return value of 0 means no bits were set to 1.
 //   A return value of 1 means the least significant bit and a value
 //   of 32 refers to the most significant bit.
 //
-inline unsigned int FirstBitSet::bsr (const uint32_t val) noexcept
+inline constexpr unsigned int FirstBitSet::bsr (const uint32_t val) noexcept
 {
     //
-    // The asm call is not defined for a value of 0
-    //
-    if (! val)
-    {
-        return 0;
-    }
-
-    int bitset;
-
-    asm (
-        "movl %1, %%eax;"
-        "bsr %%eax, %0;"
-        : "=r" (bitset)
-        : "r" (val)
-        : "%eax"
-    );
-
-    //
-    // The asm call numbers from 0 - 31, we want 1 - 32, so add one.
+    // The builtin is not defined for a value of 0
     //
-    return bitset + 1;
+    return val ? 32 - __builtin_clz (val) : 0;
 }
 
-inline unsigned int FirstBitSet::bsr (const uint64_t val) noexcept
+inline constexpr unsigned int FirstBitSet::bsr (const uint64_t val) noexcept
 {
-    if (UPPER32_MASK_64 & val)
-    {
-        return 32 + bsr (static_cast<uint32_t> (val >> 32));
-    }
-    else
-    {
-        return bsr (static_cast<uint32_t> (val));
-    }
+    return val ? 64 - __builtin_clzll (val) : 0;
 }
 
-inline unsigned int FirstBitSet::bsr (const __uint128_t val) noexcept
+inline constexpr unsigned int FirstBitSet::bsr (const __uint128_t val) noexcept
 {
-    if (UPPER64_MASK_128 & val)
-    {
-        return 64 + bsr (static_cast<uint64_t> (val >> 64));
-    }
-    else
-    {
-        return bsr (static_cast<uint64_t> (val));
-    }
+    return (val >> 64) ?
+        64 + bsr (static_cast<uint64_t> (val >> 64)) :
+        bsr (static_cast<uint64_t> (val));
 }
 
 constexpr unsigned int FirstBitSet::findConstExpr (int64_t val) noexcept
@@ -95,6 +95,10 @@
 
 namespace fixed {
 
+namespace test {
+struct NumberPeer;
+} // namespace test
+
 class Number {
   public:
     enum class Sign {
@@ -248,7 +252,7 @@ class Number {
     // follows directly from the MAX_DECIMAL_PLACES.
     //
     static constexpr uint64_t MAX_FRACTIONAL_VALUE =
-        static_cast<uint64_t>(pow(10, MAX_DECIMAL_PLACES)) - 1;
+        ShiftTable<int64_t>::pow10 (MAX_DECIMAL_PLACES) - 1;
 
     //
     // When doing division, we can insert extra precision in the computation so
@@ -528,6 +532,11 @@ class Number {
 
     friend const Number operator% (const Number& lhs, const Number& rhs);
 
+    //
+    // Lets the tests compare divFast () against divLong ().
+    //
+    friend struct test::NumberPeer;
+
     template <typename T> bool isCompact (const T& val) const noexcept;
 
     template <typename T> unsigned int makeCompact (
@@ -647,6 +656,32 @@ class Number {
 
     Number& div (const Number& rhs);
 
+    //
+    // Works out the decimal places of the quotient, and how far the dividend
+    // needs to be shifted left to get them plus some extra digits to round
+    // off, see div ().
+    //
+    void divShifts (
+        const Number& rhs,
+        unsigned int& quotientDecimalPlaces,
+        unsigned int& requiredDividendShift,
+        unsigned int& excessDividendShift
+    ) const;
+
+    //
+    // When both operands are stored in 64 bits and the shifted dividend fits
+    // in 128, the quotient and the digits to round off come out of a single
+    // __int128_t division.  Returns false, leaving this untouched, when the
+    // general path is needed.  Gives the exact same results as divLong ().
+    //
+    bool divFast (const Number& rhs) noexcept;
+
+    //
+    // The general long division, can throw DivideByZeroException and
+    // OverflowException.
+    //
+    Number& divLong (const Number& rhs);
+
     void div64 (
         const Number& rhs,
         unsigned int& targetDecimalPlaces,
@@ -696,13 +731,18 @@ class Number {
 
     static constexpr FirstBitSet firstBitSet_ = FirstBitSet ();
 
-    static const ShiftTable<int64_t>& shiftTable64 ();
+    //
+    // The shift tables are computed at compile time, and hold no state, so
+    // these are free.
+    //
+    static constexpr ShiftTable<int64_t, MAX_INTEGER_VALUE> shiftTable64 ();
 
     //
     // Only used when required, shiftTable64 ()  is used whenever possible by
     // the code.
     //
-    static const ShiftTable<__int128_t>& shiftTable128 ();
+    static constexpr ShiftTable<__int128_t, MAX_INTEGER_VALUE>
+        shiftTable128 ();
 
     static Precision::Policy* defaultMultPrecisionPolicy ();
     static Precision::Policy* defaultDivPrecisionPolicy ();
@@ -1241,6 +1281,18 @@ template <typename T> inline T Number::toFloatingPoint () const noexcept
     return isNegative () ? - val : val;
 }
 
+inline constexpr ShiftTable<int64_t, Number::MAX_INTEGER_VALUE>
+Number::shiftTable64 ()
+{
+    return ShiftTable<int64_t, MAX_INTEGER_VALUE> ();
+}
+
+inline constexpr ShiftTable<__int128_t, Number::MAX_INTEGER_VALUE>
+Number::shiftTable128 ()
+{
+    return ShiftTable<__int128_t, MAX_INTEGER_VALUE> ();
+}
+
 inline std::string Number::toString () const noexcept
 {
     std::ostringstream os;
@@ -26,14 +26,13 @@
 #ifndef FIXED_SHIFT_TABLE_H
 #define FIXED_SHIFT_TABLE_H
 
-#include <algorithm>
-#include <cmath>
 #include <cstdint>
-#include <functional>
 #include <limits>
-#include <vector>
+#include <string>
+#include <type_traits>
 
 #include "Absolute.h"
+#include "Exceptions.h"
 #include "FirstBitSet.h"
 
 namespace fixed {
@@ -43,16 +42,30 @@ namespace fixed {
 // it here, but is really meant only for FixedNumber
 //
 
-template <typename T>
-class ShiftTable {
-  public:
-    ShiftTable (uint64_t maxIntegerValue);
+namespace detail {
 
-    struct ShiftValue {
-        ShiftValue (unsigned int decimalPlaces, uint64_t maxIntegerValue);
+//
+// C++11 has no std::index_sequence, this is the minimal equivalent used to
+// expand the table entries below.
+//
+template <unsigned int... I> struct Indices {};
+
+template <unsigned int N, unsigned int... I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
 
-        T computePow10 (unsigned int exp);
+template <unsigned int... I>
+struct MakeIndices<0, I...> {
+    using type = Indices<I...>;
+};
 
+//
+// Everything needed to compute the shift tables at compile time.  Lives
+// outside of ShiftTable since a class can't use its own constexpr functions
+// to initialize its static members.
+//
+template <typename T, uint64_t MaxIntegerValue>
+struct ShiftTableData {
+    struct ShiftValue {
         unsigned int decimalPlaces;
         T value;
         T halfRangeVal;
@@ -61,21 +74,132 @@ class ShiftTable {
         __int128_t integerOverflowCheckValNeg;
     };
 
-    const ShiftValue& operator[] (int idx) const;
+    static constexpr unsigned int MAX_DIGITS = (
+        std::is_same<T, int64_t>::value ?
+            std::numeric_limits<int64_t>::digits10 :
+            std::numeric_limits<__int128_t>::digits10
+    );
+
+    //
+    // One entry per possible FirstBitSet result, plus one so that looking
+    // for the entry above any bit position is still in range.
+    //
+    static constexpr unsigned int BIT_POS_ENTRIES = sizeof (T) * 8 + 2;
+
+    struct Table {
+        ShiftValue values[MAX_DIGITS + 1];
+
+        //
+        // Index of the first entry in values whose firstBitSet is at least
+        // the bit position used as the index, MAX_DIGITS + 1 if there's none.
+        //
+        unsigned char firstIndexByBitPos[BIT_POS_ENTRIES];
+    };
+
+    static constexpr T pow10 (unsigned int exp)
+    {
+        return exp ? 10 * pow10 (exp - 1) : 1;
+    }
+
+    static constexpr __int128_t INT128_MAX_VAL =
+        std::numeric_limits<__int128_t>::max ();
 
     //
-    // Throws fixed::BadValueException if value wasn't found
+    // maxIntegerValue * value + value - 1, the largest value that still has
+    // an integer part <= maxIntegerValue.  Saturates for the entries where it
+    // doesn't fit, as then no value of those decimal places can overflow.
+    //
+    static constexpr __int128_t overflowCheckVal (T value)
+    {
+        return (
+            static_cast<__int128_t> (MaxIntegerValue) >
+                (INT128_MAX_VAL - value + 1) / value ?
+            INT128_MAX_VAL :
+            static_cast<__int128_t> (MaxIntegerValue) * value + value - 1
+        );
+    }
+
+    static constexpr ShiftValue makeShiftValue (unsigned int dps)
+    {
+        return ShiftValue {
+            dps,
+            pow10 (dps),
+            pow10 (dps) / 2,
+            dps == 0 ? 0 : FirstBitSet () (pow10 (dps)),
+            overflowCheckVal (pow10 (dps)),
+            0 - overflowCheckVal (pow10 (dps))
+        };
+    }
+
+    static constexpr unsigned int firstIndexWithBits (
+        unsigned int bits,
+        unsigned int idx = 0
+    )
+    {
+        return (
+            (idx > MAX_DIGITS || makeShiftValue (idx).firstBitSet >= bits) ?
+                idx : firstIndexWithBits (bits, idx + 1)
+        );
+    }
+
+    template <unsigned int... V, unsigned int... B>
+    static constexpr Table makeTable (Indices<V...>, Indices<B...>)
+    {
+        return Table {
+            { makeShiftValue (V)... },
+            { static_cast<unsigned char> (firstIndexWithBits (B))... }
+        };
+    }
+
+    static constexpr Table TABLE = makeTable (
+        typename MakeIndices<MAX_DIGITS + 1>::type (),
+        typename MakeIndices<BIT_POS_ENTRIES>::type ()
+    );
+};
+
+template <typename T, uint64_t MaxIntegerValue>
+constexpr typename ShiftTableData<T, MaxIntegerValue>::Table
+ShiftTableData<T, MaxIntegerValue>::TABLE;
+
+} // namespace detail
+
+//
+// Powers of 10 along with values derived from them, all computed at compile
+// time.  Holds no state, so instances are free to create.
+//
+template <
+    typename T,
+    uint64_t MaxIntegerValue = std::numeric_limits<int64_t>::max ()
+>
+class ShiftTable {
+  private:
+    using Data = detail::ShiftTableData<T, MaxIntegerValue>;
+
+  public:
+    using ShiftValue = typename Data::ShiftValue;
+
+    constexpr ShiftTable () noexcept {}
+
+    //
+    // idx must be <= MAX_DIGITS.
+    //
+    constexpr const ShiftValue& operator[] (unsigned int idx) const;
+
+    static constexpr T pow10 (unsigned int exp) { return Data::pow10 (exp); }
+
+    //
+    // Returns the first entry whose firstBitSet is >= bits, in constant time.
+    //
+    // Throws fixed::BadValueException if there's no such entry
     //
-    const ShiftValue& find_if (
-        const std::function <bool (const ShiftValue& sv)>& func
-    ) const;
+    const ShiftValue& firstWithBitsAtLeast (unsigned int bits) const;
 
     //
-    // Throws fixed::BadValueException if value wasn't found
+    // Returns the first entry whose firstBitSet is > bits, in constant time.
     //
-    const ShiftValue& find_if_not (
-        const std::function <bool (const ShiftValue& sv)>& func
-    ) const;
+    // Throws fixed::BadValueException if there's no such entry
+    //
+    const ShiftValue& firstWithBitsAbove (unsigned int bits) const;
 
     unsigned int totalDigitsOfPrecision (const T& value) const noexcept;
 
@@ -95,103 +219,93 @@ class ShiftTable {
         "type_trait and numeric_limits support."
     );
 
-    static constexpr unsigned int MAX_DIGITS = (
-        std::is_same<T, int64_t>::value ?
-            std::numeric_limits<int64_t>::digits10 :
-            std::numeric_limits<__int128_t>::digits10
-    );
+    static constexpr unsigned int MAX_DIGITS = Data::MAX_DIGITS;
 
   private:
 
-    std::vector<ShiftValue> table_;
-
+    [[noreturn]] static void notFound (unsigned int bits);
 };
 
-template <typename T>
-ShiftTable<T>::ShiftTable (uint64_t maxIntegerValue)
+template <typename T, uint64_t MaxIntegerValue>
+inline constexpr const typename ShiftTable<T, MaxIntegerValue>::ShiftValue&
+ShiftTable<T, MaxIntegerValue>::operator[] (unsigned int idx) const
 {
-    for (unsigned int i = 0; i < (MAX_DIGITS + 1); ++i)
-    {
-        table_.push_back (ShiftValue (i, maxIntegerValue));
-    }
+    return assert (idx <= MAX_DIGITS), Data::TABLE.values[idx];
 }
 
-template <typename T>
-const typename ShiftTable<T>::ShiftValue& ShiftTable<T>::find_if (
-    const std::function <bool (const ShiftValue& sv)>& func
-) const
+template <typename T, uint64_t MaxIntegerValue>
+void ShiftTable<T, MaxIntegerValue>::notFound (unsigned int bits)
 {
-    const auto iter = std::find_if (
-        table_.begin (),
-        table_.end (),
-        func
-    );
-
     //
     // Note, it really should not be possible for us to hit this error, it
     // means something must be wrong elsewhere for us to need to find a
     // firstBitSet that is larger than any in the shift table
     //
-    if (iter == table_.end ())
+    throw fixed::BadValueException (
+        "ShiftTable lookup failed for first bit set: " +
+        std::to_string (bits) + ", max digits: " + std::to_string (MAX_DIGITS)
+    );
+}
+
+template <typename T, uint64_t MaxIntegerValue>
+inline const typename ShiftTable<T, MaxIntegerValue>::ShiftValue&
+ShiftTable<T, MaxIntegerValue>::firstWithBitsAtLeast (unsigned int bits) const
+{
+    if (bits >= Data::BIT_POS_ENTRIES)
     {
-        throw fixed::BadValueException (
-            "ShiftTable find_if failed, max decimal places: " +
-            std::to_string (MAX_DIGITS)
-        );
+        notFound (bits);
+    }
+
+    const unsigned int idx = Data::TABLE.firstIndexByBitPos[bits];
+
+    if (idx > MAX_DIGITS)
+    {
+        notFound (bits);
     }
 
-    return *iter;
+    return Data::TABLE.values[idx];
 }
 
-template <typename T>
-const typename ShiftTable<T>::ShiftValue& ShiftTable<T>::find_if_not (
-    const std::function <bool (const ShiftValue& sv)>& func
-) const
+template <typename T, uint64_t MaxIntegerValue>
+inline const typename ShiftTable<T, MaxIntegerValue>::ShiftValue&
+ShiftTable<T, MaxIntegerValue>::firstWithBitsAbove (unsigned int bits) const
 {
-    const auto iter = std::find_if_not (
-        table_.begin (),
-        table_.end (),
-        func
-    );
-
-    //
-    // Note, it really should not be possible for us to hit this error, it
-    // means something must be wrong elsewhere for us to need to find a
-    // firstBitSet that is larger than any in the shift table
-    //
-    if (iter == table_.end ())
+    if (bits >= Data::BIT_POS_ENTRIES - 1)
     {
-        throw fixed::BadValueException (
-            "ShiftTable find_if_not failed, max digits: " +
-            std::to_string (MAX_DIGITS)
-        );
+        notFound (bits);
     }
 
-    return *iter;
+    return firstWithBitsAtLeast (bits + 1);
 }
 
-template <typename T>
-unsigned int ShiftTable<T>::totalDigitsOfPrecision (
+template <typename T, uint64_t MaxIntegerValue>
+inline unsigned int ShiftTable<T, MaxIntegerValue>::totalDigitsOfPrecision (
     const T& value
 ) const noexcept
 {
-    static_assert (
-        std::is_same<T, int64_t>::value || std::is_same<T, __int128_t>::value,
-        "This class is only intended to work with int164 or int128"
-    );
-
     T absVal = absoluteValue<T> (value);
 
-    const auto& sv =
-        this->find_if (
-            [&] (const ShiftValue& sv) { return absVal < sv.value; }
-        );
+    //
+    // The first power of 10 with at least as many bits as the value is
+    // either larger than it, or it's the next one up that is.
+    //
+    const auto& sv = firstWithBitsAtLeast (FirstBitSet () (absVal));
 
-    return sv.decimalPlaces;
+    if (absVal < sv.value)
+    {
+        return sv.decimalPlaces;
+    }
+
+    if (sv.decimalPlaces == MAX_DIGITS)
+    {
+        notFound (FirstBitSet () (absVal));
+    }
+
+    return sv.decimalPlaces + 1;
 }
 
-template <typename T>
-unsigned int ShiftTable<T>::integerDigitsOfPrecision (
+template <typename T, uint64_t MaxIntegerValue>
+inline unsigned int ShiftTable<T, MaxIntegerValue>::integerDigitsOfPrecision (
     const T& value,
     unsigned int currentDecimalPlace
 ) const noexcept
@@ -204,45 +318,6 @@ unsigned int ShiftTable<T>::integerDigitsOfPrecision (
     );
 }
 
-template <typename T>
-T ShiftTable<T>::ShiftValue::computePow10 (unsigned int exp)
-{
-    T val = 1;
-
-    for (unsigned int i = 0; i < exp; ++i)
-    {
-        val *= 10;
-    }
-
-    return val;
-}
-
-template <typename T>
-ShiftTable<T>::ShiftValue::ShiftValue (
-    unsigned int dps, // decimalPlaces
-    uint64_t maxIntegerValue
-)
-{
-    decimalPlaces = dps;
-    value = computePow10 (dps);
-
-    halfRangeVal = value / 2;
-
-    firstBitSet = dps == 0 ? 0 : FirstBitSet () (value);
-
-    integerOverflowCheckValPos =
-        static_cast<__int128_t> (maxIntegerValue) * value + value - 1;
-
-    integerOverflowCheckValNeg = 0 - integerOverflowCheckValPos;
-}
-
-template <typename T>
-inline const typename ShiftTable<T>::ShiftValue&
-ShiftTable<T>::operator[] (int idx) const
-{
-    return table_.at (idx);
-}
-
 } // namespace fixed
 
 #endif // FIXED_SHIFT_TABLE_H
@@ -101,6 +101,18 @@ static_assert (
     "assumptions to be broken that will cause the code to be incorrect."
 );
 
+static_assert (
+    ShiftTable<int64_t>::pow10 (Number::MAX_DECIMAL_PLACES) ==
+        Number::MAX_FRACTIONAL_VALUE + 1,
+    "The shift tables are expected to be computed at compile time."
+);
+
+//
+// Calling firstBitSet_ binds it to a reference, which needs a definition
+// when the call isn't inlined.
+//
+constexpr FirstBitSet Number::firstBitSet_;
+
 Number::Number (const char* numberCStr)
   : multPrecisionPolicy_ (* defaultMultPrecisionPolicy ()),
     divPrecisionPolicy_ (* defaultDivPrecisionPolicy ()),
@@ -759,11 +771,7 @@ void Number::multReducePrecision (
     // multiplication the least.
     //
     unsigned int dpExcess =
-        shiftTable128 ().find_if (
-            [&] (const ShiftTable<__int128_t>::ShiftValue& sv) {
-                return excessBits <= sv.firstBitSet;
-            }
-        ).decimalPlaces;
+        shiftTable128 ().firstWithBitsAtLeast (excessBits).decimalPlaces;
 
     //
     // If we hit this case, the result of the multiplication would be
@@ -860,12 +868,17 @@ void Number::multReducePrecision (
 
 Number& Number::operator/= (const Number& rhs)
 {
+    if (divFast (rhs))
+    {
+        return *this;
+    }
+
     //
     // We make the extra copy in the event div throws an exception we don't
     // have to worry about leaving the object in an inconsistent state
     //
     Number number (*this);
-    number.div (rhs);
+    number.divLong (rhs);
 
     *this = number;
     return *this;
@@ -873,12 +886,22 @@ Number& Number::operator/= (const Number& rhs)
 
 Number& Number::div (const Number& rhs)
 {
-    if (rhs.isZero ())
+    if (divFast (rhs))
     {
-        throw fixed::DivideByZeroException ("Division");
+        return *this;
     }
 
-    auto quotientDecimalPlaces =
+    return divLong (rhs);
+}
+
+void Number::divShifts (
+    const Number& rhs,
+    unsigned int& quotientDecimalPlaces,
+    unsigned int& requiredDividendShift,
+    unsigned int& excessDividendShift
+) const
+{
+    quotientDecimalPlaces =
         Precision::getQuotientDecimalPlaces (
             decimalPlaces (),
             rhs.decimalPlaces (),
@@ -886,13 +909,13 @@ Number& Number::div (const Number& rhs)
             divPrecisionPolicy_
         );
 
-    auto requiredDividendShift = quotientDecimalPlaces;
+    requiredDividendShift = quotientDecimalPlaces;
 
     //
     // This excess shift is with regards to the required shift to achieve
     // the quotientDecimalPlaces
     //
-    unsigned int excessDividendShift = 0;
+    excessDividendShift = 0;
 
     if (decimalPlaces () < rhs.decimalPlaces ())
     {
@@ -923,6 +946,176 @@ Number& Number::div (const Number& rhs)
         excessDividendShift += delta;
         requiredDividendShift += delta;
     }
+}
+
+//
+// Rounds off the last digits of a quotient computed by divFast ().  quotient
+// and remainder come from dividing the magnitude of the shifted dividend by
+// divisor * 10^n, so the n digits to round off are floor (remainder /
+// divisor).  Rounding::round () only compares them with 0 and halfRangeVal,
+// which can be done by multiplying instead of dividing again.
+//
+// negative is the sign of the truncated quotient with the extra digits, like
+// in decreaseDecimalPlaces128 (), which is positive when it's 0.
+//
+template <typename S, typename U>
+static S roundQuotient (
+    const Rounding::Mode roundingMode,
+    const U quotient,
+    const U remainder,
+    const U divisor,
+    const S halfRangeVal,
+    const bool negative
+)
+{
+    const U half = static_cast<U> (halfRangeVal);
+
+    S digits;
+
+    if (remainder < divisor)
+    {
+        digits = 0;
+    }
+    else if (remainder < half * divisor)
+    {
+        digits = 1;
+    }
+    else if (remainder < (half + 1) * divisor)
+    {
+        digits = halfRangeVal;
+    }
+    else
+    {
+        digits = halfRangeVal + 1;
+    }
+
+    const S value = static_cast<S> (quotient);
+
+    return Rounding::round<S> (
+        roundingMode,
+        negative ? -value : value,
+        digits,
+        halfRangeVal,
+        negative
+    );
+}
+
+bool Number::divFast (const Number& rhs) noexcept
+{
+    if (! value64Set () || ! rhs.value64Set () || rhs.isZero ())
+    {
+        return false;
+    }
+
+    unsigned int quotientDecimalPlaces;
+    unsigned int requiredDividendShift;
+    unsigned int excessDividendShift;
+
+    divShifts (
+        rhs,
+        quotientDecimalPlaces,
+        requiredDividendShift,
+        excessDividendShift
+    );
+
+    //
+    // A 64 bit dividend shifted by up to 10^18 still fits in 128 bits, so
+    // div64 () and div128 () would compute the exact truncated quotient,
+    // without trading precision for room.  Both operands being 64 bits
+    // neither can be int64::min, see valueAutoResize ().
+    //
+    if (requiredDividendShift > shiftTable64 ().MAX_DIGITS)
+    {
+        return false;
+    }
+
+    const bool negative = (value64_ < 0) != (rhs.value64_ < 0);
+
+    const __uint128_t dividend =
+        absoluteValue<__uint128_t> (value64_) *
+        shiftTable128 () [requiredDividendShift].value;
+
+    const __uint128_t divisor = absoluteValue<__uint128_t> (rhs.value64_);
+
+    //
+    // The long path truncates dividend / divisor, then rounds off the last
+    // excessDividendShift digits of it.  Dividing by divisor * 10^excess
+    // gives the digits kept directly, see roundQuotient ().
+    //
+    const auto& sval = shiftTable128 () [excessDividendShift];
+
+    const __uint128_t scaledDivisor = divisor * sval.value;
+
+    __int128_t value;
+
+    //
+    // __udivti3 () is a lot slower than a native 64 bit division, which is
+    // enough for most prices and quantities.
+    //
+    if (((dividend | scaledDivisor) >> 64) == 0)
+    {
+        const uint64_t dividend64 = static_cast<uint64_t> (dividend);
+        const uint64_t scaledDivisor64 = static_cast<uint64_t> (scaledDivisor);
+        const uint64_t quotient = dividend64 / scaledDivisor64;
+
+        value = roundQuotient<int64_t, uint64_t> (
+            roundingMode_,
+            quotient,
+            dividend64 - quotient * scaledDivisor64,
+            static_cast<uint64_t> (divisor),
+            static_cast<int64_t> (sval.halfRangeVal),
+            negative && dividend >= divisor
+        );
+    }
+    else
+    {
+        const __uint128_t quotient = dividend / scaledDivisor;
+
+        value = roundQuotient<__int128_t, __uint128_t> (
+            roundingMode_,
+            quotient,
+            dividend - quotient * scaledDivisor,
+            divisor,
+            sval.halfRangeVal,
+            negative && dividend >= divisor
+        );
+    }
+
+    //
+    // Leave overflows, and the rounding corner case decreaseDecimalPlaces128
+    // () takes care of, to the long path.
+    //
+    if (integerValueOverflowCheck (value, quotientDecimalPlaces))
+    {
+        return false;
+    }
+
+    value128_      = value;
+    value64Set_    = false;
+    decimalPlaces_ = static_cast<uint8_t> (quotientDecimalPlaces);
+
+    valueAutoResize ();
+
+    return true;
+}
+
+Number& Number::divLong (const Number& rhs)
+{
+    if (rhs.isZero ())
+    {
+        throw fixed::DivideByZeroException ("Division");
+    }
+
+    unsigned int quotientDecimalPlaces;
+    unsigned int requiredDividendShift;
+    unsigned int excessDividendShift;
+
+    divShifts (
+        rhs,
+        quotientDecimalPlaces,
+        requiredDividendShift,
+        excessDividendShift
+    );
 
     if (value64Set () && rhs.value64Set ())
     {
@@ -1021,12 +1214,7 @@ void Number::div128 (
     //
     Number divisor (rhs);
 
-    const auto& sv =
-        shiftTable128 ().find_if_not (
-            [&] (const ShiftTable<__int128_t>::ShiftValue& sv) {
-                return shiftRoom >= sv.firstBitSet;
-            }
-        );
+    const auto& sv = shiftTable128 ().firstWithBitsAbove (shiftRoom);
 
     //
     // It's the shiftValue just before the entry that was found that's needed
@@ -1414,22 +1602,6 @@ bool Number::integerValueOverflowCheck (
             value > sval.integerOverflowCheckValPos;
 }
 
-const ShiftTable<int64_t>& Number::shiftTable64 ()
-{
-    static const ShiftTable<int64_t>* table =
-        new ShiftTable<int64_t> (MAX_INTEGER_VALUE);
-
-    return * table;
-}
-
-const ShiftTable<__int128_t>& Number::shiftTable128 ()
-{
-    static const ShiftTable<__int128_t>* table =
-        new ShiftTable<__int128_t> (MAX_INTEGER_VALUE);
-
-    return * table;
-}
-
 Precision::Policy* Number::defaultMultPrecisionPolicy ()
 {
     static Precision::Policy policy = DEFAULT_MULT_PRECISION_POLICY;
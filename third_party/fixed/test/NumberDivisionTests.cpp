@@ -0,0 +1,246 @@
+//
+// The MIT License (MIT)
+//
+//
+// Copyright (c) 2013 OANDA Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+
+#include "TestsCommon.h"
+
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fixed {
+namespace test {
+
+struct NumberPeer {
+    static bool divFast (Number& number, const Number& rhs)
+    {
+        return number.divFast (rhs);
+    }
+
+    static void divLong (Number& number, const Number& rhs)
+    {
+        number.divLong (rhs);
+    }
+};
+
+//
+// Random operands, mostly with a mantissa that fits in 64 bits so that the
+// fast path applies, and a few bigger ones for the general path.
+//
+class RandomNumbers {
+  public:
+    explicit RandomNumbers (uint64_t seed) : rng_ (seed) {}
+
+    Number next ()
+    {
+        const unsigned int decimalPlaces = uniform (0, 14);
+        const unsigned int digits = uniform (1, uniform (0, 9) ? 18 : 28);
+
+        __uint128_t mantissa = 0;
+
+        for (unsigned int i = 0; i < digits; ++i)
+        {
+            mantissa = mantissa * 10 + uniform (i ? 0 : 1, 9);
+        }
+
+        const __uint128_t scale =
+            ShiftTable<__int128_t>::pow10 (decimalPlaces);
+
+        uint64_t integer = static_cast<uint64_t> (
+            std::min<__uint128_t> (mantissa / scale, Number::MAX_INTEGER_VALUE)
+        );
+
+        Number number (
+            integer,
+            static_cast<uint64_t> (mantissa % scale),
+            decimalPlaces,
+            uniform (0, 1) ? Number::Sign::NEGATIVE : Number::Sign::POSITIVE
+        );
+
+        number.setRoundingMode (
+            static_cast<Rounding::Mode> (
+                uniform (0, static_cast<int> (Rounding::Mode::MODE_MAX_VAL) - 1)
+            )
+        );
+
+        number.setDivPrecisionPolicy (
+            static_cast<Precision::Policy> (
+                uniform (
+                    0, static_cast<int> (Precision::Policy::POLICY_MAX_VAL) - 1
+                )
+            )
+        );
+
+        return number;
+    }
+
+  private:
+    unsigned int uniform (unsigned int min, unsigned int max)
+    {
+        return std::uniform_int_distribution<unsigned int> (min, max) (rng_);
+    }
+
+    std::mt19937_64 rng_;
+};
+
+//
+// Runs f on a copy of number, returns the name of the exception it threw, or
+// an empty string.
+//
+static std::string tryDiv (
+    Number& number,
+    const std::function<void (Number&)>& f
+)
+{
+    try
+    {
+        f (number);
+    }
+    catch (const fixed::OverflowException&)
+    {
+        return "OverflowException";
+    }
+    catch (const fixed::DivideByZeroException&)
+    {
+        return "DivideByZeroException";
+    }
+
+    return "";
+}
+
+//
+// divFast () must give the exact same Numbers as the long division it
+// replaces, rounding modes and precision policies included.
+//
+bool testFastMatchesLong ()
+{
+    RandomNumbers random (20200701);
+
+    unsigned int fastCount = 0;
+    const unsigned int iterations = 300000;
+
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        const Number dividend = random.next ();
+        const Number divisor = random.next ();
+
+        Number fast (dividend);
+        Number slow (dividend);
+
+        bool tookFast = false;
+
+        std::string fastErr = tryDiv (fast, [&] (Number& n) {
+            tookFast = NumberPeer::divFast (n, divisor);
+
+            if (! tookFast)
+            {
+                n /= divisor;
+            }
+        });
+
+        std::string slowErr = tryDiv (slow, [&] (Number& n) {
+            NumberPeer::divLong (n, divisor);
+        });
+
+        const std::string hdr =
+            dividend.toString () + " / " + divisor.toString () + " rounding " +
+            Rounding::modeToString (dividend.roundingMode ()) + ":";
+
+        if (! valCheck (slowErr, fastErr, hdr + " exception "))
+        {
+            return false;
+        }
+
+        if (slowErr.empty () && ! checkNumber (hdr, fast, slow))
+        {
+            return false;
+        }
+
+        fastCount += tookFast;
+    }
+
+    //
+    // Make sure the fast path is actually what got tested.
+    //
+    return valCheck (true, fastCount > iterations / 2, "fast path count: ");
+}
+
+bool testExact ()
+{
+    struct {
+        const char* dividend;
+        const char* divisor;
+        const char* quotient;
+    } cases[] = {
+        { "100.5", "3", "33.50000000000000" },
+        { "1", "3", "0.33333333333333" },
+        { "2", "3", "0.66666666666667" },
+        { "-2", "3", "-0.66666666666667" },
+        { "0.05", "-0.1", "-0.50000000000000" },
+        { "10", "4", "2.50000000000000" },
+        { "123.456", "0.001", "123456.00000000000000" },
+        { "0.00000000000001", "3", "0.00000000000000" },
+        { "-0.00000000000002", "3", "-0.00000000000001" },
+        {
+            "9223372036854775807",
+            "1",
+            "9223372036854775807.00000000000000"
+        },
+    };
+
+    for (const auto& c: cases)
+    {
+        Number quotient (c.dividend);
+
+        if (! NumberPeer::divFast (quotient, Number (c.divisor)))
+        {
+            std::cerr << c.dividend << " / " << c.divisor
+                      << " didn't take the fast path" << std::endl;
+
+            return false;
+        }
+
+        if (! valCheck<std::string> (
+                c.quotient, quotient.toString (), "divFast: "
+            ))
+        {
+            return false;
+        }
+    }
+
+    Number zero ("0");
+    Number one ("1");
+
+    return valCheck (false, NumberPeer::divFast (one, zero), "divFast by 0: ");
+}
+
+std::vector<Test> NumberDivisionTestVec = {
+    {testExact, TestName ("exact")},
+    {testFastMatchesLong, TestName ("fastMatchesLong")}
+};
+
+} // namespace test
+} // namespace fixed
@@ -0,0 +1,198 @@
+//
+// The MIT License (MIT)
+//
+//
+// Copyright (c) 2013 OANDA Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//
+#include "ShiftTable.h"
+#include "TestsCommon.h"
+
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace fixed {
+namespace test {
+
+//
+// The reference implementations, linear scans over the table as the lookups
+// used to be done.
+//
+template <typename T>
+unsigned int naiveTotalDigits (T absVal)
+{
+    const ShiftTable<T> table;
+
+    for (unsigned int i = 0; i <= table.MAX_DIGITS; ++i)
+    {
+        if (absVal < table[i].value)
+        {
+            return i;
+        }
+    }
+
+    return table.MAX_DIGITS + 1;
+}
+
+template <typename T>
+unsigned int naiveFirstWithBitsAtLeast (unsigned int bits)
+{
+    const ShiftTable<T> table;
+
+    for (unsigned int i = 0; i <= table.MAX_DIGITS; ++i)
+    {
+        if (bits <= table[i].firstBitSet)
+        {
+            return i;
+        }
+    }
+
+    return table.MAX_DIGITS + 1;
+}
+
+template <typename T>
+bool testValues ()
+{
+    const ShiftTable<T> table;
+
+    T pow10 = 1;
+
+    for (unsigned int i = 0; i <= table.MAX_DIGITS; ++i)
+    {
+        if ((table[i].value != pow10) ||
+            (ShiftTable<T>::pow10 (i) != pow10) ||
+            (table[i].halfRangeVal != pow10 / 2) ||
+            (table[i].firstBitSet != (i ? FirstBitSet () (pow10) : 0)))
+        {
+            std::cerr << "Wrong shift table entry for 10^" << i << std::endl;
+
+            return false;
+        }
+
+        if (i < table.MAX_DIGITS)
+        {
+            pow10 *= 10;
+        }
+    }
+
+    return true;
+}
+
+template <typename T>
+bool testTotalDigits ()
+{
+    const ShiftTable<T> table;
+
+    std::vector<T> values = {0, 1, 2, 7, 8, 9};
+
+    T pow10 = 10;
+
+    for (unsigned int i = 1; i < table.MAX_DIGITS; ++i)
+    {
+        values.push_back (pow10 - 1);
+        values.push_back (pow10);
+        values.push_back (pow10 + 1);
+        values.push_back (pow10 * 3);
+        values.push_back (pow10 * 8);
+        pow10 *= 10;
+    }
+
+    for (const auto val: values)
+    {
+        for (const T v: {val, static_cast<T> (0 - val)})
+        {
+            unsigned int expected = naiveTotalDigits<T> (val);
+            unsigned int got = table.totalDigitsOfPrecision (v);
+
+            if (expected != got)
+            {
+                std::cerr << "totalDigitsOfPrecision of a value with "
+                          << FirstBitSet () (val) << " bits, expected: "
+                          << expected << " got: " << got << std::endl;
+
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+template <typename T>
+bool testBitLookups ()
+{
+    const ShiftTable<T> table;
+
+    for (unsigned int bits = 0; bits <= sizeof (T) * 8; ++bits)
+    {
+        unsigned int expected = naiveFirstWithBitsAtLeast<T> (bits);
+
+        if (expected > table.MAX_DIGITS)
+        {
+            try
+            {
+                table.firstWithBitsAtLeast (bits);
+            }
+            catch (const fixed::BadValueException&)
+            {
+                continue;
+            }
+
+            std::cerr << "Expected a BadValueException for: " << bits
+                      << std::endl;
+
+            return false;
+        }
+
+        if (! valCheck<unsigned int> (
+                expected,
+                table.firstWithBitsAtLeast (bits).decimalPlaces,
+                "firstWithBitsAtLeast: "
+            ))
+        {
+            return false;
+        }
+
+        if (bits > 0 &&
+            ! valCheck<unsigned int> (
+                expected,
+                table.firstWithBitsAbove (bits - 1).decimalPlaces,
+                "firstWithBitsAbove: "
+            ))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::vector<Test> NumberShiftTableTestVec = {
+    {testValues<int64_t>, TestName ("values<int64_t>")},
+    {testValues<__int128_t>, TestName ("values<int128_t>")},
+    {testTotalDigits<int64_t>, TestName ("totalDigits<int64_t>")},
+    {testTotalDigits<__int128_t>, TestName ("totalDigits<int128_t>")},
+    {testBitLookups<int64_t>, TestName ("bitLookups<int64_t>")},
+    {testBitLookups<__int128_t>, TestName ("bitLookups<int128_t>")}
+};
+
+} // namespace test
+} // namespace fixed
@@ -39,6 +39,7 @@ struct TestVec {
 
 extern std::vector<Test> NumberAbsoluteTestVec;
 extern std::vector<Test> NumberArithmeticTestVec;
+extern std::vector<Test> NumberDivisionTestVec;
 extern std::vector<Test> NumberIntConstructorFailTestVec;
 extern std::vector<Test> NumberIntConstructorTestVec;
 extern std::vector<Test> NumberFirstBitSetTestVec;
@@ -47,12 +48,14 @@ extern std::vector<Test> NumberFpConstructorTestVec;
 extern std::vector<Test> NumberNegateTestVec;
 extern std::vector<Test> NumberRelationalTestVec;
 extern std::vector<Test> NumberRoundingTestVec;
+extern std::vector<Test> NumberShiftTableTestVec;
 extern std::vector<Test> NumberSqueezeZerosTestVec;
 extern std::vector<Test> NumberToFpTestVec;
 
 static std::vector<TestVec> testVecs = {
   {
     { "FirstBitSet", NumberFirstBitSetTestVec },
+    { "ShiftTable", NumberShiftTableTestVec },
     { "SqueezeZerosTestVec", NumberSqueezeZerosTestVec },
     { "Integer Constructor", NumberIntConstructorTestVec },
     { "FloatingPoint Constructor", NumberFpConstructorTestVec },
@@ -61,6 +64,7 @@ static std::vector<TestVec> testVecs = {
     { "Integer Constructor Fail", NumberIntConstructorFailTestVec },
     { "Floating Point Constructor Fail", NumberFpConstructorFailTestVec },
     { "Arithmetic", NumberArithmeticTestVec },
+    { "Division", NumberDivisionTestVec },
     { "Relational", NumberRelationalTestVec },
     { "Absolute", NumberAbsoluteTestVec },
     { "Negate", NumberNegateTestVec }